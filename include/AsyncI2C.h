@@ -0,0 +1,208 @@
+/*
+ * Asynchronous I2C transaction engine
+ *
+ * Callers submit register read/write transactions to a queue and either
+ * get a completion callback or wait on the transaction like a future.
+ * A backend executes queued transactions strictly in submission order.
+ *
+ * This header is hardware independent (it also builds on the host);
+ * backends: EspI2C (ESP-IDF I2C driver, worker task), WireI2C (Arduino
+ * Wire, runs each transaction immediately) and the host-side mock bus
+ * used by the native tests.
+ */
+
+#ifndef ASYNCI2C_H
+#define ASYNCI2C_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define ASYNC_I2C_QUEUE_LEN 16   // power of two
+
+enum I2CStatus : int8_t {
+    I2C_PENDING = 1,
+    I2C_OK = 0,
+    I2C_ERROR = -1,
+    I2C_TIMEOUT = -2
+};
+
+struct I2CTransaction;
+typedef void (*I2CCallback)(I2CTransaction *txn, void *context);
+
+// One register transaction. Owned by the caller and must stay alive until
+// it completes.
+struct I2CTransaction {
+    uint8_t addr;
+    uint8_t reg;
+    bool read;              // read: write reg, repeated start, read len bytes
+    uint8_t *data;          // rx buffer (read) or payload after reg (write)
+    uint16_t len;
+    I2CCallback callback;   // optional, runs in the backend's context
+    void *context;
+    void *signal;           // backend wake-up object for wait(), optional
+    std::atomic<int8_t> status;
+
+    I2CTransaction()
+        : addr(0), reg(0), read(false), data(nullptr), len(0),
+          callback(nullptr), context(nullptr), signal(nullptr),
+          status(I2C_OK) {}
+
+    void setRead(uint8_t address, uint8_t regAddr, uint8_t *buf, uint16_t length) {
+        addr = address;
+        reg = regAddr;
+        read = true;
+        data = buf;
+        len = length;
+    }
+
+    void setWrite(uint8_t address, uint8_t regAddr, uint8_t *payload, uint16_t length) {
+        addr = address;
+        reg = regAddr;
+        read = false;
+        data = payload;
+        len = length;
+    }
+
+    bool done() const { return status.load(std::memory_order_acquire) != I2C_PENDING; }
+    bool ok() const { return status.load(std::memory_order_acquire) == I2C_OK; }
+};
+
+class AsyncI2C {
+public:
+    AsyncI2C() : head(0), tail(0), running(false) {}
+    virtual ~AsyncI2C() {}
+
+    // Queue a transaction. Returns false if the queue is full or the
+    // transaction is still in flight.
+    bool submit(I2CTransaction *txn) {
+        if (!txn->done()) return false;
+
+        lock();
+        if (head - tail == ASYNC_I2C_QUEUE_LEN) {
+            unlock();
+            return false;
+        }
+        txn->status.store(I2C_PENDING, std::memory_order_release);
+        queue[head & (ASYNC_I2C_QUEUE_LEN - 1)] = txn;
+        head++;
+        unlock();
+
+        notifyWorker();
+        return true;
+    }
+
+    // Block until txn completes; false on timeout or bus error
+    virtual bool wait(I2CTransaction *txn, uint32_t timeoutMs) = 0;
+
+    // Remove a transaction the worker has not started; it completes with
+    // I2C_TIMEOUT. False if it is on the bus or already done.
+    bool cancel(I2CTransaction *txn) {
+        lock();
+        size_t i = running ? tail + 1 : tail;
+        while (i != head && queue[i & (ASYNC_I2C_QUEUE_LEN - 1)] != txn) i++;
+        if (i == head) {
+            unlock();
+            return false;
+        }
+        for (; i + 1 != head; i++) {
+            queue[i & (ASYNC_I2C_QUEUE_LEN - 1)] = queue[(i + 1) & (ASYNC_I2C_QUEUE_LEN - 1)];
+        }
+        head--;
+        txn->status.store(I2C_TIMEOUT, std::memory_order_release);
+        unlock();
+        return true;
+    }
+
+    // Submit and wait. Never returns with txn still queued, so it may live
+    // on the caller's stack: on timeout it is cancelled, or, if already on
+    // the bus, waited out (the backend bounds each transfer).
+    bool transact(I2CTransaction *txn, uint32_t timeoutMs = 50) {
+        if (!submit(txn)) return false;
+        if (!wait(txn, timeoutMs) && !cancel(txn)) {
+            while (!wait(txn, timeoutMs)) {}
+        }
+        return txn->ok();
+    }
+
+    // Object used to wake wait() for transactions submitted by one caller
+    virtual void *createSignal() { return nullptr; }
+
+    // Synchronous register helpers
+    bool readRegisters(uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len, void *signal = nullptr) {
+        I2CTransaction txn;
+        txn.setRead(addr, reg, buf, len);
+        txn.signal = signal;
+        return transact(&txn);
+    }
+
+    bool writeRegister(uint8_t addr, uint8_t reg, uint8_t value, void *signal = nullptr) {
+        I2CTransaction txn;
+        txn.setWrite(addr, reg, &value, 1);
+        txn.signal = signal;
+        return transact(&txn);
+    }
+
+    size_t pending() {
+        lock();
+        size_t n = head - tail;
+        unlock();
+        return n;
+    }
+
+    // Worker side: execute up to max queued transactions in order,
+    // completing each before starting the next. Returns the number run.
+    size_t process(size_t max = SIZE_MAX) {
+        size_t count = 0;
+        while (count < max) {
+            lock();
+            if (head == tail) {
+                unlock();
+                break;
+            }
+            I2CTransaction *txn = queue[tail & (ASYNC_I2C_QUEUE_LEN - 1)];
+            running = true;
+            unlock();
+
+            int8_t result = transfer(*txn);
+
+            lock();
+            tail++;
+            running = false;
+            unlock();
+
+            // Callback before publishing the status: once done() is true
+            // the owner may reuse or destroy the transaction
+            if (txn->callback) {
+                txn->callback(txn, txn->context);
+            }
+            void *signal = txn->signal;
+            txn->status.store(result, std::memory_order_release);
+            signalDone(signal);
+            count++;
+        }
+        return count;
+    }
+
+protected:
+    // Execute one transaction on the bus; returns I2C_OK or an error
+    virtual int8_t transfer(I2CTransaction &txn) = 0;
+
+    // Queue protection (multiple submitters, one worker)
+    virtual void lock() {}
+    virtual void unlock() {}
+
+    // Wake the worker after a submit
+    virtual void notifyWorker() {}
+
+    // Wake a waiter after completion
+    virtual void signalDone(void *signal) { (void)signal; }
+
+private:
+    I2CTransaction *queue[ASYNC_I2C_QUEUE_LEN];
+    size_t head;
+    size_t tail;
+    bool running;           // queue[tail] is on the bus
+};
+
+#endif // ASYNCI2C_H
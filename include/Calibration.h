@@ -0,0 +1,305 @@
+/*
+ * IMU Calibration Routine
+ *
+ * Six-orientation accelerometer calibration plus stationary gyro bias.
+ * The board is held still resting on each face in turn (+X, -X, +Y, -Y,
+ * +Z, -Z up, any order); each capture averages ~1 s of samples. finish()
+ * fits the full affine transform (scale, cross-axis, offset) by least
+ * squares and takes the gyro bias from the mean of all captures.
+ *
+ * Samples arrive already calibrated with whatever calibration is active,
+ * so the fit is composed with it instead of clearing it first.
+ *
+ * Requests (start / capture / finish / cancel / clear) may come from any
+ * task; the work happens in poll() and addSample() on the loop() task.
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <math.h>
+#include "QMI8658C.h"
+#include "SensorTask.h"
+#include "Config.h"
+
+#define CAL_CAPTURE_SAMPLES  256   // ~1.1 s at 224 Hz
+#define CAL_SETTLE_SAMPLES   32    // skipped after each capture request
+#define CAL_MAX_SPREAD_G     0.08f // peak-to-peak per axis while still
+#define CAL_MIN_AXIS_G       0.8f  // dominant axis must see most of gravity
+
+enum CalState : uint8_t {
+    CAL_IDLE = 0,
+    CAL_READY,          // started, waiting for a capture request
+    CAL_CAPTURING,
+    CAL_DONE,           // solved, saved and applied
+    CAL_FAILED
+};
+
+class ImuCalibrator {
+private:
+    enum Request { REQ_NONE = 0, REQ_START, REQ_CAPTURE, REQ_FINISH, REQ_CANCEL, REQ_CLEAR };
+
+    SensorTask *sensor;
+    ConfigManager *config;
+    std::atomic<int> request;
+    std::atomic<uint8_t> state;
+    const char *lastError;
+
+    // Mean accel (g) per orientation slot: axis * 2 + (negative ? 1 : 0)
+    float faceMean[6][3];
+    uint8_t faceMask;
+
+    // Running capture (loop task only)
+    uint16_t skip;
+    uint16_t count;
+    float accelSum[3];
+    float accelMin[3];
+    float accelMax[3];
+    float gyroSum[3];
+
+    // Gyro residual bias over all accepted captures
+    float gyroTotal[3];
+    uint32_t gyroCount;
+
+    void resetCapture() {
+        skip = CAL_SETTLE_SAMPLES;
+        count = 0;
+        for (int i = 0; i < 3; i++) {
+            accelSum[i] = 0;
+            gyroSum[i] = 0;
+            accelMin[i] = 1e9f;
+            accelMax[i] = -1e9f;
+        }
+    }
+
+    void fail(const char *reason) {
+        lastError = reason;
+        state = CAL_FAILED;
+        Serial.printf("Calibration: %s\n", reason);
+    }
+
+    void finishCapture() {
+        float mean[3];
+        for (int i = 0; i < 3; i++) {
+            if (accelMax[i] - accelMin[i] > CAL_MAX_SPREAD_G) {
+                lastError = "Board moved during capture";
+                state = CAL_READY;
+                Serial.println("Calibration: Board moved, capture again");
+                return;
+            }
+            mean[i] = accelSum[i] / count;
+        }
+
+        int axis = 0;
+        for (int i = 1; i < 3; i++) {
+            if (fabsf(mean[i]) > fabsf(mean[axis])) axis = i;
+        }
+        if (fabsf(mean[axis]) < CAL_MIN_AXIS_G) {
+            lastError = "Board not resting on a face";
+            state = CAL_READY;
+            Serial.println("Calibration: Not resting on a face, capture again");
+            return;
+        }
+
+        int slot = axis * 2 + (mean[axis] < 0 ? 1 : 0);
+        for (int i = 0; i < 3; i++) {
+            faceMean[slot][i] = mean[i];
+            gyroTotal[i] += gyroSum[i];
+        }
+        gyroCount += count;
+        faceMask |= 1 << slot;
+        lastError = nullptr;
+        state = CAL_READY;
+
+        Serial.printf("Calibration: Captured %c%c (%d/6): %.3f %.3f %.3f g\n",
+                      mean[axis] < 0 ? '-' : '+', 'X' + axis,
+                      getCapturedFaces(), mean[0], mean[1], mean[2]);
+    }
+
+    // Solve the 4x4 normal equations N x = r for three right-hand sides
+    static bool solve4(float n[4][4], float r[4][3]) {
+        for (int c = 0; c < 4; c++) {
+            int pivot = c;
+            for (int i = c + 1; i < 4; i++) {
+                if (fabsf(n[i][c]) > fabsf(n[pivot][c])) pivot = i;
+            }
+            if (fabsf(n[pivot][c]) < 1e-6f) return false;
+            if (pivot != c) {
+                for (int j = 0; j < 4; j++) { float t = n[c][j]; n[c][j] = n[pivot][j]; n[pivot][j] = t; }
+                for (int j = 0; j < 3; j++) { float t = r[c][j]; r[c][j] = r[pivot][j]; r[pivot][j] = t; }
+            }
+            for (int i = 0; i < 4; i++) {
+                if (i == c) continue;
+                float f = n[i][c] / n[c][c];
+                for (int j = c; j < 4; j++) n[i][j] -= f * n[c][j];
+                for (int j = 0; j < 3; j++) r[i][j] -= f * r[c][j];
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 3; j++) r[i][j] /= n[i][i];
+        }
+        return true;
+    }
+
+    void solve() {
+        if (faceMask != 0x3F) {
+            fail("All six faces are needed");
+            return;
+        }
+
+        // Least squares fit of expected = A * measured + b over the six
+        // faces: rows of [A | b] share the normal matrix
+        float n[4][4] = {};
+        float r[4][3] = {};
+        for (int f = 0; f < 6; f++) {
+            float v[4] = {faceMean[f][0], faceMean[f][1], faceMean[f][2], 1.0f};
+            float e[3] = {0, 0, 0};
+            e[f / 2] = (f & 1) ? -1.0f : 1.0f;
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++) n[i][j] += v[i] * v[j];
+                for (int j = 0; j < 3; j++) r[i][j] += v[i] * e[j];
+            }
+        }
+        if (!solve4(n, r)) {
+            fail("Captures are degenerate");
+            return;
+        }
+
+        // r[j][i] is A[i][j] for j < 3, r[3][i] is b[i]
+        float fitA[3][3], fitB[3];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                fitA[i][j] = r[j][i];
+                float limit = (i == j) ? 0.25f : 0.1f;
+                float nominal = (i == j) ? 1.0f : 0.0f;
+                if (fabsf(fitA[i][j] - nominal) > limit) {
+                    fail("Fit out of range, check the captures");
+                    return;
+                }
+            }
+            fitB[i] = r[3][i];
+            if (fabsf(fitB[i]) > 0.5f) {
+                fail("Offset out of range, check the captures");
+                return;
+            }
+        }
+
+        // Compose with the active calibration the samples were taken with
+        IMUCalibration prev = sensor->getCalibration();
+        if (!prev.valid) QMI8658C::identityCalibration(prev);
+
+        IMUCalibration cal;
+        cal.valid = true;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                cal.accelMatrix[i][j] = 0;
+                for (int k = 0; k < 3; k++) {
+                    cal.accelMatrix[i][j] += fitA[i][k] * prev.accelMatrix[k][j];
+                }
+            }
+            cal.accelOffset[i] = fitB[i];
+            for (int k = 0; k < 3; k++) {
+                cal.accelOffset[i] += fitA[i][k] * prev.accelOffset[k];
+            }
+            cal.gyroBias[i] = prev.gyroBias[i] + gyroTotal[i] / gyroCount;
+        }
+
+        sensor->setCalibration(cal);
+        config->setCalibration(cal);
+        config->save();
+
+        lastError = nullptr;
+        state = CAL_DONE;
+        Serial.printf("Calibration: Done. Offset %.3f %.3f %.3f g, "
+                      "scale %.3f %.3f %.3f, gyro bias %.2f %.2f %.2f dps\n",
+                      cal.accelOffset[0], cal.accelOffset[1], cal.accelOffset[2],
+                      cal.accelMatrix[0][0], cal.accelMatrix[1][1], cal.accelMatrix[2][2],
+                      cal.gyroBias[0], cal.gyroBias[1], cal.gyroBias[2]);
+    }
+
+public:
+    ImuCalibrator(SensorTask *sensorTask, ConfigManager *cfg)
+        : sensor(sensorTask), config(cfg), request(REQ_NONE), state(CAL_IDLE),
+          lastError(nullptr), faceMask(0), gyroCount(0) {
+        resetCapture();
+    }
+
+    // Requests, safe to call from any task
+    void start() { request = REQ_START; }
+    void capture() { request = REQ_CAPTURE; }
+    void finish() { request = REQ_FINISH; }
+    void cancel() { request = REQ_CANCEL; }
+    void clear() { request = REQ_CLEAR; }
+
+    CalState getState() const { return (CalState)state.load(); }
+    const char *getLastError() const { return lastError; }
+    uint8_t getFaceMask() const { return faceMask; }
+    int getCapturedFaces() const { return __builtin_popcount(faceMask); }
+
+    // Handle pending requests (loop task)
+    void poll() {
+        int req = request.exchange(REQ_NONE);
+        switch (req) {
+        case REQ_START:
+            faceMask = 0;
+            gyroCount = 0;
+            for (int i = 0; i < 3; i++) gyroTotal[i] = 0;
+            lastError = nullptr;
+            state = CAL_READY;
+            Serial.println("Calibration: Started, rest the board on each face");
+            break;
+        case REQ_CAPTURE:
+            if (state == CAL_READY) {
+                resetCapture();
+                state = CAL_CAPTURING;
+            }
+            break;
+        case REQ_FINISH:
+            if (state == CAL_READY) solve();
+            break;
+        case REQ_CANCEL:
+            state = CAL_IDLE;
+            break;
+        case REQ_CLEAR: {
+            IMUCalibration cal;
+            QMI8658C::identityCalibration(cal);
+            sensor->setCalibration(cal);
+            config->setCalibration(cal);
+            config->save();
+            state = CAL_IDLE;
+            Serial.println("Calibration: Cleared");
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // Feed every sample drained from the sensor task (loop task)
+    void addSample(const IMUSample &sample) {
+        if (state != CAL_CAPTURING) return;
+        if (skip > 0) {
+            skip--;
+            return;
+        }
+
+        float aScale = QMI8658C::accelScaleFor(sample.accelRange);
+        float gScale = QMI8658C::gyroScaleFor(sensor->getGyroRange());
+        float accel[3] = {sample.accelX * aScale, sample.accelY * aScale, sample.accelZ * aScale};
+        float gyro[3] = {sample.gyroX * gScale, sample.gyroY * gScale, sample.gyroZ * gScale};
+        for (int i = 0; i < 3; i++) {
+            accelSum[i] += accel[i];
+            gyroSum[i] += gyro[i];
+            if (accel[i] < accelMin[i]) accelMin[i] = accel[i];
+            if (accel[i] > accelMax[i]) accelMax[i] = accel[i];
+        }
+
+        if (++count >= CAL_CAPTURE_SAMPLES) {
+            finishCapture();
+        }
+    }
+};
+
+#endif // CALIBRATION_H
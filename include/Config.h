@@ -3,13 +3,22 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include "QMI8658C.h"
+#include "GestureRecognizer.h"
 
 // Configuration structure
 struct SlapConfig {
     bool isAPMode;
     char ssid[32];
     char password[64];
-    float threshold;
+    float threshold;            // g, the floor in adaptive mode
+    bool adaptiveThreshold;     // track the noise floor
+    float noiseK;               // adaptive threshold = noiseK * noise sigma
+    uint16_t gestureWindowMs;   // max time between slaps of one gesture
+    uint8_t gestureActions[GESTURE_MAX_SLAPS + 1];  // action bits per slap count
+    IMUCalibration calibration;
+    IMUTempCompensation tempComp;   // accel bias drift over temperature
+    uint16_t tempIntervalMs;    // temperature read interval
 };
 
 // Configuration manager class
@@ -19,6 +28,12 @@ private:
     SlapConfig config;
     static constexpr const char* NAMESPACE = "slap-ai";
     
+    void defaultGestures() {
+        GestureConfig defaults;
+        config.gestureWindowMs = defaults.windowUs / 1000;
+        memcpy(config.gestureActions, defaults.actions, sizeof(config.gestureActions));
+    }
+    
 public:
     ConfigManager() {
         // Default values
@@ -26,6 +41,12 @@ public:
         strcpy(config.ssid, "");
         strcpy(config.password, "");
         config.threshold = 1.0f;
+        config.adaptiveThreshold = false;
+        config.noiseK = 10.0f;
+        defaultGestures();
+        QMI8658C::identityCalibration(config.calibration);
+        memset(&config.tempComp, 0, sizeof(config.tempComp));
+        config.tempIntervalMs = QMI8658C_TEMP_INTERVAL_MS;
     }
     
     // Load configuration from NVS
@@ -39,6 +60,23 @@ public:
         prefs.getString("ssid", config.ssid, sizeof(config.ssid));
         prefs.getString("password", config.password, sizeof(config.password));
         config.threshold = prefs.getFloat("threshold", 1.0f);
+        config.adaptiveThreshold = prefs.getBool("adaptive", false);
+        config.noiseK = prefs.getFloat("noiseK", 10.0f);
+        config.gestureWindowMs = prefs.getUShort("gestWin", config.gestureWindowMs);
+        if (prefs.getBytesLength("gestAct") == sizeof(config.gestureActions)) {
+            prefs.getBytes("gestAct", config.gestureActions, sizeof(config.gestureActions));
+        }
+        
+        // Stored as a blob; ignore it if the layout has changed
+        if (prefs.getBytesLength("imuCal") != sizeof(IMUCalibration) ||
+            prefs.getBytes("imuCal", &config.calibration, sizeof(IMUCalibration)) != sizeof(IMUCalibration)) {
+            QMI8658C::identityCalibration(config.calibration);
+        }
+        if (prefs.getBytesLength("tempComp") != sizeof(IMUTempCompensation) ||
+            prefs.getBytes("tempComp", &config.tempComp, sizeof(IMUTempCompensation)) != sizeof(IMUTempCompensation)) {
+            memset(&config.tempComp, 0, sizeof(config.tempComp));
+        }
+        config.tempIntervalMs = prefs.getUShort("tempMs", QMI8658C_TEMP_INTERVAL_MS);
         
         prefs.end();
         
@@ -46,6 +84,11 @@ public:
         Serial.printf("  AP Mode: %s\n", config.isAPMode ? "YES" : "NO");
         Serial.printf("  SSID: %s\n", config.ssid);
         Serial.printf("  Threshold: %.2fg\n", config.threshold);
+        Serial.printf("  Adaptive: %s (k = %.1f)\n", config.adaptiveThreshold ? "YES" : "NO", config.noiseK);
+        Serial.printf("  Gesture window: %ums\n", config.gestureWindowMs);
+        Serial.printf("  IMU Calibration: %s\n", config.calibration.valid ? "YES" : "NO");
+        Serial.printf("  Temp Compensation: %s (read every %ums)\n",
+                      config.tempComp.valid ? "YES" : "NO", config.tempIntervalMs);
         
         return true;
     }
@@ -61,6 +104,13 @@ public:
         prefs.putString("ssid", config.ssid);
         prefs.putString("password", config.password);
         prefs.putFloat("threshold", config.threshold);
+        prefs.putBool("adaptive", config.adaptiveThreshold);
+        prefs.putFloat("noiseK", config.noiseK);
+        prefs.putUShort("gestWin", config.gestureWindowMs);
+        prefs.putBytes("gestAct", config.gestureActions, sizeof(config.gestureActions));
+        prefs.putBytes("imuCal", &config.calibration, sizeof(IMUCalibration));
+        prefs.putBytes("tempComp", &config.tempComp, sizeof(IMUTempCompensation));
+        prefs.putUShort("tempMs", config.tempIntervalMs);
         
         prefs.end();
         
@@ -83,6 +133,12 @@ public:
         strcpy(config.ssid, "");
         strcpy(config.password, "");
         config.threshold = 1.0f;
+        config.adaptiveThreshold = false;
+        config.noiseK = 10.0f;
+        defaultGestures();
+        QMI8658C::identityCalibration(config.calibration);
+        memset(&config.tempComp, 0, sizeof(config.tempComp));
+        config.tempIntervalMs = QMI8658C_TEMP_INTERVAL_MS;
         
         Serial.println("Factory reset complete - settings cleared");
     }
@@ -92,12 +148,34 @@ public:
     const char* getSSID() const { return config.ssid; }
     const char* getPassword() const { return config.password; }
     float getThreshold() const { return config.threshold; }
+    bool isAdaptiveThreshold() const { return config.adaptiveThreshold; }
+    float getNoiseK() const { return config.noiseK; }
+    uint16_t getGestureWindowMs() const { return config.gestureWindowMs; }
+    uint8_t getGestureActions(Gesture g) const { return config.gestureActions[g]; }
+    GestureConfig getGestureConfig() const {
+        GestureConfig gc;
+        gc.windowUs = config.gestureWindowMs * 1000UL;
+        memcpy(gc.actions, config.gestureActions, sizeof(gc.actions));
+        return gc;
+    }
+    const IMUCalibration& getCalibration() const { return config.calibration; }
+    const IMUTempCompensation& getTempCompensation() const { return config.tempComp; }
+    uint16_t getTemperatureInterval() const { return config.tempIntervalMs; }
     
     // Setters
     void setAPMode(bool mode) { config.isAPMode = mode; }
     void setSSID(const char* s) { strncpy(config.ssid, s, sizeof(config.ssid) - 1); }
     void setPassword(const char* p) { strncpy(config.password, p, sizeof(config.password) - 1); }
     void setThreshold(float t) { config.threshold = t; }
+    void setAdaptiveThreshold(bool enabled) { config.adaptiveThreshold = enabled; }
+    void setNoiseK(float k) { config.noiseK = k; }
+    void setGestureWindowMs(uint16_t ms) { config.gestureWindowMs = ms; }
+    void setGestureActions(Gesture g, uint8_t actions) {
+        if (g >= GESTURE_SINGLE && g <= GESTURE_MAX_SLAPS) config.gestureActions[g] = actions;
+    }
+    void setCalibration(const IMUCalibration& cal) { config.calibration = cal; }
+    void setTempCompensation(const IMUTempCompensation& comp) { config.tempComp = comp; }
+    void setTemperatureInterval(uint16_t ms) { config.tempIntervalMs = ms; }
     
     // Get full config for JSON responses
     const SlapConfig& getConfig() const { return config; }
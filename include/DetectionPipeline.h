@@ -0,0 +1,300 @@
+/*
+ * Detection Pipeline
+ *
+ * Everything between a drained FIFO batch and a published slap event,
+ * free of Arduino / FreeRTOS so the sensor task and the host replay tool
+ * (tools/replay) run the same code:
+ *   1. OrientationFilter removes gravity (or, with fusion off, the raw
+ *      acceleration goes straight to the detector's high-pass)
+ *   2. SlapDetector finds impacts against the fixed or adaptive threshold
+ *      (NoiseFloorEstimator fed with the quiet samples)
+ *   3. FeatureExtractor annotates each event at its release
+ *   4. SlapClassifier labels it once CLASSIFIER_POST samples past the
+ *      peak have arrived, then the event goes to the sink
+ *
+ * Events reach the sink in peak order. CPU cycles are measured with an
+ * injected counter (ESP.getCycleCount on the device); without one the
+ * cycle statistics stay 0.
+ */
+
+#ifndef DETECTIONPIPELINE_H
+#define DETECTIONPIPELINE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "IMUTypes.h"
+#include "MotionDetector.h"
+#include "SlapDetector.h"
+#include "OrientationFilter.h"
+#include "NoiseFloor.h"
+#include "FeatureExtractor.h"
+#include "SlapClassifier.h"
+
+// Squared magnitude history for the classifier window (power of two);
+// must cover CLASSIFIER_PRE plus the longest impact
+#define CLASSIFIER_HISTORY   256
+
+struct PipelineStats {
+    uint32_t detectCycles;    // fusion + detector cycles per sample, last batch
+    uint32_t maxDetectCycles;
+    uint32_t featureCycles;   // feature extraction cycles, last event
+    uint32_t classifyCycles;  // classifier cycles, last event
+};
+
+class DetectionPipeline {
+public:
+    typedef uint32_t (*CycleCounter)();
+
+private:
+    SlapDetector detector;
+    OrientationFilter orientation;
+    NoiseFloorEstimator noise;
+    FeatureExtractor features;
+    SlapClassifier classifier;
+    CycleCounter cycles;
+
+    // Settings
+    float threshold;
+    bool adaptive;
+    float noiseK;
+    bool fusion;
+    bool fused;                 // input of the running detector
+    uint32_t samplePeriodUs;
+    float gyroScale;
+
+    float activeThreshold;
+    PipelineStats stats;
+
+    // Recent high-passed acceleration per axis (feature window source) and
+    // squared accel / gyro magnitudes (classifier window source), indexed
+    // by the running sample count
+    float history[3][FEATURE_WINDOW];
+    float accelMagSq[CLASSIFIER_HISTORY];
+    float gyroMagSq[CLASSIFIER_HISTORY];
+    uint32_t historyCount;
+    float window[FEATURE_WINDOW];
+    float gyroWindow[CLASSIFIER_WINDOW];
+
+    // Event waiting for its post-peak samples before classification
+    SlapEvent pendingEvent;
+    uint32_t pendingPeak;       // historyCount index of the peak sample
+    bool hasPending;
+
+    static uint32_t noCycles() { return 0; }
+
+    // Fixed threshold, or k * sigma of the noise floor with the fixed
+    // threshold as its lower bound
+    float effectiveThreshold() {
+        float g = threshold;
+        if (adaptive && noise.isReady() && noiseK * noise.getSigma() > g) {
+            g = noiseK * noise.getSigma();
+        }
+        activeThreshold = g;
+        return g;
+    }
+
+    void fuse(const IMUSample &sample) {
+        float aScale = imuAccelScale(sample.accelRange);
+        orientation.update(sample.accelX * aScale, sample.accelY * aScale, sample.accelZ * aScale,
+                           sample.gyroX * gyroScale, sample.gyroY * gyroScale, sample.gyroZ * gyroScale,
+                           samplePeriodUs * 1e-6f);
+    }
+
+    // Append one sample to the feature and classifier histories
+    void record(const IMUSample &sample) {
+        const float *y = detector.getFiltered();
+        uint32_t f = historyCount % FEATURE_WINDOW;
+        for (int axis = 0; axis < 3; axis++) {
+            history[axis][f] = y[axis];
+        }
+
+        float aScale = imuAccelScale(sample.accelRange);
+        float ax = sample.accelX * aScale, ay = sample.accelY * aScale, az = sample.accelZ * aScale;
+        float gx = sample.gyroX * gyroScale, gy = sample.gyroY * gyroScale, gz = sample.gyroZ * gyroScale;
+        uint32_t c = historyCount % CLASSIFIER_HISTORY;
+        accelMagSq[c] = ax * ax + ay * ay + az * az;
+        gyroMagSq[c] = gx * gx + gy * gy + gz * gz;
+        historyCount++;
+    }
+
+    // Waveform features over the last FEATURE_WINDOW samples (ending at
+    // the release) along the dominant axis of the impact
+    void annotate(SlapEvent &event) {
+        if (event.direction == 0) return;
+
+        uint32_t start = cycles();
+        const float *axis = history[abs(event.direction) - 1];
+        uint32_t head = historyCount % FEATURE_WINDOW;
+        size_t older = FEATURE_WINDOW - head;
+        memcpy(window, axis + head, older * sizeof(float));
+        memcpy(window + older, axis, head * sizeof(float));
+        features.extract(window, event.features);
+        stats.featureCycles = cycles() - start;
+    }
+
+    // Classify the window around the peak (ending at the newest sample if
+    // the post-peak part is incomplete), then emit. Returns cycles spent.
+    template <typename Sink>
+    uint32_t finish(SlapEvent &event, uint32_t peak, Sink &sink) {
+        uint32_t start = cycles();
+        uint32_t first = peak - CLASSIFIER_PRE;
+        if (peak + CLASSIFIER_POST > historyCount) {
+            first = historyCount - CLASSIFIER_WINDOW;
+        }
+
+        if (peak >= CLASSIFIER_PRE && historyCount >= CLASSIFIER_WINDOW &&
+            historyCount - first <= CLASSIFIER_HISTORY) {
+            for (int i = 0; i < CLASSIFIER_WINDOW; i++) {
+                uint32_t c = (first + i) % CLASSIFIER_HISTORY;
+                window[i] = accelMagSq[c];
+                gyroWindow[i] = gyroMagSq[c];
+            }
+            SlapClassification result = classifier.classify(window, gyroWindow);
+            event.label = result.label;
+            event.confidence = result.confidence;
+            stats.classifyCycles = cycles() - start;
+        }
+
+        sink(event);
+        return cycles() - start;
+    }
+
+public:
+    DetectionPipeline()
+        : cycles(noCycles), threshold(1.0f), adaptive(false), noiseK(10.0f), fusion(true),
+          fused(false), samplePeriodUs(4460), gyroScale(imuGyroScale(QMI8658C_GYRO_256DPS)),
+          activeThreshold(1.0f), historyCount(0), pendingPeak(0), hasPending(false) {
+        memset(history, 0, sizeof(history));
+        resetStats();
+        setSamplePeriodUs(samplePeriodUs);
+    }
+
+    // Prepare the feature extractor (ESP-DSP tables)
+    bool begin() { return features.begin(); }
+
+    void setCycleCounter(CycleCounter counter) { cycles = counter ? counter : noCycles; }
+
+    void setSamplePeriodUs(uint32_t us) {
+        samplePeriodUs = us;
+        detector.setSampleRate(1000000.0f / us);
+        features.setSampleRate(1000000.0f / us);
+    }
+    uint32_t getSamplePeriodUs() const { return samplePeriodUs; }
+
+    void setGyroRange(uint8_t range) { gyroScale = imuGyroScale(range); }
+
+    // Detection settings, applied from the next batch
+    void setThreshold(float g) { threshold = g; }
+    void setAdaptiveThreshold(bool enabled, float k) {
+        adaptive = enabled;
+        noiseK = k;
+    }
+    void setFusion(bool enabled) { fusion = enabled; }
+    void setDetectorConfig(const SlapDetectorConfig &config) { detector.setConfig(config); }
+
+    // Run detection over a batch; sink(const SlapEvent &) gets each event
+    template <typename Sink>
+    void process(const IMUSample *batch, size_t count, Sink &&sink) {
+        if (count == 0) return;
+
+        uint32_t start = cycles();
+        uint32_t eventCycles = 0;
+        detector.setThreshold(effectiveThreshold());
+
+        // Restart the high-pass from steady state when its input changes
+        if (fusion != fused) {
+            detector.reset();
+            fused = fusion;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            SlapEvent event;
+            fuse(batch[i]);
+            bool detected = fused ? detector.update(orientation.getLinear(), batch[i].timestampUs, event)
+                                  : detector.update(batch[i], event);
+            record(batch[i]);
+            // Only background: not impacts, nor their ring-down. Until the
+            // estimate is ready every sample counts (the median shrugs off
+            // impacts), so background above the floor cannot lock it out.
+            if (!noise.isReady() || (!detected && !detector.isActive() &&
+                                     !detector.inRefractory(batch[i].timestampUs))) {
+                noise.push(detector.getMotion());
+            }
+
+            if (hasPending && historyCount >= pendingPeak + CLASSIFIER_POST) {
+                eventCycles += finish(pendingEvent, pendingPeak, sink);
+                hasPending = false;
+            }
+
+            if (detected) {
+                annotate(event);
+                eventCycles += stats.featureCycles;
+
+                // A new impact before the previous one got its post-peak samples
+                if (hasPending) {
+                    eventCycles += finish(pendingEvent, pendingPeak, sink);
+                    hasPending = false;
+                }
+
+                uint32_t sincePeak = (batch[i].timestampUs - event.timestampUs + samplePeriodUs / 2) / samplePeriodUs;
+                if (sincePeak > historyCount - 1) sincePeak = historyCount - 1;
+                uint32_t peak = historyCount - 1 - sincePeak;
+                if (historyCount >= peak + CLASSIFIER_POST) {
+                    eventCycles += finish(event, peak, sink);
+                } else {
+                    pendingEvent = event;
+                    pendingPeak = peak;
+                    hasPending = true;
+                }
+            }
+        }
+
+        noise.update();
+
+        // Per-sample CPU budget of fusion + detector (per-event work excluded)
+        stats.detectCycles = (cycles() - start - eventCycles) / count;
+        if (stats.detectCycles > stats.maxDetectCycles) {
+            stats.maxDetectCycles = stats.detectCycles;
+        }
+    }
+
+    // Detection off: emit a waiting event, keep the orientation current
+    template <typename Sink>
+    void idle(const IMUSample *batch, size_t count, Sink &&sink) {
+        detector.setThreshold(effectiveThreshold());
+        detector.reset();
+        flush(sink);
+        for (size_t i = 0; i < count; i++) {
+            fuse(batch[i]);
+        }
+    }
+
+    // Emit a waiting event with whatever history there is
+    template <typename Sink>
+    void flush(Sink &&sink) {
+        if (hasPending) {
+            finish(pendingEvent, pendingPeak, sink);
+            hasPending = false;
+        }
+    }
+
+    // Time before which no further event will be emitted, given the
+    // newest sample processed: the event waiting for classification, or
+    // else an impact still in progress, holds it back
+    uint32_t getHorizonUs(uint32_t newestUs) const {
+        if (hasPending) return pendingEvent.timestampUs - 1;
+        if (detector.isActive()) return detector.getImpactStartUs() - 1;
+        return newestUs;
+    }
+
+    float getNoiseSigma() const { return noise.getSigma(); }
+    float getActiveThreshold() const { return activeThreshold; }
+    const OrientationFilter &getOrientation() const { return orientation; }
+    const SlapDetector &getDetector() const { return detector; }
+
+    const PipelineStats &getStats() const { return stats; }
+    void resetStats() { memset(&stats, 0, sizeof(stats)); }
+};
+
+#endif // DETECTIONPIPELINE_H
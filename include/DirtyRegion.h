@@ -0,0 +1,126 @@
+/*
+ * Dirty Region Tracking
+ *
+ * Up to DIRTY_MAX_RECTS rectangles covering everything drawn into a
+ * framebuffer since the last flush. A new rectangle joins an existing one
+ * when their union wastes at most DIRTY_MERGE_SLACK pixels (so the pixels
+ * of a glyph collapse into one box); when the list is full it joins the
+ * one it grows least. trim() shrinks a rectangle to the pixels that
+ * differ from what the panel shows.
+ * No Arduino dependencies.
+ */
+
+#ifndef DIRTYREGION_H
+#define DIRTYREGION_H
+
+#include <stdint.h>
+
+#define DIRTY_MAX_RECTS     8
+#define DIRTY_MERGE_SLACK   64      // pixels
+
+struct DirtyRect {
+    int16_t x, y, w, h;
+
+    int32_t area() const { return (int32_t)w * h; }
+
+    DirtyRect unite(const DirtyRect &o) const {
+        int16_t x0 = x < o.x ? x : o.x;
+        int16_t y0 = y < o.y ? y : o.y;
+        int16_t x1 = (x + w) > (o.x + o.w) ? (x + w) : (o.x + o.w);
+        int16_t y1 = (y + h) > (o.y + o.h) ? (y + h) : (o.y + o.h);
+        return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+    }
+};
+
+class DirtyRegion {
+private:
+    DirtyRect rects[DIRTY_MAX_RECTS];
+    uint8_t count;
+
+    // Extra pixels the union sends compared with sending both rectangles.
+    // Overlap would go out twice separately, so it makes merging cheaper
+    // (negative for heavy overlap).
+    static int32_t waste(const DirtyRect &a, const DirtyRect &b) {
+        return a.unite(b).area() - a.area() - b.area();
+    }
+
+    // After rects[i] grew, fold in any rectangle it now absorbs cheaply
+    void settle(uint8_t i) {
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (uint8_t j = 0; j < count; j++) {
+                if (j == i || waste(rects[i], rects[j]) > DIRTY_MERGE_SLACK) continue;
+                rects[i] = rects[i].unite(rects[j]);
+                rects[j] = rects[--count];
+                if (i == count) i = j;
+                merged = true;
+                break;
+            }
+        }
+    }
+
+public:
+    DirtyRegion() : count(0) {}
+
+    void clear() { count = 0; }
+    uint8_t size() const { return count; }
+    const DirtyRect &operator[](uint8_t i) const { return rects[i]; }
+
+    // Clipped, non-empty rectangles only
+    void add(int16_t x, int16_t y, int16_t w, int16_t h) {
+        DirtyRect r = {x, y, w, h};
+
+        for (uint8_t i = 0; i < count; i++) {
+            if (waste(rects[i], r) <= DIRTY_MERGE_SLACK) {
+                rects[i] = rects[i].unite(r);
+                settle(i);
+                return;
+            }
+        }
+        if (count < DIRTY_MAX_RECTS) {
+            rects[count++] = r;
+            return;
+        }
+
+        uint8_t best = 0;
+        int32_t bestGrowth = INT32_MAX;
+        for (uint8_t i = 0; i < count; i++) {
+            int32_t growth = rects[i].unite(r).area() - rects[i].area();
+            if (growth < bestGrowth) {
+                bestGrowth = growth;
+                best = i;
+            }
+        }
+        rects[best] = rects[best].unite(r);
+        settle(best);
+    }
+
+    // Shrink r to the bounding box of the pixels where `now` differs from
+    // `shown` (both stride pixels per row); false when nothing changed
+    static bool trim(const uint16_t *now, const uint16_t *shown, int16_t stride, DirtyRect &r) {
+        int16_t top = -1, bottom = -1;
+        int16_t left = r.x + r.w, right = r.x - 1;
+
+        for (int16_t y = r.y; y < r.y + r.h; y++) {
+            const uint16_t *a = now + (int32_t)y * stride;
+            const uint16_t *b = shown + (int32_t)y * stride;
+            int16_t x = r.x;
+            while (x < r.x + r.w && a[x] == b[x]) x++;
+            if (x == r.x + r.w) continue;
+
+            if (top < 0) top = y;
+            bottom = y;
+            if (x < left) left = x;
+            int16_t xr = r.x + r.w - 1;
+            while (xr > right && a[xr] == b[xr]) xr--;
+            if (xr > right) right = xr;
+        }
+        if (top < 0) return false;
+
+        r = {left, top, (int16_t)(right - left + 1), (int16_t)(bottom - top + 1)};
+        return true;
+    }
+};
+
+#endif // DIRTYREGION_H
@@ -2,6 +2,7 @@
 #define DISPLAYHELPER_H
 
 #include "GC9A01A.h"
+#include "FrameBuffer.h"
 #include <Arduino.h>
 
 // Color definitions (RGB565)
@@ -25,9 +26,12 @@ enum DisplayState {
 
 class DisplayHelper {
 private:
-    GC9A01A* display;
+    GC9A01A* panel;
+    FrameBuffer* frameBuffer;   // nullptr: draw straight to the panel
+    Adafruit_GFX* display;      // draw target, panel or framebuffer
     DisplayState currentState;
     DisplayState lastState;
+    uint8_t shownSlaps;
     
     void centerText(const char* text, int y, int textSize) {
         display->setTextSize(textSize);
@@ -39,8 +43,31 @@ private:
         display->print(text);
     }
     
+    // End of an update: push what changed in the framebuffer
+    void present() {
+        if (frameBuffer) frameBuffer->present(*panel);
+    }
+    
 public:
-    DisplayHelper(GC9A01A* disp) : display(disp), currentState(DISPLAY_IDLE), lastState(DISPLAY_IDLE) {}
+    DisplayHelper(GC9A01A* disp) : panel(disp), frameBuffer(nullptr), display(disp), currentState(DISPLAY_IDLE), lastState(DISPLAY_IDLE), shownSlaps(0) {}
+    
+    // Compose screens in a framebuffer (after its begin()) and flush only
+    // the changes; nullptr draws straight to the panel again
+    void setFrameBuffer(FrameBuffer* fb) {
+        frameBuffer = fb;
+        display = fb ? (Adafruit_GFX*)fb : (Adafruit_GFX*)panel;
+        if (fb) fb->invalidate();
+    }
+    
+    // Hand a frame the flush task was too busy for (call from loop())
+    void update() {
+        if (frameBuffer) frameBuffer->poll();
+    }
+    
+    // Pixel bytes sent by the last framebuffer flush
+    uint32_t getLastFlushBytes() const {
+        return frameBuffer ? frameBuffer->getLastFlushBytes() : 0;
+    }
     
     void showAPMode(const char* ip) {
         if (currentState == DISPLAY_AP_MODE && lastState == DISPLAY_AP_MODE) {
@@ -66,6 +93,7 @@ public:
         centerText("Connect to:", 85, 1);
         display->setTextSize(2);
         centerText(ip, 100, 2);
+        present();
         
         currentState = DISPLAY_AP_MODE;
         lastState = DISPLAY_AP_MODE;
@@ -91,6 +119,7 @@ public:
                     dots += ".";
                 }
                 centerText(dots.c_str(), 95, 2);
+                present();
             }
             return;
         }
@@ -108,6 +137,7 @@ public:
         display->setTextColor(COLOR_YELLOW);
         display->setTextSize(2);
         centerText(".", 95, 2);
+        present();
         
         currentState = DISPLAY_CONNECTING;
         lastState = DISPLAY_CONNECTING;
@@ -115,22 +145,35 @@ public:
     
     void showConnected() {
         display->fillScreen(COLOR_BLACK);
+        present();
         currentState = DISPLAY_CONNECTED;
         lastState = DISPLAY_CONNECTED;
     }
     
     void showSlap() {
-        if (currentState == DISPLAY_SLAP && lastState == DISPLAY_SLAP) {
-            return; // Already showing
+        showGesture(1);
+    }
+    
+    // Single, double or triple slap; false if it was already showing
+    bool showGesture(uint8_t slaps) {
+        if (currentState == DISPLAY_SLAP && lastState == DISPLAY_SLAP && shownSlaps == slaps) {
+            return false; // Already showing
         }
         
-        display->fillScreen(COLOR_RED);
+        static const char* labels[] = {"SLAP!", "SLAP!", "DOUBLE!", "TRIPLE!"};
+        static const uint16_t colors[] = {COLOR_RED, COLOR_RED, COLOR_ORANGE, COLOR_YELLOW};
+        if (slaps > 3) slaps = 3;
+        
+        display->fillScreen(colors[slaps]);
         display->setTextColor(COLOR_BLACK);
         display->setTextSize(3);
-        centerText("SLAP!", 55, 3);
+        centerText(labels[slaps], 55, 3);
+        present();
         
+        shownSlaps = slaps;
         currentState = DISPLAY_SLAP;
         lastState = DISPLAY_SLAP;
+        return true;
     }
     
     void showResetting(float progress) {
@@ -154,6 +197,7 @@ public:
         // Fill
         int fillWidth = (int)(barWidth * progress);
         display->fillRect(barX, barY, fillWidth, barHeight, COLOR_ORANGE);
+        present();
         
         lastState = DISPLAY_RESETTING;
     }
@@ -164,6 +208,7 @@ public:
         }
         
         display->fillScreen(COLOR_BLACK);
+        present();
         currentState = DISPLAY_IDLE;
         lastState = DISPLAY_IDLE;
     }
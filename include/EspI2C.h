@@ -0,0 +1,76 @@
+/*
+ * I2C backends for AsyncI2C
+ *
+ * EspI2C drives an ESP-IDF I2C port from a dedicated worker task: callers
+ * queue transactions and keep computing while the worker owns the bus.
+ * WireI2C runs each transaction immediately on an Arduino TwoWire bus, for
+ * test sketches that still set up Wire themselves.
+ */
+
+#ifndef ESPI2C_H
+#define ESPI2C_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <driver/i2c.h>
+#include "AsyncI2C.h"
+
+// Above the sensor task so queued IMU transfers start as soon as they are submitted
+#define ESP_I2C_TASK_CORE     0
+#define ESP_I2C_TASK_PRIORITY 12
+#define ESP_I2C_TASK_STACK    3072
+
+// Largest write payload (bytes after the register address)
+#define ESP_I2C_MAX_WRITE     32
+
+class EspI2C : public AsyncI2C {
+public:
+    EspI2C(i2c_port_t port, int sdaPin, int sclPin, uint32_t frequency = 400000);
+
+    // Install the IDF driver and start the worker task
+    bool begin();
+
+    bool wait(I2CTransaction *txn, uint32_t timeoutMs) override;
+
+    // Binary semaphore; one per waiting task
+    void *createSignal() override;
+
+protected:
+    int8_t transfer(I2CTransaction &txn) override;
+    void lock() override { portENTER_CRITICAL(&mux); }
+    void unlock() override { portEXIT_CRITICAL(&mux); }
+    void notifyWorker() override;
+    void signalDone(void *signal) override;
+
+private:
+    i2c_port_t port;
+    int sda;
+    int scl;
+    uint32_t freq;
+    TaskHandle_t worker;
+    portMUX_TYPE mux;
+    uint8_t txBuf[ESP_I2C_MAX_WRITE + 1];
+
+    static void workerEntry(void *param);
+};
+
+class WireI2C : public AsyncI2C {
+public:
+    explicit WireI2C(TwoWire &wire) : _wire(&wire) {}
+
+    // Transactions already ran in submit()
+    bool wait(I2CTransaction *txn, uint32_t timeoutMs) override {
+        (void)timeoutMs;
+        process();
+        return txn->done();
+    }
+
+protected:
+    int8_t transfer(I2CTransaction &txn) override;
+    void notifyWorker() override { process(); }
+
+private:
+    TwoWire *_wire;
+};
+
+#endif // ESPI2C_H
@@ -0,0 +1,131 @@
+/*
+ * Slap Event Store
+ *
+ * Fixed-capacity history of slap events, allocated once in PSRAM at
+ * begin() (internal RAM fallback with a smaller capacity). The oldest
+ * record is overwritten when full. Records carry a monotonic sequence
+ * number so clients can ask for everything after the last one they saw.
+ *
+ * Written by the loop() task, read by the web server task; a mutex
+ * protects the ring.
+ */
+
+#ifndef EVENTSTORE_H
+#define EVENTSTORE_H
+
+#include <Arduino.h>
+#include "MotionDetector.h"
+
+#define EVENT_STORE_CAPACITY          4096   // PSRAM, 160 KB
+#define EVENT_STORE_FALLBACK_CAPACITY 256    // internal RAM
+
+struct SlapRecord {
+    uint32_t seq;           // 1, 2, 3, ... (0 = none)
+    uint32_t timeMs;        // uptime at the peak, millis()
+    float peak;             // g
+    float energy;           // g^2*s
+    uint16_t durationMs;
+    int8_t direction;       // +1..+3 = +X..+Z, -1..-3 = -X..-Z, 0 = unknown
+    uint8_t source;         // SlapSource
+    float rms;              // waveform features, see FeatureExtractor
+    float crest;
+    float kurtosis;
+    float centroidHz;
+    uint8_t label;          // SlapClass
+    uint8_t confidence;     // percent
+};
+
+class EventStore {
+private:
+    SlapRecord *records;
+    uint32_t capacity;
+    uint32_t nextSeq;
+    SemaphoreHandle_t mutex;
+
+public:
+    EventStore() : records(nullptr), capacity(0), nextSeq(1), mutex(nullptr) {}
+
+    bool begin() {
+        if (records != nullptr) return true;
+
+        mutex = xSemaphoreCreateMutex();
+        if (psramFound()) {
+            records = (SlapRecord *)ps_malloc(EVENT_STORE_CAPACITY * sizeof(SlapRecord));
+            capacity = EVENT_STORE_CAPACITY;
+        }
+        if (records == nullptr) {
+            records = (SlapRecord *)malloc(EVENT_STORE_FALLBACK_CAPACITY * sizeof(SlapRecord));
+            capacity = EVENT_STORE_FALLBACK_CAPACITY;
+        }
+        if (records == nullptr || mutex == nullptr) {
+            Serial.println("EventStore: Allocation failed");
+            capacity = 0;
+            return false;
+        }
+
+        Serial.printf("EventStore: %lu records\n", (unsigned long)capacity);
+        return true;
+    }
+
+    // Record an event; timestamps are converted from micros() to uptime ms
+    void append(const SlapEvent &event) {
+        if (capacity == 0) return;
+
+        SlapRecord rec;
+        uint32_t ageUs = micros() - event.timestampUs;
+        rec.timeMs = millis() - ageUs / 1000;
+        rec.peak = event.peak;
+        rec.energy = event.energy;
+        rec.durationMs = (uint16_t)min(event.durationUs / 1000, (uint32_t)UINT16_MAX);
+        rec.direction = event.direction;
+        rec.source = event.source;
+        rec.rms = event.features.rms;
+        rec.crest = event.features.crest;
+        rec.kurtosis = event.features.kurtosis;
+        rec.centroidHz = event.features.centroidHz;
+        rec.label = event.label;
+        rec.confidence = event.confidence;
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        rec.seq = nextSeq++;
+        records[rec.seq % capacity] = rec;
+        xSemaphoreGive(mutex);
+    }
+
+    // Sequence number of the newest record (0 if none)
+    uint32_t lastSeq() {
+        if (capacity == 0) return 0;
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        uint32_t seq = nextSeq - 1;
+        xSemaphoreGive(mutex);
+        return seq;
+    }
+
+    // Copy up to max records with seq > since, oldest first. Returns the
+    // number copied; lost is set to how many requested records were
+    // already overwritten.
+    size_t query(uint32_t since, SlapRecord *out, size_t max, uint32_t &lost) {
+        lost = 0;
+        if (capacity == 0) return 0;
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        uint32_t newest = nextSeq - 1;
+        uint32_t oldest = newest >= capacity ? newest - capacity + 1 : 1;
+        uint32_t first = since + 1;
+        if (first < oldest) {
+            lost = oldest - first;
+            first = oldest;
+        }
+
+        size_t count = 0;
+        for (uint32_t seq = first; seq <= newest && count < max; seq++) {
+            out[count++] = records[seq % capacity];
+        }
+        xSemaphoreGive(mutex);
+        return count;
+    }
+
+    uint32_t getCapacity() const { return capacity; }
+};
+
+#endif // EVENTSTORE_H
@@ -0,0 +1,216 @@
+/*
+ * Slap Waveform Feature Extraction
+ *
+ * Computes features of a fixed-size window of high-passed acceleration
+ * (one axis, oldest sample first):
+ *   RMS, crest factor (peak / RMS), kurtosis (m4 / m2^2), a Hann-windowed
+ *   power spectrum, its centroid and its strongest bin
+ *
+ * Two implementations of the same math:
+ *   extractScalar()  plain C++, builds on the host for the native tests
+ *   extract()        ESP-DSP kernels (dot products, vector ops, radix-2
+ *                    FFT) which use the ESP32-S3 optimized (aes3) variants;
+ *                    falls back to extractScalar() where ESP-DSP is missing
+ */
+
+#ifndef FEATUREEXTRACTOR_H
+#define FEATUREEXTRACTOR_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define FEATURES_USE_ESP_DSP 1
+#else
+#define FEATURES_USE_ESP_DSP 0
+#endif
+
+#define FEATURE_WINDOW 128      // samples, power of two (~0.57 s at 224 Hz)
+
+struct SlapFeatures {
+    float rms = 0;              // g
+    float crest = 0;            // peak / RMS
+    float kurtosis = 0;         // 3 for Gaussian noise, higher for impulses
+    float centroidHz = 0;       // spectral centroid
+    float peakHz = 0;           // strongest spectral bin
+};
+
+class FeatureExtractor {
+public:
+    static const int N = FEATURE_WINDOW;
+    static const int BINS = N / 2;
+
+private:
+    float sampleRateHz;
+    float hann[N];
+    float cosTable[N / 2];      // scalar FFT twiddles
+    float sinTable[N / 2];
+    float fft[2 * N];           // interleaved re/im
+    float spectrum[BINS];       // power per bin, last extraction
+    float scratch[N];
+    float ones[N];
+    bool dspReady;
+
+    // Iterative radix-2 complex FFT in place on fft[]
+    void fftScalar() {
+        // Bit reversal
+        for (int i = 1, j = 0; i < N; i++) {
+            int bit = N >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) {
+                float tr = fft[2 * i], ti = fft[2 * i + 1];
+                fft[2 * i] = fft[2 * j];
+                fft[2 * i + 1] = fft[2 * j + 1];
+                fft[2 * j] = tr;
+                fft[2 * j + 1] = ti;
+            }
+        }
+
+        for (int len = 2; len <= N; len <<= 1) {
+            int step = N / len;
+            for (int i = 0; i < N; i += len) {
+                for (int k = 0; k < len / 2; k++) {
+                    float wr = cosTable[k * step];
+                    float wi = -sinTable[k * step];
+                    int a = 2 * (i + k);
+                    int b = 2 * (i + k + len / 2);
+                    float xr = fft[b] * wr - fft[b + 1] * wi;
+                    float xi = fft[b] * wi + fft[b + 1] * wr;
+                    fft[b] = fft[a] - xr;
+                    fft[b + 1] = fft[a + 1] - xi;
+                    fft[a] += xr;
+                    fft[a + 1] += xi;
+                }
+            }
+        }
+    }
+
+    // Power spectrum, centroid and peak from fft[] (DC excluded)
+    void spectralFeatures(SlapFeatures &out) {
+        float binHz = sampleRateHz / N;
+        float total = 0;
+        float weighted = 0;
+        int peakBin = 1;
+        spectrum[0] = 0;
+        for (int k = 1; k < BINS; k++) {
+            float re = fft[2 * k];
+            float im = fft[2 * k + 1];
+            float p = re * re + im * im;
+            spectrum[k] = p;
+            total += p;
+            weighted += p * k;
+            if (p > spectrum[peakBin]) peakBin = k;
+        }
+        out.centroidHz = total > 0 ? weighted / total * binHz : 0;
+        out.peakHz = total > 0 ? peakBin * binHz : 0;
+    }
+
+    static void shapeFeatures(float meanSq, float m2, float m4, float peak, SlapFeatures &out) {
+        out.rms = sqrtf(meanSq);
+        out.crest = out.rms > 0 ? peak / out.rms : 0;
+        out.kurtosis = m2 > 0 ? m4 / (m2 * m2) : 0;
+    }
+
+public:
+    FeatureExtractor() : sampleRateHz(224.2f), dspReady(false) {
+        for (int i = 0; i < N; i++) {
+            hann[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / (N - 1));
+            ones[i] = 1.0f;
+        }
+        for (int i = 0; i < N / 2; i++) {
+            cosTable[i] = cosf(2.0f * (float)M_PI * i / N);
+            sinTable[i] = sinf(2.0f * (float)M_PI * i / N);
+        }
+        memset(spectrum, 0, sizeof(spectrum));
+    }
+
+    // Initialize the ESP-DSP FFT tables; the scalar path needs nothing
+    bool begin() {
+#if FEATURES_USE_ESP_DSP
+        dspReady = dsps_fft2r_init_fc32(NULL, N) == ESP_OK;
+#endif
+        return true;
+    }
+
+    void setSampleRate(float hz) { sampleRateHz = hz; }
+
+    // Power per bin (BINS entries, bin k = k * sampleRate / N) of the last window
+    const float *getSpectrum() const { return spectrum; }
+
+    // Reference implementation
+    void extractScalar(const float *x, SlapFeatures &out) {
+        float sum = 0;
+        float sumSq = 0;
+        float peak = 0;
+        for (int i = 0; i < N; i++) {
+            sum += x[i];
+            sumSq += x[i] * x[i];
+            float a = fabsf(x[i]);
+            if (a > peak) peak = a;
+        }
+
+        float mean = sum / N;
+        float m2 = 0;
+        float m4 = 0;
+        for (int i = 0; i < N; i++) {
+            float d = x[i] - mean;
+            float d2 = d * d;
+            m2 += d2;
+            m4 += d2 * d2;
+        }
+        shapeFeatures(sumSq / N, m2 / N, m4 / N, peak, out);
+
+        for (int i = 0; i < N; i++) {
+            fft[2 * i] = x[i] * hann[i];
+            fft[2 * i + 1] = 0;
+        }
+        fftScalar();
+        spectralFeatures(out);
+    }
+
+    // Vectorized implementation (same results within float rounding)
+    void extract(const float *x, SlapFeatures &out) {
+#if FEATURES_USE_ESP_DSP
+        if (!dspReady) {
+            extractScalar(x, out);
+            return;
+        }
+
+        float sum, sumSq;
+        dsps_dotprod_f32(x, ones, &sum, N);
+        dsps_dotprod_f32(x, x, &sumSq, N);
+
+        float peak = 0;
+        for (int i = 0; i < N; i++) {
+            float a = fabsf(x[i]);
+            if (a > peak) peak = a;
+        }
+
+        // Central moments: d = x - mean, m2 = sum(d^2), m4 = d^2 . d^2
+        float mean = sum / N;
+        float m2, m4;
+        dsps_addc_f32(x, scratch, N, -mean, 1, 1);
+        dsps_mul_f32(scratch, scratch, scratch, N, 1, 1, 1);
+        dsps_dotprod_f32(scratch, ones, &m2, N);
+        dsps_dotprod_f32(scratch, scratch, &m4, N);
+        shapeFeatures(sumSq / N, m2 / N, m4 / N, peak, out);
+
+        // Windowed real input as interleaved complex
+        dsps_mul_f32(x, hann, scratch, N, 1, 1, 1);
+        for (int i = 0; i < N; i++) {
+            fft[2 * i] = scratch[i];
+            fft[2 * i + 1] = 0;
+        }
+        dsps_fft2r_fc32(fft, N);
+        dsps_bit_rev_fc32(fft, N);
+        spectralFeatures(out);
+#else
+        extractScalar(x, out);
+#endif
+    }
+};
+
+#endif // FEATUREEXTRACTOR_H
@@ -0,0 +1,272 @@
+/*
+ * PSRAM Framebuffer for the GC9A01A
+ *
+ * An Adafruit_GFX target that draws into a 128x128 RGB565 buffer in PSRAM
+ * instead of the panel. Drawing marks dirty rectangles (DirtyRegion);
+ * a flush trims each one to the pixels that differ from a second buffer
+ * mirroring the panel and pushes only those, each in its own address
+ * window, all in one SPI transaction. A screen that is cleared and redrawn
+ * therefore reaches the panel once, without flicker, and an animation
+ * frame costs only the pixels it changes.
+ *
+ * Two ways to get frames out:
+ *   - flush(): synchronous, on the caller's task
+ *   - startFlushTask(): a low-priority task on core 0 owns the panel and
+ *     a front buffer. present() / submit() copy the dirty rectangles of
+ *     the back buffer into the front buffer and wake the task, never
+ *     waiting on SPI. While the task is still pushing the previous frame
+ *     the submission stays pending and later ones replace it (their dirty
+ *     rectangles accumulate); poll() from loop() hands it over once the
+ *     task is idle.
+ *
+ * The task pushes with the driver's polled FIFO writes, not DMA. It sits
+ * below the sensor task on core 0, so the busy-wait only spends idle
+ * time; spi_device_queue_trans() would mean handing SPI2 from Arduino's
+ * SPIClass to the ESP-IDF spi_master driver, which also bounces PSRAM
+ * buffers through internal DMA memory.
+ *
+ * begin() allocates the buffers (64 KB, 96 KB with the flush task);
+ * without PSRAM it fails and the caller keeps drawing straight to the
+ * panel. Anything drawn to the panel directly must be followed by
+ * invalidate(), and nothing else may use the panel once the task runs.
+ */
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <atomic>
+#include "GC9A01A.h"
+#include "DirtyRegion.h"
+
+#define FRAMEBUFFER_WIDTH   128
+#define FRAMEBUFFER_HEIGHT  128
+#define FRAMEBUFFER_PIXELS  (FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT)
+
+// Flush task: below the sensor task on its core, so it only takes idle time
+#define FLUSH_TASK_CORE     0
+#define FLUSH_TASK_PRIORITY 1
+#define FLUSH_TASK_STACK    3072
+
+class FrameBuffer : public Adafruit_GFX {
+private:
+    uint16_t *pixels;       // back: drawn by the UI
+    uint16_t *front;        // handed to the flush task
+    uint16_t *shown;        // on the panel
+    DirtyRegion dirty;      // back vs front (or panel, without the task)
+    DirtyRegion frontDirty; // front vs panel, owned by the task while busy
+    std::atomic<bool> stale;    // panel content unknown: next flush sends everything
+
+    GC9A01A *panel;
+    TaskHandle_t task;
+    std::atomic<bool> busy;     // front buffer owned by the task
+    bool pending;               // submitted, not yet handed over
+
+    std::atomic<uint32_t> frames;
+    std::atomic<uint32_t> lastBytes;
+    std::atomic<uint32_t> totalBytes;
+    std::atomic<uint32_t> lastFlushUs;
+    std::atomic<uint32_t> maxFlushUs;
+    uint32_t submitted;
+    uint32_t replaced;
+
+    bool clipRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+        if (x < 0) { w += x; x = 0; }
+        if (y < 0) { h += y; y = 0; }
+        if ((x + w) > _width)  w = _width  - x;
+        if ((y + h) > _height) h = _height - y;
+        return (w > 0) && (h > 0);
+    }
+
+    static void taskEntry(void *param) {
+        static_cast<FrameBuffer *>(param)->run();
+    }
+
+    void run() {
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            push(front, frontDirty);
+            busy.store(false, std::memory_order_release);
+        }
+    }
+
+    // Send the pixels of src that changed inside region, update the mirror
+    void push(const uint16_t *src, DirtyRegion &region) {
+        uint32_t start = micros();
+        uint32_t bytes = 0;
+
+        bool full = stale.exchange(false);
+        if (full) {
+            region.clear();
+            region.add(0, 0, _width, _height);
+        }
+
+        panel->startWrite();
+        for (uint8_t i = 0; i < region.size(); i++) {
+            DirtyRect r = region[i];
+            if (!full && !DirtyRegion::trim(src, shown, FRAMEBUFFER_WIDTH, r)) continue;
+
+            const uint16_t *p = src + r.y * FRAMEBUFFER_WIDTH + r.x;
+            panel->pushPixels(r.x, r.y, r.w, r.h, p, FRAMEBUFFER_WIDTH);
+            for (int16_t row = 0; row < r.h; row++) {
+                memcpy(shown + (r.y + row) * FRAMEBUFFER_WIDTH + r.x,
+                       p + row * FRAMEBUFFER_WIDTH, r.w * sizeof(uint16_t));
+            }
+            bytes += r.area() * sizeof(uint16_t);
+        }
+        panel->endWrite();
+        region.clear();
+
+        uint32_t us = micros() - start;
+        frames++;
+        lastBytes = bytes;
+        totalBytes += bytes;
+        lastFlushUs = us;
+        if (us > maxFlushUs) maxFlushUs = us;
+    }
+
+public:
+    FrameBuffer()
+        : Adafruit_GFX(FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT), pixels(nullptr), front(nullptr),
+          shown(nullptr), stale(true), panel(nullptr), task(nullptr), busy(false), pending(false),
+          frames(0), lastBytes(0), totalBytes(0), lastFlushUs(0), maxFlushUs(0), submitted(0),
+          replaced(0) {}
+
+    bool begin() {
+        if (pixels != nullptr) return true;
+        if (!psramFound()) {
+            Serial.println("FrameBuffer: No PSRAM, drawing direct");
+            return false;
+        }
+
+        pixels = (uint16_t *)ps_malloc(FRAMEBUFFER_PIXELS * sizeof(uint16_t));
+        shown = (uint16_t *)ps_malloc(FRAMEBUFFER_PIXELS * sizeof(uint16_t));
+        if (pixels == nullptr || shown == nullptr) {
+            free(pixels);
+            free(shown);
+            pixels = shown = nullptr;
+            Serial.println("FrameBuffer: Allocation failed, drawing direct");
+            return false;
+        }
+        memset(pixels, 0, FRAMEBUFFER_PIXELS * sizeof(uint16_t));
+        invalidate();
+        return true;
+    }
+
+    // Hand flushing to a task that owns the panel from now on (after begin())
+    bool startFlushTask(GC9A01A &display) {
+        if (pixels == nullptr) return false;
+        if (task != nullptr) return true;
+
+        front = (uint16_t *)ps_malloc(FRAMEBUFFER_PIXELS * sizeof(uint16_t));
+        if (front == nullptr) {
+            Serial.println("FrameBuffer: No front buffer, flushing in loop()");
+            return false;
+        }
+        // front equals the back buffer; what the panel lacks stays in dirty
+        memcpy(front, pixels, FRAMEBUFFER_PIXELS * sizeof(uint16_t));
+        panel = &display;
+
+        if (xTaskCreatePinnedToCore(taskEntry, "display", FLUSH_TASK_STACK, this,
+                                    FLUSH_TASK_PRIORITY, &task,
+                                    FLUSH_TASK_CORE) != pdPASS) {
+            Serial.println("FrameBuffer: Failed to create flush task");
+            free(front);
+            front = nullptr;
+            task = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool isReady() const { return pixels != nullptr; }
+    bool isAsync() const { return task != nullptr; }
+
+    // The panel was drawn behind our back
+    void invalidate() { stale = true; }
+
+    // Adafruit_GFX drawing into the buffer
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+        if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) return;
+        pixels[y * FRAMEBUFFER_WIDTH + x] = color;
+        dirty.add(x, y, 1, 1);
+    }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        if (!clipRect(x, y, w, h)) return;
+        for (int16_t row = y; row < y + h; row++) {
+            uint16_t *p = pixels + row * FRAMEBUFFER_WIDTH + x;
+            for (int16_t i = 0; i < w; i++) p[i] = color;
+        }
+        dirty.add(x, y, w, h);
+    }
+
+    void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) { fillRect(x, y, w, h, color); }
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+
+    // Synchronous flush on the caller's task (no flush task);
+    // returns pixel bytes sent
+    uint32_t flush(GC9A01A &display) {
+        if (task != nullptr) return 0;
+        panel = &display;
+        push(pixels, dirty);
+        return lastBytes;
+    }
+
+    // Queue the back buffer for the flush task; true when handed over now,
+    // false when it waits for the task (replacing an earlier pending frame)
+    bool submit() {
+        submitted++;
+        if (pending) replaced++;
+        pending = true;
+        return poll();
+    }
+
+    // Hand a pending frame to the flush task if it is idle (loop task)
+    bool poll() {
+        if (!pending || task == nullptr) return false;
+        if (busy.load(std::memory_order_acquire)) return false;
+
+        // The task is idle: front and frontDirty are ours. Outside the
+        // dirty rectangles front already equals the back buffer.
+        for (uint8_t i = 0; i < dirty.size(); i++) {
+            const DirtyRect &r = dirty[i];
+            for (int16_t row = r.y; row < r.y + r.h; row++) {
+                memcpy(front + row * FRAMEBUFFER_WIDTH + r.x,
+                       pixels + row * FRAMEBUFFER_WIDTH + r.x, r.w * sizeof(uint16_t));
+            }
+        }
+        frontDirty = dirty;
+        dirty.clear();
+        pending = false;
+
+        busy.store(true, std::memory_order_release);
+        xTaskNotifyGive(task);
+        return true;
+    }
+
+    // End of a screen update: hand it to the task, or flush it here
+    void present(GC9A01A &display) {
+        if (task != nullptr) {
+            submit();
+        } else {
+            flush(display);
+        }
+    }
+
+    uint32_t getFrames() const { return frames; }
+    uint32_t getLastFlushBytes() const { return lastBytes; }
+    uint32_t getTotalFlushBytes() const { return totalBytes; }
+    uint32_t getLastFlushUs() const { return lastFlushUs; }
+    uint32_t getMaxFlushUs() const { return maxFlushUs; }
+    uint32_t getSubmitted() const { return submitted; }
+    uint32_t getReplaced() const { return replaced; }
+    bool isFlushing() const { return busy.load(std::memory_order_acquire); }
+};
+
+#endif // FRAMEBUFFER_H
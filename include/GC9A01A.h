@@ -11,6 +11,7 @@
 
 // GC9A01A Commands
 #define GC9A01A_SLPOUT 0x11
+#define GC9A01A_INVON  0x21
 #define GC9A01A_DISPON 0x29
 #define GC9A01A_CASET  0x2A
 #define GC9A01A_RASET  0x2B
@@ -18,23 +19,81 @@
 #define GC9A01A_MADCTL 0x36
 #define GC9A01A_COLMOD 0x3A
 
+// Fastest SPI clock the panel takes (write cycle >= 12.5 ns)
+#define GC9A01A_MAX_FREQ 80000000
+
+// Pixels per bulk SPI write: one panel line, kept byte-swapped to the
+// big-endian RGB565 the panel expects
+#define GC9A01A_LINE_PIXELS 128
+
 class GC9A01A : public Adafruit_GFX {
 public:
     GC9A01A(int8_t cs, int8_t dc, int8_t rst);
     
     void begin(uint32_t freq = 27000000);
+    
+    // SPI clock for every later transaction, capped at GC9A01A_MAX_FREQ
+    void setFrequency(uint32_t freq);
+    uint32_t getFrequency() const { return _freq; }
     void setRotation(uint8_t r);
     void drawPixel(int16_t x, int16_t y, uint16_t color);
     void fillScreen(uint16_t color);
     void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    
+    // Batched interface: Adafruit_GFX wraps every glyph and shape in
+    // startWrite()/endWrite(), so its write*() calls share one SPI
+    // transaction, with CS held low from the outermost startWrite() to
+    // its endWrite(). Calls may nest.
+    void startWrite(void);
+    void endWrite(void);
+    void writePixel(int16_t x, int16_t y, uint16_t color);
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    
+    // Blit w x h RGB565 pixels (row-major, stride pixels per row, 0 = w)
+    // in one transaction
+    void pushPixels(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels,
+                    int16_t stride = 0);
+    
+    // Unmasked bitmaps go through pushPixels(); masked ones stay per pixel
+    using Adafruit_GFX::drawRGBBitmap;
+    void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h);
+    void drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h);
     
 private:
     SPIClass *_spi;
     int8_t _cs, _dc, _rst;
+    uint8_t _writeDepth;
+    uint16_t _line[GC9A01A_LINE_PIXELS];
+    
+    // Transport: settings cached at the configured clock, CS and DC
+    // written straight to the GPIO registers
+    SPISettings _settings;
+    uint32_t _freq;
+    volatile uint32_t *_csSet;
+    volatile uint32_t *_csClear;
+    uint32_t _csMask;
+    volatile uint32_t *_dcSet;
+    volatile uint32_t *_dcClear;
+    uint32_t _dcMask;
+    
+    static void gpioRegisters(int8_t pin, volatile uint32_t *&set, volatile uint32_t *&clear,
+                              uint32_t &mask);
     
-    void writeCommand(uint8_t cmd);
-    void writeData(uint8_t data);
+    // Inside startWrite()/endWrite(): the command byte with DC low, then
+    // its parameters in one write
+    void writeCommand(uint8_t cmd, const uint8_t *params = nullptr, uint8_t len = 0);
     void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    
+    // Clip a rectangle to the screen, false when nothing is left
+    bool clipRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const;
+    
+    // Stream into the open window (DC high), a line buffer at a time
+    void writeColor(uint16_t color, uint32_t len);
+    void writePixels(const uint16_t *pixels, uint32_t len);
 };
 
 #endif
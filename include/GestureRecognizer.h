@@ -0,0 +1,164 @@
+/*
+ * Slap Gesture Recognizer
+ *
+ * Groups slaps into single / double / triple gestures by the time between
+ * their peaks. A sequence continues while each slap follows the previous
+ * one within the window, and ends when:
+ *   - it reaches GESTURE_MAX_SLAPS (recognized at once), or
+ *   - no slap peaked within the window after the last one
+ *
+ * The second case is decided against an event horizon rather than the
+ * wall clock: the sensor time up to which every slap has been delivered
+ * (impacts still ringing or waiting for classification hold it back).
+ * A slow event pipeline then delays the gesture but never splits one.
+ * Latency (last peak to recognition) is therefore at least the window
+ * plus the pipeline delay; each gesture carries its own and the
+ * recognizer keeps the worst.
+ *
+ * Each gesture has a bit mask of actions to run. No Arduino
+ * dependencies; all times are micros() values (wrap-safe).
+ */
+
+#ifndef GESTURERECOGNIZER_H
+#define GESTURERECOGNIZER_H
+
+#include <stdint.h>
+
+#define GESTURE_MAX_SLAPS 3
+
+// Gesture value = number of slaps
+enum Gesture : uint8_t {
+    GESTURE_NONE = 0,
+    GESTURE_SINGLE,
+    GESTURE_DOUBLE,
+    GESTURE_TRIPLE
+};
+
+// Action bits
+#define GESTURE_ACTION_DISPLAY  0x01    // show the gesture on screen
+#define GESTURE_ACTION_NETWORK  0x02    // push an event to web clients
+#define GESTURE_ACTION_LED      0x04    // blink the LED once per slap
+#define GESTURE_ACTION_ALL      0x07
+
+struct GestureConfig {
+    uint32_t windowUs = 400000;     // max time between consecutive slap peaks
+    uint8_t actions[GESTURE_MAX_SLAPS + 1] = {
+        0,
+        GESTURE_ACTION_DISPLAY | GESTURE_ACTION_NETWORK,
+        GESTURE_ACTION_ALL,
+        GESTURE_ACTION_ALL
+    };
+};
+
+struct GestureEvent {
+    Gesture gesture;
+    uint8_t actions;
+    uint32_t firstUs;           // peak of the first slap
+    uint32_t lastUs;            // peak of the last slap
+    uint32_t recognizedUs;
+    uint32_t latencyUs;         // last peak to recognition
+    float peak;                 // strongest slap (g)
+};
+
+class GestureRecognizer {
+private:
+    GestureConfig config;
+    uint8_t count;
+    uint32_t firstUs;
+    uint32_t lastUs;
+    float peak;
+
+    uint32_t recognized[GESTURE_MAX_SLAPS + 1];
+    uint32_t lastLatencyUs;
+    uint32_t maxLatencyUs;
+
+    static bool after(uint32_t a, uint32_t b) { return (int32_t)(a - b) > 0; }
+
+    void emit(uint32_t nowUs, GestureEvent &out) {
+        out.gesture = (Gesture)count;
+        out.actions = config.actions[count];
+        out.firstUs = firstUs;
+        out.lastUs = lastUs;
+        out.recognizedUs = nowUs;
+        out.latencyUs = nowUs - lastUs;
+        out.peak = peak;
+
+        recognized[count]++;
+        lastLatencyUs = out.latencyUs;
+        if (lastLatencyUs > maxLatencyUs) maxLatencyUs = lastLatencyUs;
+        count = 0;
+    }
+
+public:
+    GestureRecognizer() : count(0), firstUs(0), lastUs(0), peak(0) { resetStats(); }
+
+    void setConfig(const GestureConfig &cfg) { config = cfg; }
+    const GestureConfig &getConfig() const { return config; }
+
+    void setWindowUs(uint32_t us) { config.windowUs = us; }
+    void setActions(Gesture gesture, uint8_t actions) {
+        if (gesture >= GESTURE_SINGLE && gesture <= GESTURE_MAX_SLAPS) {
+            config.actions[gesture] = actions;
+        }
+    }
+
+    // Drop a sequence in progress
+    void reset() { count = 0; }
+
+    // Add a slap peaking at peakUs. Returns true and fills out when this
+    // completes a gesture, or when it arrives after the window of an
+    // unfinished sequence (which is then emitted; this slap starts anew).
+    bool addSlap(uint32_t peakUs, float g, uint32_t nowUs, GestureEvent &out) {
+        bool emitted = false;
+        if (count > 0 && after(peakUs - lastUs, config.windowUs)) {
+            emit(nowUs, out);
+            emitted = true;
+        }
+
+        if (count == 0) {
+            firstUs = peakUs;
+            peak = 0;
+        }
+        count++;
+        lastUs = peakUs;
+        if (g > peak) peak = g;
+
+        if (!emitted && count >= GESTURE_MAX_SLAPS) {
+            emit(nowUs, out);
+            return true;
+        }
+        return emitted;
+    }
+
+    // End the sequence once the event horizon has passed its window
+    bool poll(uint32_t horizonUs, uint32_t nowUs, GestureEvent &out) {
+        if (count == 0 || !after(horizonUs - lastUs, config.windowUs)) return false;
+        emit(nowUs, out);
+        return true;
+    }
+
+    bool isPending() const { return count > 0; }
+    uint8_t getPendingSlaps() const { return count; }
+
+    // Statistics
+    uint32_t getRecognized(Gesture gesture) const { return recognized[gesture]; }
+    uint32_t getLastLatencyUs() const { return lastLatencyUs; }
+    uint32_t getMaxLatencyUs() const { return maxLatencyUs; }
+
+    void resetStats() {
+        for (int i = 0; i <= GESTURE_MAX_SLAPS; i++) recognized[i] = 0;
+        lastLatencyUs = 0;
+        maxLatencyUs = 0;
+    }
+
+    static const char *name(Gesture gesture) {
+        switch (gesture) {
+        case GESTURE_SINGLE: return "single";
+        case GESTURE_DOUBLE: return "double";
+        case GESTURE_TRIPLE: return "triple";
+        default: return "none";
+        }
+    }
+};
+
+#endif // GESTURERECOGNIZER_H
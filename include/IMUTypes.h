@@ -0,0 +1,92 @@
+/*
+ * IMU Sample Types
+ *
+ * Range / rate settings and sample records shared by the QMI8658C driver
+ * and everything downstream of it. No Arduino dependencies, so the
+ * detection code builds on the host (tests, tools/replay).
+ */
+
+#ifndef IMUTYPES_H
+#define IMUTYPES_H
+
+#include <stdint.h>
+
+// Accelerometer full-scale range (CTRL2 aFS, bits 6:4)
+enum QMI8658C_AccelRange {
+    QMI8658C_ACCEL_2G = 0,
+    QMI8658C_ACCEL_4G = 1,
+    QMI8658C_ACCEL_8G = 2,
+    QMI8658C_ACCEL_16G = 3
+};
+
+// Gyroscope full-scale range (CTRL3 gFS, bits 6:4)
+enum QMI8658C_GyroRange {
+    QMI8658C_GYRO_16DPS = 0,
+    QMI8658C_GYRO_32DPS = 1,
+    QMI8658C_GYRO_64DPS = 2,
+    QMI8658C_GYRO_128DPS = 3,
+    QMI8658C_GYRO_256DPS = 4,
+    QMI8658C_GYRO_512DPS = 5,
+    QMI8658C_GYRO_1024DPS = 6,
+    QMI8658C_GYRO_2048DPS = 7
+};
+
+// Output data rate (CTRL2/CTRL3 ODR, bits 3:0). With accel and gyro both
+// enabled the sensor runs at the 6DOF rate shown in brackets.
+enum QMI8658C_ODR {
+    QMI8658C_ODR_8000HZ = 0,    // (7174.4 Hz)
+    QMI8658C_ODR_4000HZ = 1,    // (3587.2 Hz)
+    QMI8658C_ODR_2000HZ = 2,    // (1793.6 Hz)
+    QMI8658C_ODR_1000HZ = 3,    // (896.8 Hz)
+    QMI8658C_ODR_500HZ = 4,     // (448.4 Hz)
+    QMI8658C_ODR_250HZ = 5,     // (224.2 Hz)
+    QMI8658C_ODR_125HZ = 6,     // (112.1 Hz)
+    QMI8658C_ODR_62HZ = 7,      // (56.05 Hz)
+    QMI8658C_ODR_31HZ = 8       // (28.025 Hz)
+};
+
+struct IMUData {
+    float accelX, accelY, accelZ;  // in g
+    float gyroX, gyroY, gyroZ;     // in deg/s
+    float temperature;              // in celsius
+};
+
+// Raw register counts, as read from TEMP_L..GZ_H
+struct IMURawData {
+    int16_t temperature;
+    int16_t accelX, accelY, accelZ;
+    int16_t gyroX, gyroY, gyroZ;
+};
+
+// Raw accel/gyro frame drained from the FIFO
+struct IMUSample {
+    uint32_t timestampUs;           // micros() at which the sample was taken
+    int16_t accelX, accelY, accelZ;
+    int16_t gyroX, gyroY, gyroZ;
+    uint8_t accelRange;             // QMI8658C_AccelRange the counts were taken at
+};
+
+// Sensor calibration in physical units:
+//   accel = accelMatrix * measured + accelOffset   (g)
+//   gyro  = measured - gyroBias                     (deg/s)
+// accelMatrix holds per-axis scale on the diagonal and cross-axis terms
+struct IMUCalibration {
+    bool valid;
+    float accelMatrix[3][3];
+    float accelOffset[3];
+    float gyroBias[3];
+};
+
+// Temperature drift of the accelerometer bias, removed after calibration:
+//   accel -= accelSlope * (temperature - refTempC)   (g)
+struct IMUTempCompensation {
+    bool valid;
+    float refTempC;             // temperature at which the correction is 0
+    float accelSlope[3];        // g per degree C
+};
+
+// Counts to physical units for a range setting
+inline float imuAccelScale(uint8_t range) { return (float)(2 << range) / 32768.0f; }   // g
+inline float imuGyroScale(uint8_t range) { return (float)(16 << range) / 32768.0f; }   // dps
+
+#endif // IMUTYPES_H
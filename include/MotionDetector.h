@@ -0,0 +1,199 @@
+/*
+ * Slap Motion Detector
+ *
+ * Removes gravity with a per-axis low-pass filter and compares the
+ * remaining (linear) acceleration magnitude against a threshold.
+ * Runs on every IMU sample; independent of loop() timing.
+ *
+ * MotionDetector works in float g. FixedMotionDetector is the same
+ * algorithm on raw int16 counts: squared magnitude against a squared
+ * threshold, no sqrt and no float on the per-sample path.
+ *
+ * The sensor task runs SlapDetector (through DetectionPipeline); both
+ * detectors here stay as the references test/detector_benchmark.cpp
+ * measures it against.
+ */
+
+#ifndef MOTIONDETECTOR_H
+#define MOTIONDETECTOR_H
+
+#include <math.h>
+#include "IMUTypes.h"
+#include "FeatureExtractor.h"
+#include "SlapClassifier.h"
+
+// Where a slap event was detected
+enum SlapSource : uint8_t {
+    SLAP_SOURCE_HOST = 0,        // detector running on the MCU
+    SLAP_SOURCE_TAP = 1,         // QMI8658C tap engine
+    SLAP_SOURCE_ANY_MOTION = 2   // QMI8658C any-motion engine
+};
+
+// Published when a sample above threshold sets a new peak for the
+// current excursion (MotionDetector / FixedMotionDetector), or once per
+// impact when it ends (SlapDetector)
+struct SlapEvent {
+    uint32_t timestampUs;   // sample timestamp (of the peak for SlapDetector)
+    float peak;             // linear acceleration magnitude in g,
+                            // 0 if unknown (on-chip engines)
+    SlapSource source;
+    uint32_t durationUs;    // time above threshold, 0 if not measured
+    float energy;           // integral of |a|^2 over the impact, g^2*s
+    float jerk;             // peak jerk magnitude, g/s
+    int8_t direction;       // dominant axis at the peak: +1..+3 = +X..+Z,
+                            // -1..-3 = -X..-Z, 0 = unknown
+    SlapFeatures features;  // waveform features, SlapDetector events only
+    SlapClass label = SLAP_CLASS_UNKNOWN;   // SlapDetector events only
+    uint8_t confidence = 0; // percent
+};
+
+class MotionDetector {
+private:
+    float gravityX, gravityY, gravityZ;
+    float alpha;
+    float threshold;
+    float motion;
+    float excursionPeak;
+
+    // Gravity estimate time constant
+    static constexpr float GRAVITY_TAU_S = 0.45f;
+
+public:
+    MotionDetector()
+        : gravityX(0), gravityY(0), gravityZ(1.0f),
+          alpha(0.99f), threshold(1.0f), motion(0), excursionPeak(0) {}
+
+    // Keep the gravity time constant independent of the sample rate
+    void setSampleRate(float hz) {
+        alpha = expf(-1.0f / (hz * GRAVITY_TAU_S));
+    }
+
+    void setThreshold(float g) { threshold = g; }
+    float getThreshold() const { return threshold; }
+
+    // Linear acceleration magnitude of the last sample, in g
+    float getMotion() const { return motion; }
+
+    // Process one sample. Returns true and fills event when the sample
+    // is above threshold and exceeds the peak of the current excursion.
+    bool update(const IMUData &data, uint32_t timestampUs, SlapEvent &event) {
+        // Low-pass filter for gravity estimation
+        gravityX = alpha * gravityX + (1 - alpha) * data.accelX;
+        gravityY = alpha * gravityY + (1 - alpha) * data.accelY;
+        gravityZ = alpha * gravityZ + (1 - alpha) * data.accelZ;
+
+        // Linear acceleration (motion only, gravity removed)
+        float linearX = data.accelX - gravityX;
+        float linearY = data.accelY - gravityY;
+        float linearZ = data.accelZ - gravityZ;
+
+        // Motion magnitude
+        motion = sqrtf(linearX * linearX +
+                       linearY * linearY +
+                       linearZ * linearZ);
+
+        if (motion <= threshold) {
+            excursionPeak = 0;
+            return false;
+        }
+
+        if (motion <= excursionPeak) return false;
+
+        excursionPeak = motion;
+        event.timestampUs = timestampUs;
+        event.peak = motion;
+        event.source = SLAP_SOURCE_HOST;
+        event.durationUs = 0;
+        event.energy = 0;
+        event.jerk = 0;
+        event.direction = 0;
+        return true;
+    }
+};
+
+class FixedMotionDetector {
+private:
+    // Counts are normalized to the ±16g scale (2048 counts/g) so that
+    // auto-range switches do not disturb the filter state
+    static constexpr int32_t COUNTS_PER_G = 2048;
+
+    // Gravity estimate in counts with 4 fractional bits
+    int32_t gravityX, gravityY, gravityZ;
+    uint8_t shift;              // low-pass coefficient alpha = 1 - 2^-shift
+    uint32_t thresholdSq;       // (threshold in counts)^2
+    uint32_t motionSq;
+    uint32_t excursionPeakSq;
+
+    static constexpr float GRAVITY_TAU_S = 0.45f;
+
+    static int32_t clamp16(int32_t v) {
+        return v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+    }
+
+public:
+    FixedMotionDetector()
+        : gravityX(0), gravityY(0), gravityZ(COUNTS_PER_G << 4),
+          shift(7), thresholdSq(COUNTS_PER_G * COUNTS_PER_G),
+          motionSq(0), excursionPeakSq(0) {}
+
+    // Nearest power-of-two filter length to the gravity time constant
+    void setSampleRate(float hz) {
+        float samples = hz * GRAVITY_TAU_S;
+        shift = 1;
+        while (shift < 15 && (float)(1 << shift) * 1.41421356f < samples) {
+            shift++;
+        }
+    }
+
+    void setThreshold(float g) {
+        float counts = g * COUNTS_PER_G;
+        if (counts > 32767.0f) counts = 32767.0f;
+        thresholdSq = (uint32_t)counts * (uint32_t)counts;
+    }
+
+    // Linear acceleration magnitude of the last sample, in g
+    float getMotion() const { return sqrtf((float)motionSq) / COUNTS_PER_G; }
+
+    bool update(const IMUSample &sample, SlapEvent &event) {
+        // ±2g counts >> 3, ±4g >> 2, ±8g >> 1, ±16g as-is
+        uint8_t norm = 3 - sample.accelRange;
+        int32_t ax = sample.accelX >> norm;
+        int32_t ay = sample.accelY >> norm;
+        int32_t az = sample.accelZ >> norm;
+
+        // Low-pass filter for gravity estimation
+        gravityX += (ax * 16 - gravityX) >> shift;
+        gravityY += (ay * 16 - gravityY) >> shift;
+        gravityZ += (az * 16 - gravityZ) >> shift;
+
+        // Linear acceleration (motion only, gravity removed)
+        int32_t linearX = clamp16(ax - (gravityX >> 4));
+        int32_t linearY = clamp16(ay - (gravityY >> 4));
+        int32_t linearZ = clamp16(az - (gravityZ >> 4));
+
+        // Squared magnitude; at most 3 * 32768^2, fits in 32 bits
+        motionSq = (uint32_t)(linearX * linearX) +
+                   (uint32_t)(linearY * linearY) +
+                   (uint32_t)(linearZ * linearZ);
+
+        if (motionSq <= thresholdSq) {
+            excursionPeakSq = 0;
+            return false;
+        }
+
+        if (motionSq <= excursionPeakSq) return false;
+
+        // Convert to g only when reporting
+        excursionPeakSq = motionSq;
+        event.timestampUs = sample.timestampUs;
+        event.peak = getMotion();
+        event.source = SLAP_SOURCE_HOST;
+        event.durationUs = 0;
+        event.energy = 0;
+        event.jerk = 0;
+        event.direction = 0;
+        return true;
+    }
+};
+
+#endif // MOTIONDETECTOR_H
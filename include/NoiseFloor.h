@@ -0,0 +1,88 @@
+/*
+ * Adaptive Noise Floor
+ *
+ * Robust running estimate of the background vibration level from the
+ * high-passed acceleration magnitude, for thresholds that adapt to the
+ * mounting (desk, wall, vehicle).
+ *
+ * Sliding median over the last NOISE_WINDOW samples, kept as a ring of
+ * quantized magnitudes plus their histogram: push() is O(1) and the
+ * median is one O(NOISE_BINS) walk of the histogram. For zero-mean
+ * Gaussian noise on three axes |a| follows a Maxwell distribution whose
+ * median is 1.5382 sigma, so sigma = median / 1.5382 (the 3-D analogue of
+ * MAD / 0.6745). A median ignores the impacts themselves as long as they
+ * cover less than half the window.
+ *
+ * Only ~2.5 KB of state, no heap. No Arduino dependencies.
+ */
+
+#ifndef NOISEFLOOR_H
+#define NOISEFLOOR_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define NOISE_WINDOW    2048        // samples (~9 s at 224 Hz)
+#define NOISE_BINS      256
+#define NOISE_BIN_G     0.0005f     // 0.5 mg per bin, medians up to 128 mg
+#define NOISE_MIN_FILL  256         // samples before the estimate is used
+
+class NoiseFloorEstimator {
+private:
+    static constexpr float MAXWELL_MEDIAN = 1.5382f;
+
+    uint8_t ring[NOISE_WINDOW];
+    uint16_t histogram[NOISE_BINS];
+    uint16_t head;
+    uint16_t count;
+    float sigma;
+
+public:
+    NoiseFloorEstimator() { reset(); }
+
+    void reset() {
+        memset(histogram, 0, sizeof(histogram));
+        head = 0;
+        count = 0;
+        sigma = 0;
+    }
+
+    // Add one linear acceleration magnitude (g)
+    void push(float magnitude) {
+        float scaled = magnitude / NOISE_BIN_G;
+        uint8_t bin = scaled >= NOISE_BINS - 1 ? NOISE_BINS - 1 : (uint8_t)scaled;
+
+        if (count == NOISE_WINDOW) {
+            histogram[ring[head]]--;
+        } else {
+            count++;
+        }
+        ring[head] = bin;
+        histogram[bin]++;
+        head = (head + 1) % NOISE_WINDOW;
+    }
+
+    // Recompute sigma from the current window; returns it (g)
+    float update() {
+        if (count < NOISE_MIN_FILL) return sigma;
+
+        // Median bin, interpolated linearly inside the bin
+        uint32_t target = count / 2;
+        uint32_t below = 0;
+        int bin = 0;
+        while (bin < NOISE_BINS - 1 && below + histogram[bin] <= target) {
+            below += histogram[bin++];
+        }
+        float fraction = histogram[bin] ? (float)(target - below) / histogram[bin] : 0.5f;
+        float median = (bin + fraction) * NOISE_BIN_G;
+
+        sigma = median / MAXWELL_MEDIAN;
+        return sigma;
+    }
+
+    bool isReady() const { return count >= NOISE_MIN_FILL; }
+    float getSigma() const { return sigma; }
+    uint16_t getCount() const { return count; }
+};
+
+#endif // NOISEFLOOR_H
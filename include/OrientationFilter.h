@@ -0,0 +1,171 @@
+/*
+ * Orientation Filter
+ *
+ * Mahony complementary filter: integrates the gyro into a quaternion and
+ * pulls it towards the measured gravity direction with a PI correction
+ * (the integral term tracks the gyro bias). Gravity predicted by the
+ * quaternion is subtracted from the accelerometer, so rotating the board
+ * does not show up as linear acceleration the way it does with a
+ * high-pass or low-pass gravity estimate.
+ *
+ * The accel correction is skipped while |a| is far from 1 g (impacts,
+ * free fall), so slaps do not tilt the estimate. No yaw reference: the
+ * heading drifts, which does not matter for gravity removal.
+ *
+ * One update is ~80 multiply-adds and one reciprocal square root (two
+ * when the accel correction runs), cheap enough for every sample at full
+ * ODR. No Arduino dependencies.
+ */
+
+#ifndef ORIENTATIONFILTER_H
+#define ORIENTATIONFILTER_H
+
+#include <math.h>
+
+struct OrientationConfig {
+    float kp = 2.0f;            // proportional gain (1/s), ~0.5 s to converge
+    float ki = 0.05f;           // integral gain, gyro bias tracking
+    float accelGate = 0.15f;    // skip correction when ||a| - 1 g| exceeds this
+};
+
+class OrientationFilter {
+private:
+    static constexpr float DEG_TO_RAD_F = (float)M_PI / 180.0f;
+
+    OrientationConfig config;
+    float q[4];                 // w, x, y, z; rotates sensor frame to world
+    float bias[3];              // integral correction (rad/s)
+    float gravity[3];           // unit gravity in the sensor frame
+    float linear[3];            // a - gravity (g)
+    float gateLowSq, gateHighSq;
+    bool initialized;
+
+    // Third column of the rotation matrix: world Z seen from the sensor
+    void predictGravity() {
+        gravity[0] = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+        gravity[1] = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+        gravity[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+    }
+
+    // Level the quaternion to one accel sample (yaw = 0)
+    void initialize(float ax, float ay, float az) {
+        float roll = atan2f(ay, az);
+        float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+        float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+        float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+        q[0] = cr * cp;
+        q[1] = sr * cp;
+        q[2] = cr * sp;
+        q[3] = -sr * sp;
+        initialized = true;
+    }
+
+    void design() {
+        float lo = 1.0f - config.accelGate;
+        float hi = 1.0f + config.accelGate;
+        gateLowSq = lo > 0 ? lo * lo : 0;
+        gateHighSq = hi * hi;
+    }
+
+public:
+    OrientationFilter() { design(); reset(); }
+
+    void setConfig(const OrientationConfig &cfg) {
+        config = cfg;
+        design();
+    }
+    const OrientationConfig &getConfig() const { return config; }
+
+    // Start over from the next accel sample
+    void reset() {
+        q[0] = 1.0f;
+        q[1] = q[2] = q[3] = 0;
+        bias[0] = bias[1] = bias[2] = 0;
+        gravity[0] = gravity[1] = 0;
+        gravity[2] = 1.0f;
+        linear[0] = linear[1] = linear[2] = 0;
+        initialized = false;
+    }
+
+    // One sample: accel in g, gyro in dps, dt in seconds
+    void update(float ax, float ay, float az, float gx, float gy, float gz, float dt) {
+        float normSq = ax * ax + ay * ay + az * az;
+        if (!initialized) {
+            if (normSq == 0) return;
+            initialize(ax, ay, az);
+            predictGravity();
+        }
+
+        gx *= DEG_TO_RAD_F;
+        gy *= DEG_TO_RAD_F;
+        gz *= DEG_TO_RAD_F;
+
+        // Error between measured and predicted gravity directions. Gravity
+        // is first advanced by this sample's rotation (dg/dt = g x w), else
+        // the correction lags by one sample and fights fast turns.
+        if (normSq > gateLowSq && normSq < gateHighSq) {
+            float px = gravity[0] + (gravity[1] * gz - gravity[2] * gy) * dt;
+            float py = gravity[1] + (gravity[2] * gx - gravity[0] * gz) * dt;
+            float pz = gravity[2] + (gravity[0] * gy - gravity[1] * gx) * dt;
+
+            float inv = 1.0f / sqrtf(normSq);
+            float mx = ax * inv, my = ay * inv, mz = az * inv;
+            float ex = my * pz - mz * py;
+            float ey = mz * px - mx * pz;
+            float ez = mx * py - my * px;
+
+            if (config.ki > 0) {
+                bias[0] += config.ki * ex * dt;
+                bias[1] += config.ki * ey * dt;
+                bias[2] += config.ki * ez * dt;
+            }
+            gx += config.kp * ex;
+            gy += config.kp * ey;
+            gz += config.kp * ez;
+        }
+        gx += bias[0];
+        gy += bias[1];
+        gz += bias[2];
+
+        // q += 0.5 * q * (0, g) * dt
+        float h = 0.5f * dt;
+        float w = q[0], x = q[1], y = q[2], z = q[3];
+        q[0] = w + (-x * gx - y * gy - z * gz) * h;
+        q[1] = x + (w * gx + y * gz - z * gy) * h;
+        q[2] = y + (w * gy - x * gz + z * gx) * h;
+        q[3] = z + (w * gz + x * gy - y * gx) * h;
+
+        float inv = 1.0f / sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        q[0] *= inv;
+        q[1] *= inv;
+        q[2] *= inv;
+        q[3] *= inv;
+
+        predictGravity();
+        linear[0] = ax - gravity[0];
+        linear[1] = ay - gravity[1];
+        linear[2] = az - gravity[2];
+    }
+
+    bool isInitialized() const { return initialized; }
+
+    // Quaternion w, x, y, z (sensor to world)
+    const float *getQuaternion() const { return q; }
+
+    // Unit gravity direction in the sensor frame
+    const float *getGravity() const { return gravity; }
+
+    // Gravity-free acceleration of the last sample in the sensor frame (g)
+    const float *getLinear() const { return linear; }
+
+    // Integral correction, i.e. minus the estimated gyro bias (dps)
+    float getBiasCorrection(int axis) const { return bias[axis] / DEG_TO_RAD_F; }
+
+    // Tilt angles in degrees
+    float getRoll() const { return atan2f(gravity[1], gravity[2]) / DEG_TO_RAD_F; }
+    float getPitch() const {
+        return atan2f(-gravity[0], sqrtf(gravity[1] * gravity[1] + gravity[2] * gravity[2])) / DEG_TO_RAD_F;
+    }
+};
+
+#endif // ORIENTATIONFILTER_H
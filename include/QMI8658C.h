@@ -14,6 +14,9 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "AsyncI2C.h"
+#include "EspI2C.h"
+#include "IMUTypes.h"
 
 // I2C Address
 #define QMI8658C_I2C_ADDR 0x6B
@@ -26,6 +29,23 @@
 #define QMI8658C_CTRL4        0x05
 #define QMI8658C_CTRL5        0x06
 #define QMI8658C_CTRL7        0x08
+#define QMI8658C_CTRL8        0x09
+#define QMI8658C_CTRL9        0x0A
+
+// Host command parameter registers (CAL1_L..CAL4_H)
+#define QMI8658C_CAL1_L       0x0B
+
+// FIFO registers
+#define QMI8658C_FIFO_WTM_TH  0x13
+#define QMI8658C_FIFO_CTRL    0x14
+#define QMI8658C_FIFO_SMPL_CNT 0x15
+#define QMI8658C_FIFO_STATUS  0x16
+#define QMI8658C_FIFO_DATA    0x17
+
+// Status registers
+#define QMI8658C_STATUSINT    0x2D
+#define QMI8658C_STATUS1      0x2F
+#define QMI8658C_TAP_STATUS   0x59
 
 // Data registers
 #define QMI8658C_TEMP_L       0x33
@@ -46,22 +66,205 @@
 // Expected WHO_AM_I value
 #define QMI8658C_CHIP_ID      0x05
 
-struct IMUData {
-    float accelX, accelY, accelZ;  // in g
-    float gyroX, gyroY, gyroZ;     // in deg/s
-    float temperature;              // in celsius
+// Burst read: TEMP_L..GZ_H in one auto-incrementing transaction, or
+// AX_L..GZ_H when the temperature is not due
+#define QMI8658C_SAMPLE_BYTES 14
+#define QMI8658C_MOTION_BYTES 12
+
+// Temperature changes over minutes: read it at this interval by default
+#define QMI8658C_TEMP_INTERVAL_MS 1000
+
+// CTRL1 fields
+#define QMI8658C_CTRL1_ADDR_AI  0x40
+#define QMI8658C_CTRL1_INT2_EN  0x10
+#define QMI8658C_CTRL1_INT1_EN  0x08
+#define QMI8658C_CTRL1_FIFO_INT1 0x04   // FIFO interrupt on INT1 (default INT2)
+
+// CTRL7 fields
+#define QMI8658C_CTRL7_DRDY_DIS 0x20
+
+// Task notification bits set by the interrupt handler
+#define QMI8658C_NOTIFY_DATA  0x01
+#define QMI8658C_NOTIFY_MOTION 0x02
+
+// CTRL8 fields: on-chip motion engines
+#define QMI8658C_CTRL8_TAP_EN        0x01
+#define QMI8658C_CTRL8_ANYMOTION_EN  0x02
+#define QMI8658C_CTRL8_ACT_INT1      0x40   // Motion engine interrupt on INT1
+#define QMI8658C_CTRL8_HS_STATUSINT  0x80   // CTRL9 handshake via STATUSINT, not INT1
+
+// STATUS1 flags
+#define QMI8658C_STATUS1_TAP         0x02
+#define QMI8658C_STATUS1_ANYMOTION   0x20
+
+// CTRL9 host commands
+#define QMI8658C_CMD_ACK      0x00
+#define QMI8658C_CMD_RST_FIFO 0x04
+#define QMI8658C_CMD_REQ_FIFO 0x05
+#define QMI8658C_CMD_CONFIGURE_TAP    0x0C
+#define QMI8658C_CMD_CONFIGURE_MOTION 0x0E
+
+// FIFO_CTRL fields
+#define QMI8658C_FIFO_RD_MODE 0x80
+#define QMI8658C_FIFO_MODE_STREAM 0x02
+
+// FIFO_STATUS flags
+#define QMI8658C_FIFO_FULL    0x80
+#define QMI8658C_FIFO_WTM     0x40
+#define QMI8658C_FIFO_OVFLOW  0x20
+
+// One FIFO frame with accel + gyro enabled: AX..AZ, GX..GZ
+#define QMI8658C_FIFO_FRAME_BYTES 12
+
+// Auto-ranging: up to ±16g near saturation, one step down after each
+// quiet second
+#define QMI8658C_AUTORANGE_HIGH  29490   // 90% of full scale
+#define QMI8658C_AUTORANGE_LOW   6553    // 40% of the next lower range
+
+// Range switches remembered until the frames before them are drained
+#define QMI8658C_RANGE_MARKS     4
+
+// Interrupt sources (both are routed to INT2)
+enum QMI8658C_IntSource {
+    QMI8658C_INT_DATA_READY,
+    QMI8658C_INT_FIFO_WATERMARK
+};
+
+// On-chip motion engines (CTRL8 enable bits)
+enum QMI8658C_MotionEngine {
+    QMI8658C_ENGINE_TAP = QMI8658C_CTRL8_TAP_EN,
+    QMI8658C_ENGINE_ANY_MOTION = QMI8658C_CTRL8_ANYMOTION_EN
+};
+
+// Tap engine parameters (CTRL_CMD_CONFIGURE_TAP); windows are in samples
+struct QMI8658C_TapConfig {
+    uint8_t peakWindow;         // max width of the tap peak
+    uint8_t priority;           // axis priority when several axes see the tap
+    uint16_t tapWindow;         // quiet time required after a tap
+    uint16_t doubleTapWindow;   // max gap between the taps of a double tap
+    uint8_t alpha;              // peak detection filter, x/128
+    uint8_t gamma;              // quiet detection filter, x/128
+    float peakThresholdG;       // minimum peak magnitude
+    float quietThresholdG;      // max magnitude during the quiet window
+};
+
+// Event decoded from STATUS1 / TAP_STATUS
+struct QMI8658C_MotionEvent {
+    bool tap;
+    bool anyMotion;
+    uint8_t tapCount;           // 1 = single, 2 = double
+    uint8_t tapAxis;            // 0 = X, 1 = Y, 2 = Z
+    bool tapNegative;           // tap polarity
+};
+
+// FIFO depth in frames
+enum QMI8658C_FifoSize {
+    QMI8658C_FIFO_16 = 0,
+    QMI8658C_FIFO_32 = 1,
+    QMI8658C_FIFO_64 = 2,
+    QMI8658C_FIFO_128 = 3
 };
 
 class QMI8658C {
 public:
     QMI8658C();
     
+    // Register access goes through an AsyncI2C queue; the TwoWire overload
+    // wraps the bus in a synchronous WireI2C backend
+    bool begin(AsyncI2C &bus, uint8_t addr = QMI8658C_I2C_ADDR);
     bool begin(TwoWire &wire = Wire, uint8_t addr = QMI8658C_I2C_ADDR);
     bool isConnected();
     
     void update();
     IMUData getData();
     
+    // Raw sample access (one 12-byte burst read per sample, 14 bytes when
+    // the temperature is due; raw.temperature holds the latest reading).
+    // Counts are uncalibrated; getRawData() is the last sample update()
+    // read, getData() its calibrated value.
+    bool readRaw(IMURawData &raw);
+    IMURawData getRawData() { return rawData; }
+    
+    // Bus time of the last sample read, in microseconds
+    uint32_t getLastBusTimeUs() { return lastBusTimeUs; }
+    
+    // Range and output data rate, changeable at runtime
+    bool setAccelRange(QMI8658C_AccelRange range);
+    bool setGyroRange(QMI8658C_GyroRange range);
+    bool setODR(QMI8658C_ODR rate);
+    QMI8658C_AccelRange getAccelRange() { return accelRange; }
+    QMI8658C_GyroRange getGyroRange() { return gyroRange; }
+    QMI8658C_ODR getODR() { return odr; }
+    float getSampleRateHz() { return 1000000.0f / samplePeriodUs; }
+    
+    // Auto-ranging: switch the accel range straight to ±16g near
+    // saturation and back down to the base range when motion is quiet.
+    // At the ±8g default base a slap's first peak does not clip, and the
+    // resolution at rest (0.24 mg) is still far below the noise.
+    void setAutoRange(bool enabled, QMI8658C_AccelRange base = QMI8658C_ACCEL_8G);
+    bool isAutoRange() { return autoRange; }
+    uint32_t getRangeSwitches() { return rangeSwitches; }
+    
+    // Scale factors for a given range setting
+    static float accelScaleFor(uint8_t range) { return imuAccelScale(range); }
+    static float gyroScaleFor(uint8_t range) { return imuGyroScale(range); }
+    
+    // FIFO streaming: samples are buffered on-chip and drained in batches
+    bool enableFifo(uint8_t watermark, QMI8658C_FifoSize size = QMI8658C_FIFO_128);
+    void disableFifo();
+    bool resetFifo();
+    bool isFifoEnabled() { return fifoEnabled; }
+    uint16_t getFifoCount();
+    size_t readFifo(IMUSample *out, size_t maxSamples);
+    uint32_t getFifoOverflows() { return fifoOverflows; }
+    uint32_t getSamplePeriodUs() { return samplePeriodUs; }
+    
+    // Read one sample into the same record format used by the FIFO
+    bool readSample(IMUSample &sample);
+    
+    // Interrupt-driven acquisition: a GPIO ISR wakes the notify task
+    bool enableInterrupt(QMI8658C_IntSource source, uint8_t pin);
+    void disableInterrupt();
+    void setNotifyTask(TaskHandle_t task) { notifyTask = task; }
+    bool waitForData(TickType_t timeout);
+    uint32_t getLastInterruptUs() { return irqTimestampUs; }
+    uint32_t getIrqLatencyUs() { return irqLatencyUs; }
+    
+    // On-chip motion engines: tap / any-motion detection inside the sensor,
+    // signalled on INT1 with QMI8658C_NOTIFY_MOTION
+    bool configureTap(const QMI8658C_TapConfig &config);
+    bool configureAnyMotion(float thresholdG, uint8_t windowSamples);
+    bool enableMotionEngines(uint8_t engines, uint8_t pin);
+    void disableMotionEngines();
+    bool readMotionEvent(QMI8658C_MotionEvent &event);
+    uint32_t getLastMotionInterruptUs() { return motionIrqTimestampUs; }
+    
+    // Wait for any notification bit (data and/or motion); returns the bits
+    uint32_t waitForEvents(TickType_t timeout);
+    
+    // Calibration, applied to every sample as one affine transform on the
+    // raw counts (before toIMUData / the detectors see them)
+    void setCalibration(const IMUCalibration &cal);
+    void clearCalibration();
+    const IMUCalibration &getCalibration() { return calibration; }
+    static void identityCalibration(IMUCalibration &cal);
+    
+    // Temperature drift of the accel bias, applied with the calibration
+    // and updated at every temperature read
+    void setTempCompensation(const IMUTempCompensation &comp);
+    void clearTempCompensation();
+    const IMUTempCompensation &getTempCompensation() { return tempComp; }
+    
+    // Temperature is read every intervalMs (0 = with every sample), by the
+    // polled reads and after FIFO drains
+    void setTemperatureInterval(uint32_t intervalMs) { tempIntervalMs = intervalMs; }
+    uint32_t getTemperatureInterval() { return tempIntervalMs; }
+    bool readTemperature();
+    uint32_t getTemperatureReads() { return temperatureReads; }
+    
+    // Convert a FIFO sample to physical units
+    IMUData toIMUData(const IMUSample &sample);
+    
     // Individual data access
     float getAccelX() { return data.accelX; }
     float getAccelY() { return data.accelY; }
@@ -72,17 +275,94 @@ public:
     float getTemperature() { return data.temperature; }
     
 private:
-    TwoWire *_wire;
+    AsyncI2C *_bus;
+    WireI2C *_wireBus;      // owned, only when started on a TwoWire
+    void *_signal;          // completion signal for this driver's transactions
     uint8_t _addr;
     IMUData data;
+    IMURawData rawData;
+    uint32_t lastBusTimeUs;
+    
+    // Temperature decimation
+    uint32_t tempIntervalMs = QMI8658C_TEMP_INTERVAL_MS;
+    uint32_t lastTempMs = 0;
+    uint32_t temperatureReads = 0;
+    bool temperatureDue();
+    void setTemperature(int16_t raw);
+    
+    // FIFO state
+    bool fifoEnabled;
+    uint8_t fifoCtrl;
+    uint32_t fifoOverflows;
+    uint32_t lastFifoTimestampUs;
+    uint8_t fifoWatermark;
+    uint32_t samplePeriodUs = 4460;    // 224.2 Hz (250 Hz setting, 6DOF mode)
+    
+    // FIFO drain double buffer: one chunk transfers while the other decodes
+    static const size_t FIFO_CHUNK_BYTES = 120;
+    I2CTransaction fifoTxn[2];
+    uint8_t fifoBuf[2][FIFO_CHUNK_BYTES];
+    
+    // Range / ODR state
+    QMI8658C_AccelRange accelRange = QMI8658C_ACCEL_2G;
+    QMI8658C_GyroRange gyroRange = QMI8658C_GYRO_256DPS;
+    QMI8658C_ODR odr = QMI8658C_ODR_250HZ;
+    bool autoRange = false;
+    QMI8658C_AccelRange autoRangeBase = QMI8658C_ACCEL_8G;
+    uint32_t quietSamples = 0;
+    uint32_t rangeSwitches = 0;
     
-    // Calibration factors (can be adjusted)
+    // The first `frames` buffered FIFO frames were taken at `range`
+    // (oldest switch first). FIFO overflow shifts them by what it drops.
+    struct RangeMark {
+        uint16_t frames;
+        QMI8658C_AccelRange range;
+    };
+    RangeMark rangeMarks[QMI8658C_RANGE_MARKS];
+    uint8_t rangeMarkCount = 0;
+    void markRangeSwitch(QMI8658C_AccelRange previous);
+    
+    // Interrupt state
+    uint8_t ctrl1;
+    int8_t intPin;
+    QMI8658C_IntSource intSource;
+    TaskHandle_t notifyTask;
+    volatile uint32_t irqTimestampUs;
+    uint32_t irqLatencyUs;
+    
+    // Motion engine state
+    uint8_t ctrl8;
+    int8_t motionIntPin;
+    volatile uint32_t motionIrqTimestampUs;
+    
+    static void IRAM_ATTR handleInterrupt(void *arg);
+    static void IRAM_ATTR handleMotionInterrupt(void *arg);
+    
+    // Calibration factors, kept in step with the range settings
     float accelScale = 2.0 / 32768.0;  // ±2g range
-    float gyroScale = 250.0 / 32768.0; // ±250 dps range
+    float gyroScale = 256.0 / 32768.0; // ±256 dps range
+    
+    // Per-sample calibration transform: Q14 matrix, offsets in counts at
+    // the current ranges (recomputed on range changes)
+    IMUCalibration calibration;
+    IMUTempCompensation tempComp;
+    bool calEnabled = false;
+    int32_t calMatrix[3][3];
+    int32_t calAccelOffset[3];
+    int32_t calGyroOffset[3];
+    void updateCalibrationTransform();
+    template <typename T> void applyCalibration(T &s, int rangeShift = 0);
     
     uint8_t readRegister(uint8_t reg);
+    bool readRegisters(uint8_t reg, uint8_t *buf, size_t len);
+    bool submitFifoChunk(size_t chunk, size_t count);
     void writeRegister(uint8_t reg, uint8_t value);
     int16_t readInt16(uint8_t regLow);
+    bool sendCommand(uint8_t cmd);
+    bool sendConfigCommand(uint8_t cmd, const uint8_t params[8]);
+    void writeCtrl2();
+    void writeCtrl3();
+    void updateAutoRange(int peak, size_t samples);
 };
 
 #endif // QMI8658C_H
@@ -0,0 +1,479 @@
+/*
+ * Sensor Task
+ *
+ * Runs IMU acquisition and motion detection in a dedicated FreeRTOS task
+ * pinned to the core that does not run loop(). Samples and slap events
+ * are published through lock-free SPSC rings, so display, WiFi and web
+ * work in loop() can never stall sampling. The detection itself is
+ * DetectionPipeline, which the host replay tool runs unchanged.
+ *
+ * In on-chip mode the FIFO interrupt is off and the QMI8658C tap and
+ * any-motion engines detect slaps; the task sleeps until INT1 fires.
+ */
+
+#ifndef SENSORTASK_H
+#define SENSORTASK_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "QMI8658C.h"
+#include "MotionDetector.h"
+#include "DetectionPipeline.h"
+#include "WaveformCapture.h"
+#include "SpscRing.h"
+
+// loop() runs on ARDUINO_RUNNING_CORE (1); sampling gets the other core
+#define SENSOR_TASK_CORE     0
+#define SENSOR_TASK_PRIORITY 10
+#define SENSOR_TASK_STACK    4096
+
+// Task notification bit for configuration changes (IMU bits are 0x01/0x02)
+#define SENSOR_NOTIFY_CONFIG 0x80
+
+// Acquisition cadence statistics
+struct SensorStats {
+    uint32_t samples;         // samples acquired
+    uint32_t batches;         // FIFO drains
+    uint32_t droppedSamples;  // sample ring full
+    uint32_t droppedEvents;   // event ring full
+    uint32_t lastLatencyUs;   // interrupt to drain start
+    uint32_t maxLatencyUs;
+    uint32_t minIntervalUs;   // between consecutive drains
+    uint32_t maxIntervalUs;
+    uint32_t detectCycles;    // detector CPU cycles per sample, last batch
+    uint32_t maxDetectCycles;
+    uint32_t featureCycles;   // feature extraction CPU cycles, last event
+    uint32_t classifyCycles;  // classifier CPU cycles, last event
+};
+
+// Orientation snapshot, published once per FIFO drain
+struct SensorOrientation {
+    float q[4];               // w, x, y, z (sensor to world)
+    float linear[3];          // gravity-free acceleration, last sample (g)
+    float roll, pitch;        // degrees
+};
+
+class SensorTask {
+public:
+    typedef SpscRing<IMUSample, 256> SampleRing;
+    typedef SpscRing<SlapEvent, 32> EventRing;
+
+private:
+    QMI8658C *imu;
+    DetectionPipeline pipeline;
+    WaveformCapture *capture;
+    TaskHandle_t handle;
+    uint8_t intPin;
+    uint8_t motionPin;
+
+    SampleRing samples;
+    EventRing events;
+
+    std::atomic<float> threshold;
+    std::atomic<bool> detectionEnabled;
+
+    // Adaptive threshold: k * noise sigma, never below the fixed threshold
+    std::atomic<bool> adaptive;
+    std::atomic<float> noiseK;
+    std::atomic<float> noiseSigma;
+    std::atomic<float> activeThreshold;
+
+    // Sensor configuration requested by other tasks, applied by the
+    // sensor task between drains (-1 = nothing pending)
+    std::atomic<int> pendingAccelRange;
+    std::atomic<int> pendingODR;
+    std::atomic<int> pendingAutoRange;
+    std::atomic<int> pendingOnChip;
+
+    // Gravity removal: gyro-fused orientation (true) or the detector's
+    // high-pass alone (false)
+    std::atomic<bool> fusion;
+
+    // Sensor time up to which every slap event has been published
+    std::atomic<uint32_t> eventHorizon;
+
+    // Orientation snapshot for other tasks
+    portMUX_TYPE orientationMux;
+    SensorOrientation published;
+
+    // Calibration and temperature compensation handed over from other
+    // tasks
+    portMUX_TYPE calMux;
+    IMUCalibration pendingCal;
+    std::atomic<bool> calPending;
+    IMUTempCompensation pendingTempComp;
+    std::atomic<bool> tempCompPending;
+    std::atomic<int> pendingTempInterval;
+
+    // Sensor temperature, read by the driver every temperature interval
+    std::atomic<float> temperature;
+
+    // On-chip detection active: written by the sensor task, read by
+    // others for status and the event horizon
+    std::atomic<bool> onChip;
+
+    // Engine threshold in effect (sensor task only)
+    float engineThreshold;
+
+    SensorStats stats;
+    uint32_t lastDrainUs;
+
+    IMUSample batch[128];
+
+    static void taskEntry(void *param) {
+        static_cast<SensorTask *>(param)->run();
+    }
+
+    void run() {
+        // Timeout: a missed edge must not stall acquisition
+        const TickType_t timeout = pdMS_TO_TICKS(100);
+
+        for (;;) {
+            // On-chip mode sleeps until the sensor reports motion
+            bool engines = onChip.load(std::memory_order_relaxed);
+            uint32_t bits = imu->waitForEvents(engines ? portMAX_DELAY : timeout);
+            applyPendingConfig();
+
+            if (onChip.load(std::memory_order_relaxed)) {
+                if (bits & QMI8658C_NOTIFY_MOTION) {
+                    handleMotionInterrupt();
+                    temperature.store(imu->getTemperature(), std::memory_order_relaxed);
+                }
+                continue;
+            }
+
+            uint32_t now = micros();
+            size_t count = imu->readFifo(batch, sizeof(batch) / sizeof(batch[0]));
+            if (count == 0) continue;
+
+            recordCadence(now, count);
+            temperature.store(imu->getTemperature(), std::memory_order_relaxed);
+
+            for (size_t i = 0; i < count; i++) {
+                if (!samples.push(batch[i])) {
+                    stats.droppedSamples++;
+                }
+                if (capture) {
+                    capture->push(batch[i]);
+                }
+            }
+
+            pipeline.setGyroRange(imu->getGyroRange());
+            pipeline.setThreshold(threshold.load(std::memory_order_relaxed));
+            pipeline.setAdaptiveThreshold(adaptive.load(std::memory_order_relaxed),
+                                          noiseK.load(std::memory_order_relaxed));
+            pipeline.setFusion(fusion.load(std::memory_order_relaxed));
+
+            auto sink = [this](const SlapEvent &event) { publish(event); };
+            if (detectionEnabled.load(std::memory_order_relaxed)) {
+                pipeline.process(batch, count, sink);
+            } else {
+                pipeline.idle(batch, count, sink);
+            }
+
+            noiseSigma.store(pipeline.getNoiseSigma(), std::memory_order_relaxed);
+            activeThreshold.store(pipeline.getActiveThreshold(), std::memory_order_relaxed);
+            const PipelineStats &p = pipeline.getStats();
+            stats.detectCycles = p.detectCycles;
+            stats.maxDetectCycles = p.maxDetectCycles;
+            stats.featureCycles = p.featureCycles;
+            stats.classifyCycles = p.classifyCycles;
+
+            publishOrientation();
+            eventHorizon.store(pipeline.getHorizonUs(batch[count - 1].timestampUs),
+                               std::memory_order_release);
+        }
+    }
+
+    static uint32_t cycleCount() { return ESP.getCycleCount(); }
+
+    void publishOrientation() {
+        const OrientationFilter &orientation = pipeline.getOrientation();
+        SensorOrientation o;
+        memcpy(o.q, orientation.getQuaternion(), sizeof(o.q));
+        memcpy(o.linear, orientation.getLinear(), sizeof(o.linear));
+        o.roll = orientation.getRoll();
+        o.pitch = orientation.getPitch();
+        portENTER_CRITICAL(&orientationMux);
+        published = o;
+        portEXIT_CRITICAL(&orientationMux);
+    }
+
+    void publish(const SlapEvent &event) {
+        if (!events.push(event)) {
+            stats.droppedEvents++;
+        }
+        if (capture) {
+            capture->trigger(event, imu->getSamplePeriodUs(), imu->getGyroRange());
+        }
+    }
+
+    void handleMotionInterrupt() {
+        QMI8658C_MotionEvent motion;
+        if (!imu->readMotionEvent(motion)) return;
+        if (!detectionEnabled.load(std::memory_order_relaxed)) return;
+
+        // The engines report no magnitude, and one sample read after the
+        // interrupt is already past the impact: peak stays 0 (unknown)
+        SlapEvent event;
+        event.timestampUs = imu->getLastMotionInterruptUs();
+        event.peak = 0;
+        event.source = motion.tap ? SLAP_SOURCE_TAP : SLAP_SOURCE_ANY_MOTION;
+        event.durationUs = 0;
+        event.energy = 0;
+        event.jerk = 0;
+        event.direction = 0;
+        if (motion.tap) {
+            event.direction = (int8_t)(motion.tapAxis + 1);
+            if (motion.tapNegative) event.direction = -event.direction;
+        }
+        if (!events.push(event)) {
+            stats.droppedEvents++;
+        }
+    }
+
+    bool configureEngines(float g) {
+        // Tap windows in samples at the current ODR
+        float hz = imu->getSampleRateHz();
+        QMI8658C_TapConfig tap;
+        tap.peakWindow = (uint8_t)constrain(hz * 0.03f, 1.0f, 255.0f);     // 30 ms
+        tap.priority = 0;
+        tap.tapWindow = (uint16_t)(hz * 0.1f);                              // 100 ms
+        tap.doubleTapWindow = (uint16_t)(hz * 0.5f);                        // 500 ms
+        tap.alpha = 8;      // 0.0625
+        tap.gamma = 32;     // 0.25
+        tap.peakThresholdG = g;
+        tap.quietThresholdG = g * 0.3f;
+
+        engineThreshold = g;
+        return imu->configureTap(tap) &&
+               imu->configureAnyMotion(g, 2) &&
+               imu->enableMotionEngines(QMI8658C_ENGINE_TAP | QMI8658C_ENGINE_ANY_MOTION,
+                                        motionPin);
+    }
+
+    void applyPendingConfig() {
+        if (calPending) {
+            IMUCalibration cal;
+            portENTER_CRITICAL(&calMux);
+            cal = pendingCal;
+            calPending = false;
+            portEXIT_CRITICAL(&calMux);
+            imu->setCalibration(cal);
+        }
+        if (tempCompPending) {
+            IMUTempCompensation comp;
+            portENTER_CRITICAL(&calMux);
+            comp = pendingTempComp;
+            tempCompPending = false;
+            portEXIT_CRITICAL(&calMux);
+            imu->setTempCompensation(comp);
+        }
+
+        int tempInterval = pendingTempInterval.exchange(-1);
+        if (tempInterval >= 0) {
+            imu->setTemperatureInterval(tempInterval);
+        }
+
+        int mode = pendingOnChip.exchange(-1);
+        bool engines = onChip.load(std::memory_order_relaxed);
+        if (mode == 1 && !engines) {
+            imu->disableInterrupt();
+            engines = configureEngines(threshold.load());
+            if (!engines) {
+                Serial.println("SensorTask: Motion engine setup failed");
+                imu->disableMotionEngines();
+                imu->enableInterrupt(QMI8658C_INT_FIFO_WATERMARK, intPin);
+            }
+            onChip.store(engines, std::memory_order_release);
+        } else if (mode == 0 && engines) {
+            imu->disableMotionEngines();
+            imu->resetFifo();
+            imu->enableInterrupt(QMI8658C_INT_FIFO_WATERMARK, intPin);
+            engines = false;
+            onChip.store(false, std::memory_order_release);
+        }
+
+        // Engine thresholds follow the configured slap threshold
+        if (engines && threshold.load() != engineThreshold) {
+            configureEngines(threshold.load());
+        }
+
+        int range = pendingAccelRange.exchange(-1);
+        if (range >= 0) {
+            imu->setAccelRange((QMI8658C_AccelRange)range);
+        }
+
+        int autoRange = pendingAutoRange.exchange(-1);
+        if (autoRange >= 0) {
+            imu->setAutoRange(autoRange != 0);
+        }
+
+        int odr = pendingODR.exchange(-1);
+        if (odr >= 0) {
+            imu->setODR((QMI8658C_ODR)odr);
+            pipeline.setSamplePeriodUs(imu->getSamplePeriodUs());
+            if (capture) {
+                capture->setSampleRate(imu->getSampleRateHz());
+            }
+        }
+    }
+
+    void recordCadence(uint32_t now, size_t count) {
+        stats.samples += count;
+        stats.batches++;
+
+        stats.lastLatencyUs = imu->getIrqLatencyUs();
+        if (stats.lastLatencyUs > stats.maxLatencyUs) {
+            stats.maxLatencyUs = stats.lastLatencyUs;
+        }
+
+        if (lastDrainUs != 0) {
+            uint32_t interval = now - lastDrainUs;
+            if (interval < stats.minIntervalUs) stats.minIntervalUs = interval;
+            if (interval > stats.maxIntervalUs) stats.maxIntervalUs = interval;
+        }
+        lastDrainUs = now;
+    }
+
+public:
+    SensorTask(QMI8658C *sensor, uint8_t dataIntPin, uint8_t motionIntPin)
+        : imu(sensor), capture(nullptr), handle(nullptr), intPin(dataIntPin), motionPin(motionIntPin),
+          threshold(1.0f), detectionEnabled(false),
+          adaptive(false), noiseK(10.0f), noiseSigma(0), activeThreshold(1.0f),
+          pendingAccelRange(-1), pendingODR(-1), pendingAutoRange(-1),
+          pendingOnChip(-1), fusion(true), eventHorizon(0), calPending(false), tempCompPending(false),
+          pendingTempInterval(-1), temperature(0), onChip(false), engineThreshold(0),
+          lastDrainUs(0) {
+        calMux = portMUX_INITIALIZER_UNLOCKED;
+        orientationMux = portMUX_INITIALIZER_UNLOCKED;
+        memset(&published, 0, sizeof(published));
+        published.q[0] = 1.0f;
+        resetStats();
+    }
+
+    // Start acquisition; the IMU must already be initialized with its FIFO enabled
+    bool begin() {
+        pipeline.setSamplePeriodUs(imu->getSamplePeriodUs());
+        pipeline.setCycleCounter(cycleCount);
+        pipeline.begin();
+        if (capture) {
+            capture->setSampleRate(imu->getSampleRateHz());
+        }
+
+        if (xTaskCreatePinnedToCore(taskEntry, "sensor", SENSOR_TASK_STACK, this,
+                                    SENSOR_TASK_PRIORITY, &handle,
+                                    SENSOR_TASK_CORE) != pdPASS) {
+            Serial.println("SensorTask: Failed to create task");
+            return false;
+        }
+
+        imu->setNotifyTask(handle);
+        return imu->enableInterrupt(QMI8658C_INT_FIFO_WATERMARK, intPin);
+    }
+
+    bool isRunning() const { return handle != nullptr; }
+
+    // Feed samples and slap events into a waveform capture; call before begin()
+    void setWaveformCapture(WaveformCapture *waveforms) { capture = waveforms; }
+
+    // Consumer side (single consumer each)
+    bool popSample(IMUSample &sample) { return samples.pop(sample); }
+    bool popEvent(SlapEvent &event) { return events.pop(event); }
+
+    // Settings, safe to call from any task
+    void setThreshold(float g) {
+        if (threshold.exchange(g) != g) notifyConfig();
+    }
+    void setDetectionEnabled(bool enabled) { detectionEnabled.store(enabled, std::memory_order_relaxed); }
+
+    // Adaptive mode: trigger at k * noise sigma, the fixed threshold acts
+    // as the floor (FIFO stream only; the on-chip engines use the fixed one)
+    void setAdaptiveThreshold(bool enabled, float k) {
+        adaptive.store(enabled, std::memory_order_relaxed);
+        noiseK.store(k, std::memory_order_relaxed);
+    }
+    bool isAdaptiveThreshold() const { return adaptive.load(std::memory_order_relaxed); }
+
+    // Live noise floor estimate (g, 1 sigma) and the threshold in use (g)
+    float getNoiseSigma() const { return noiseSigma.load(std::memory_order_relaxed); }
+    float getActiveThreshold() const { return activeThreshold.load(std::memory_order_relaxed); }
+
+    // Remove gravity with the gyro-fused orientation (default) or with the
+    // detector's high-pass alone
+    void setFusion(bool enabled) { fusion.store(enabled, std::memory_order_relaxed); }
+    bool isFusion() const { return fusion.load(std::memory_order_relaxed); }
+
+    // micros() time before which no further slap event will be published.
+    // Read it before draining popEvent() so no event can slip in between.
+    uint32_t getEventHorizonUs() const {
+        return onChip.load(std::memory_order_acquire) ? micros()
+                                                      : eventHorizon.load(std::memory_order_acquire);
+    }
+
+    // Latest orientation, updated after every FIFO drain
+    SensorOrientation getOrientation() {
+        portENTER_CRITICAL(&orientationMux);
+        SensorOrientation o = published;
+        portEXIT_CRITICAL(&orientationMux);
+        return o;
+    }
+
+    // IMU range / rate changes, applied by the sensor task at its next wake
+    void setAccelRange(QMI8658C_AccelRange range) { pendingAccelRange.store(range); notifyConfig(); }
+    void setODR(QMI8658C_ODR rate) { pendingODR.store(rate); notifyConfig(); }
+    void setAutoRange(bool enabled) { pendingAutoRange.store(enabled ? 1 : 0); notifyConfig(); }
+
+    // Detect slaps with the sensor's tap / any-motion engines instead of
+    // the FIFO stream (no samples are published in this mode)
+    void setOnChipDetection(bool enabled) { pendingOnChip.store(enabled ? 1 : 0); notifyConfig(); }
+    bool isOnChipDetection() const { return onChip.load(std::memory_order_acquire); }
+
+    // Calibration, applied by the sensor task at its next wake
+    void setCalibration(const IMUCalibration &cal) {
+        portENTER_CRITICAL(&calMux);
+        pendingCal = cal;
+        calPending = true;
+        portEXIT_CRITICAL(&calMux);
+        notifyConfig();
+    }
+    const IMUCalibration &getCalibration() const { return imu->getCalibration(); }
+
+    // Temperature compensation of the accel bias, applied likewise
+    void setTempCompensation(const IMUTempCompensation &comp) {
+        portENTER_CRITICAL(&calMux);
+        pendingTempComp = comp;
+        tempCompPending = true;
+        portEXIT_CRITICAL(&calMux);
+        notifyConfig();
+    }
+    const IMUTempCompensation &getTempCompensation() const { return imu->getTempCompensation(); }
+
+    // Temperature read interval in ms (0 = every polled sample / drain)
+    void setTemperatureInterval(uint32_t ms) { pendingTempInterval.store(ms); notifyConfig(); }
+    uint32_t getTemperatureInterval() const { return imu->getTemperatureInterval(); }
+    float getTemperature() const { return temperature.load(std::memory_order_relaxed); }
+
+    QMI8658C_AccelRange getAccelRange() const { return imu->getAccelRange(); }
+    QMI8658C_GyroRange getGyroRange() const { return imu->getGyroRange(); }
+    QMI8658C_ODR getODR() const { return imu->getODR(); }
+    float getSampleRateHz() const { return imu->getSampleRateHz(); }
+    bool isAutoRange() const { return imu->isAutoRange(); }
+
+    void notifyConfig() {
+        if (handle != nullptr) {
+            xTaskNotify(handle, SENSOR_NOTIFY_CONFIG, eSetBits);
+        }
+    }
+
+    // Statistics are written by the sensor task; readers get a snapshot
+    SensorStats getStats() const { return stats; }
+
+    void resetStats() {
+        memset(&stats, 0, sizeof(stats));
+        pipeline.resetStats();
+        stats.minIntervalUs = UINT32_MAX;
+    }
+};
+
+#endif // SENSORTASK_H
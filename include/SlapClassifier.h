@@ -0,0 +1,185 @@
+/*
+ * Slap / Bump / Drop Classifier
+ *
+ * Tiny int8-quantized MLP run once per detected impact:
+ *   input   64 samples around the peak (48 before, 16 after), pooled in
+ *           pairs into 32 steps of three channels:
+ *             mean |a| - 1 g      (free fall reads -1 before a drop)
+ *             peak |a| - 1 g      (impact shape)
+ *             mean |gyro|         (tumbling / rotation)
+ *           divided by a fixed full scale per channel, quantized to int8
+ *   hidden  96 -> 16, ReLU, int8 activations
+ *   output  16 -> 3 logits (slap, bump, drop), argmax + softmax confidence
+ *
+ * Integer-only inner loops: int8 x int8 -> int32 accumulators, requantized
+ * with a fixed-point multiplier and shift per output row. All activations
+ * live in a fixed arena inside the object (no heap); the weights are
+ * constexpr tables in SlapModel.h (generated by tools/classifier).
+ *
+ * Magnitudes are passed squared, so the sensor task only multiplies per
+ * sample. No Arduino dependencies: the host tools run this same code on
+ * recorded captures.
+ */
+
+#ifndef SLAPCLASSIFIER_H
+#define SLAPCLASSIFIER_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "SlapModel.h"
+
+#define CLASSIFIER_PRE      48      // samples before the peak
+#define CLASSIFIER_POST     16      // samples from the peak on
+#define CLASSIFIER_WINDOW   (CLASSIFIER_PRE + CLASSIFIER_POST)
+#define CLASSIFIER_POOL     2
+#define CLASSIFIER_STEPS    (CLASSIFIER_WINDOW / CLASSIFIER_POOL)
+#define CLASSIFIER_CHANNELS 3
+#define CLASSIFIER_INPUTS   (CLASSIFIER_CHANNELS * CLASSIFIER_STEPS)
+#define CLASSIFIER_HIDDEN   16
+#define CLASSIFIER_CLASSES  3
+
+// Input full scale per channel (maps to +-127)
+#define CLASSIFIER_ACCEL_MEAN_FS  4.0f      // g
+#define CLASSIFIER_ACCEL_PEAK_FS  16.0f     // g
+#define CLASSIFIER_GYRO_FS        1000.0f   // dps
+
+enum SlapClass : uint8_t {
+    SLAP_CLASS_UNKNOWN = 0,     // not classified (on-chip events, too little history)
+    SLAP_CLASS_SLAP,
+    SLAP_CLASS_BUMP,            // knock, shove, furniture moved
+    SLAP_CLASS_DROP             // free fall followed by impact
+};
+
+struct SlapClassification {
+    SlapClass label;
+    uint8_t confidence;         // percent, softmax of the logits
+};
+
+class SlapClassifier {
+public:
+    // Activation arena layout (bytes)
+    static constexpr size_t INPUT_OFFSET = 0;
+    static constexpr size_t HIDDEN_OFFSET = INPUT_OFFSET + CLASSIFIER_INPUTS;
+    static constexpr size_t LOGITS_OFFSET = (HIDDEN_OFFSET + CLASSIFIER_HIDDEN + 3) & ~(size_t)3;
+    static constexpr size_t ARENA_BYTES = LOGITS_OFFSET + CLASSIFIER_CLASSES * sizeof(int32_t);
+
+    // Constant tables in flash
+    static constexpr size_t MODEL_BYTES =
+        sizeof(SLAP_MODEL_W1) + sizeof(SLAP_MODEL_B1) + sizeof(SLAP_MODEL_M1) +
+        sizeof(SLAP_MODEL_S1) + sizeof(SLAP_MODEL_W2) + sizeof(SLAP_MODEL_B2) +
+        sizeof(SLAP_MODEL_OUT_SCALE);
+
+private:
+    alignas(4) uint8_t arena[ARENA_BYTES];
+
+    int8_t *input() { return reinterpret_cast<int8_t *>(arena + INPUT_OFFSET); }
+    int8_t *hidden() { return reinterpret_cast<int8_t *>(arena + HIDDEN_OFFSET); }
+    int32_t *logits() { return reinterpret_cast<int32_t *>(arena + LOGITS_OFFSET); }
+
+    static int8_t quantize(float x) {
+        float q = x * 127.0f;
+        if (q > 127.0f) return 127;
+        if (q < -127.0f) return -127;
+        return (int8_t)lrintf(q);
+    }
+
+    static int32_t dot(const int8_t *w, const int8_t *x, int n) {
+        int32_t acc = 0;
+        for (int i = 0; i < n; i++) {
+            acc += (int32_t)w[i] * x[i];
+        }
+        return acc;
+    }
+
+public:
+    SlapClassifier() {
+        for (size_t i = 0; i < ARENA_BYTES; i++) arena[i] = 0;
+    }
+
+    // acc * mult * 2^-shift, rounded to nearest (mult is Q31, shift >= 31)
+    static int32_t requantize(int32_t acc, int32_t mult, int shift) {
+        int64_t v = (int64_t)acc * mult;
+        return (int32_t)((v + ((int64_t)1 << (shift - 1))) >> shift);
+    }
+
+    // Network input in full-scale units (int8 / 127) from CLASSIFIER_WINDOW
+    // squared magnitudes (accel in g^2, gyro in dps^2), oldest first, peak
+    // at CLASSIFIER_PRE
+    static void features(const float *accelMagSq, const float *gyroMagSq, float *out) {
+        for (int s = 0; s < CLASSIFIER_STEPS; s++) {
+            float accelSum = 0;
+            float accelMax = 0;
+            float gyroSum = 0;
+            for (int k = 0; k < CLASSIFIER_POOL; k++) {
+                int i = s * CLASSIFIER_POOL + k;
+                accelSum += accelMagSq[i];
+                gyroSum += gyroMagSq[i];
+                if (accelMagSq[i] > accelMax) accelMax = accelMagSq[i];
+            }
+            out[s] = (sqrtf(accelSum / CLASSIFIER_POOL) - 1.0f) / CLASSIFIER_ACCEL_MEAN_FS;
+            out[CLASSIFIER_STEPS + s] = (sqrtf(accelMax) - 1.0f) / CLASSIFIER_ACCEL_PEAK_FS;
+            out[2 * CLASSIFIER_STEPS + s] = sqrtf(gyroSum / CLASSIFIER_POOL) / CLASSIFIER_GYRO_FS;
+        }
+    }
+
+    // Fill the int8 input (same arguments as features())
+    void setInput(const float *accelMagSq, const float *gyroMagSq) {
+        float x[CLASSIFIER_INPUTS];
+        features(accelMagSq, gyroMagSq, x);
+        int8_t *in = input();
+        for (int i = 0; i < CLASSIFIER_INPUTS; i++) {
+            in[i] = quantize(x[i]);
+        }
+    }
+
+    const int8_t *getInput() { return input(); }
+
+    // Run the network on the current input
+    SlapClassification invoke() {
+        const int8_t *in = input();
+        int8_t *h = hidden();
+        for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+            int32_t acc = SLAP_MODEL_B1[j] + dot(SLAP_MODEL_W1[j], in, CLASSIFIER_INPUTS);
+            int32_t v = requantize(acc, SLAP_MODEL_M1[j], SLAP_MODEL_S1[j]);
+            h[j] = (int8_t)(v < 0 ? 0 : (v > 127 ? 127 : v));
+        }
+
+        int32_t *out = logits();
+        int best = 0;
+        for (int k = 0; k < CLASSIFIER_CLASSES; k++) {
+            out[k] = SLAP_MODEL_B2[k] + dot(SLAP_MODEL_W2[k], h, CLASSIFIER_HIDDEN);
+            if (getLogit(k) > getLogit(best)) best = k;
+        }
+
+        // Softmax probability of the winner
+        float sum = 0;
+        for (int k = 0; k < CLASSIFIER_CLASSES; k++) {
+            sum += expf(getLogit(k) - getLogit(best));
+        }
+
+        SlapClassification result;
+        result.label = (SlapClass)(SLAP_CLASS_SLAP + best);
+        result.confidence = (uint8_t)lrintf(100.0f / sum);
+        return result;
+    }
+
+    SlapClassification classify(const float *accelMagSq, const float *gyroMagSq) {
+        setInput(accelMagSq, gyroMagSq);
+        return invoke();
+    }
+
+    // Dequantized logit of the last invoke()
+    float getLogit(int k) { return logits()[k] * SLAP_MODEL_OUT_SCALE[k]; }
+
+    static const char *labelName(SlapClass label) {
+        switch (label) {
+        case SLAP_CLASS_SLAP: return "slap";
+        case SLAP_CLASS_BUMP: return "bump";
+        case SLAP_CLASS_DROP: return "drop";
+        default: return "unknown";
+        }
+    }
+};
+
+#endif // SLAPCLASSIFIER_H
@@ -0,0 +1,235 @@
+/*
+ * Streaming Slap Detector
+ *
+ * Runs on every IMU sample at the full output data rate:
+ *   1. 2nd-order Butterworth high-pass (biquad) per axis removes gravity
+ *      and slow tilt (fed gyro-fused linear acceleration instead, only
+ *      the residual bias)
+ *   2. jerk = rate of change of the high-passed vector
+ *   3. an impact starts when |a| crosses the threshold with enough jerk,
+ *      and ends when |a| falls below the release level (or after
+ *      maxDurationUs)
+ *   4. one event per impact carries the peak, duration and energy; a
+ *      refractory window after each event swallows ringing
+ *
+ * Comparisons run on squared magnitudes (no sqrt per sample). Works on
+ * IMUSample counts at any range, so auto-range switches are transparent.
+ *
+ * Took over from FixedMotionDetector in the sensor task: the float biquad,
+ * jerk gate and per-impact events have no integer counterpart there, and
+ * fused input arrives in g anyway. test/detector_benchmark.cpp reports
+ * what that costs per sample against the integer path.
+ */
+
+#ifndef SLAPDETECTOR_H
+#define SLAPDETECTOR_H
+
+#include <math.h>
+#include "IMUTypes.h"
+#include "MotionDetector.h"
+
+struct SlapDetectorConfig {
+    float highPassHz = 2.0f;        // gravity / tilt rejection corner
+    float threshold = 1.0f;         // g, impact start
+    float releaseRatio = 0.5f;      // impact ends below threshold * ratio
+    float jerkThreshold = 50.0f;    // g/s at onset, 0 = no jerk gate
+    uint32_t refractoryUs = 150000; // quiet time after each event
+    uint32_t maxDurationUs = 500000;
+};
+
+class SlapDetector {
+private:
+    // Biquad in transposed direct form II, one state pair per axis
+    struct Biquad {
+        float b0, b1, b2, a1, a2;
+    };
+
+    SlapDetectorConfig config;
+    Biquad hp;
+    float state[3][2];
+    float prev[3];
+    bool primed;
+
+    float sampleRateHz;
+    float dt;
+    float thresholdSq;
+    float releaseSq;
+    float jerkThresholdSq;      // in (g per sample)^2
+
+    // Current impact
+    bool active;
+    uint32_t startUs;
+    uint32_t peakUs;
+    float peakSq;
+    float peakJerkSq;
+    int8_t peakDirection;
+    float energy;
+    uint32_t lastEventUs;
+    bool hasEvent;
+
+    float motionSq;
+    float filtered[3];
+
+    void design() {
+        // RBJ cookbook high-pass, Q = 1/sqrt(2)
+        float fc = config.highPassHz;
+        if (fc > sampleRateHz * 0.45f) fc = sampleRateHz * 0.45f;
+        float w0 = 2.0f * (float)M_PI * fc / sampleRateHz;
+        float cw = cosf(w0);
+        float alpha = sinf(w0) / (2.0f * 0.70710678f);
+        float a0 = 1.0f + alpha;
+
+        hp.b0 = (1.0f + cw) * 0.5f / a0;
+        hp.b1 = -(1.0f + cw) / a0;
+        hp.b2 = hp.b0;
+        hp.a1 = -2.0f * cw / a0;
+        hp.a2 = (1.0f - alpha) / a0;
+
+        dt = 1.0f / sampleRateHz;
+        float jerkPerSample = config.jerkThreshold * dt;
+        jerkThresholdSq = jerkPerSample * jerkPerSample;
+        thresholdSq = config.threshold * config.threshold;
+        float release = config.threshold * config.releaseRatio;
+        releaseSq = release * release;
+        primed = false;
+    }
+
+    // Start the filters in steady state for a constant input x (output 0)
+    void prime(const float *x) {
+        for (int i = 0; i < 3; i++) {
+            state[i][0] = (hp.b1 + hp.b2) * x[i];
+            state[i][1] = hp.b2 * x[i];
+            prev[i] = 0;
+        }
+        primed = true;
+    }
+
+    static int8_t dominantAxis(const float *y) {
+        int axis = 0;
+        for (int i = 1; i < 3; i++) {
+            if (fabsf(y[i]) > fabsf(y[axis])) axis = i;
+        }
+        return y[axis] < 0 ? -(axis + 1) : axis + 1;
+    }
+
+    void emit(SlapEvent &event, uint32_t endUs) {
+        event.timestampUs = peakUs;
+        event.peak = sqrtf(peakSq);
+        event.source = SLAP_SOURCE_HOST;
+        event.durationUs = endUs - startUs;
+        event.energy = energy;
+        event.jerk = sqrtf(peakJerkSq) * sampleRateHz;
+        event.direction = peakDirection;
+        active = false;
+        lastEventUs = endUs;
+        hasEvent = true;
+    }
+
+public:
+    SlapDetector()
+        : primed(false), sampleRateHz(224.2f), active(false), startUs(0),
+          peakUs(0), peakSq(0), peakJerkSq(0), peakDirection(0), energy(0), lastEventUs(0),
+          hasEvent(false), motionSq(0), filtered{0, 0, 0} {
+        design();
+    }
+
+    void setConfig(const SlapDetectorConfig &cfg) {
+        config = cfg;
+        design();
+    }
+    const SlapDetectorConfig &getConfig() const { return config; }
+
+    void setSampleRate(float hz) {
+        sampleRateHz = hz;
+        design();
+    }
+
+    void setThreshold(float g) {
+        if (g == config.threshold) return;
+        config.threshold = g;
+        thresholdSq = g * g;
+        float release = g * config.releaseRatio;
+        releaseSq = release * release;
+    }
+    float getThreshold() const { return config.threshold; }
+
+    // Linear acceleration magnitude of the last sample, in g
+    float getMotion() const { return sqrtf(motionSq); }
+
+    // Inside an impact (between onset and release)
+    bool isActive() const { return active; }
+
+    // Within the quiet time after the last event
+    bool inRefractory(uint32_t now) const {
+        return hasEvent && now - lastEventUs < config.refractoryUs;
+    }
+    uint32_t getImpactStartUs() const { return startUs; }
+
+    // High-passed acceleration of the last sample per axis, in g
+    const float *getFiltered() const { return filtered; }
+
+    void reset() {
+        primed = false;
+        active = false;
+        hasEvent = false;
+    }
+
+    // Process one sample. Returns true and fills event when an impact has
+    // ended (the event describes the whole impact).
+    bool update(const IMUSample &sample, SlapEvent &event) {
+        float scale = imuAccelScale(sample.accelRange);
+        float x[3] = {sample.accelX * scale, sample.accelY * scale, sample.accelZ * scale};
+        return update(x, sample.timestampUs, event);
+    }
+
+    // Same on an acceleration vector in g, e.g. the gravity-free output of
+    // an OrientationFilter (the high-pass then only removes residual bias)
+    bool update(const float *x, uint32_t now, SlapEvent &event) {
+        if (!primed) prime(x);
+
+        // High-pass each axis; jerk from the change of the filtered vector
+        float *y = filtered;
+        float jerkSq = 0;
+        for (int i = 0; i < 3; i++) {
+            y[i] = hp.b0 * x[i] + state[i][0];
+            state[i][0] = hp.b1 * x[i] - hp.a1 * y[i] + state[i][1];
+            state[i][1] = hp.b2 * x[i] - hp.a2 * y[i];
+
+            float d = y[i] - prev[i];
+            jerkSq += d * d;
+            prev[i] = y[i];
+        }
+        motionSq = y[0] * y[0] + y[1] * y[1] + y[2] * y[2];
+
+        if (!active) {
+            if (inRefractory(now)) return false;
+            if (motionSq <= thresholdSq) return false;
+            if (jerkThresholdSq > 0 && jerkSq < jerkThresholdSq) return false;
+
+            active = true;
+            startUs = now;
+            peakUs = now;
+            peakSq = motionSq;
+            peakJerkSq = jerkSq;
+            peakDirection = dominantAxis(y);
+            energy = motionSq * dt;
+            return false;
+        }
+
+        energy += motionSq * dt;
+        if (motionSq > peakSq) {
+            peakSq = motionSq;
+            peakUs = now;
+            peakDirection = dominantAxis(y);
+        }
+        if (jerkSq > peakJerkSq) peakJerkSq = jerkSq;
+
+        if (motionSq < releaseSq || now - startUs >= config.maxDurationUs) {
+            emit(event, now);
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif // SLAPDETECTOR_H
@@ -0,0 +1,179 @@
+/*
+ * Slap Classifier Weights
+ *
+ * Generated by tools/classifier/train_classifier.cpp, do not edit.
+ * Trained on 4000 synthetic windows per class and 0 labeled captures;
+ * float accuracy on held-out synthetic windows 100.0%.
+ */
+
+#ifndef SLAPMODEL_H
+#define SLAPMODEL_H
+
+#include <stdint.h>
+
+// Layer 1: int8 weights per hidden unit, int32 bias at input x weight
+// scale, Q31 multiplier and shift to the hidden activation scale
+static constexpr int8_t SLAP_MODEL_W1[16][96] = {
+    {
+           5,  -6,  -5,  -6,  14,  11,   5, -20,   5,   6, -34, -16, -19,   3, -39, -13,
+          -6,   2,   7,  21,  34,  35, -22,   5, -15,  -6,   1, -16, -25, -19,  -6, -17,
+         -35,   5, -30,  -1, -48, -14,  29, -22,  -8, -16, -13, -15, -14,   2, -15, -21,
+          -8,   7,  15,  20,  16, -44, -67,  43,  58,  52,  38,  22,  -2,  -3, -19, -55,
+         -97,-105,-109,-101,-113,-103, -72,-106,-124,-111,-125,-121,-114,-116,-127,-109,
+         -96, -81, -67, -60, -55, -47, -46, -42,  41,  40,  24,   8,   5, -38, -88, -98,
+    },
+    {
+           6,  -7,  -8,  -8,  16,  11,  -4, -18,   9,  12, -40, -15, -23,   2, -38, -15,
+          -8,   9,   0,  12,  25,  29, -24,   5, -13,  -6,  -7, -14, -29, -18,  -5, -25,
+         -32,   2, -28,  -1, -51,  -6,  27, -23, -10,  -4,  -6, -11, -12,   7,  -9, -10,
+           1,   2,  14,  18,  19, -48, -72,  50,  66,  53,  36,  31, -10, -19, -23, -75,
+         -89, -95,-107, -92,-104, -96, -53,-100,-112,-104,-121,-106, -97,-109,-127,-107,
+         -81, -70, -52, -60, -54, -49, -40, -43,  46,  36,  23,   3,   2, -44, -95,-105,
+    },
+    {
+          -3, -16, -28, -24,  16,  23,   0, -26,  10,   8, -60, -41, -40,  12, -54, -31,
+         -16, -16, -16,   0,  21,  30, -26,  24, -44, -16, -14, -13, -63, -29, -28, -31,
+         -47,  22, -42,   3, -79,  -1,  63, -35,  -3,  12,  -1,  -9,  -3,  10, -15, -17,
+          -3,   3,   7,   4,  17, -66, -94,  86,  68,  85,  45,  46,  -5, -19, -33,-120,
+        -122,-126,-127, -93, -95, -81, -17, -75, -93, -87, -91, -77, -76, -79,-104, -62,
+         -32, -32, -10, -25, -25, -21, -35, -27,  36,  27,   0,  -8,  -1, -49,-108, -97,
+    },
+    {
+          13,  28,  30,  30,  18,  -1,  16,  38,   9,  12,  67,  34,  31,  12,  65,  45,
+          35,  29,  54,  65,  17, -13,  44,   6,  27,   3,   9,  34,  45,  30,  17,  27,
+          49,  14,  58,   5,  88,  24, -19,  40,  27,  33,  21,  22,  34,  13,  45,  47,
+          19,  31,  26,  74,  47, 107, 108, -37, -88, -60, -36, -21,  20,  25,  42,  95,
+          30,  64,  38,  46,  39,  23,  17,  35,  73,  42,  48,  48,  50,  36,  56,  60,
+          22,   2,   1, -11, -25, -38, -36, -42, -70, -73, -51, -28, -30,  37, 116, 127,
+    },
+    {
+           3,  -8,  -4,  -8,  14,  10,   2, -19,   8,   7, -41, -18, -26,  14, -42, -17,
+          -8,   0,  -2,  18,  39,  37, -26,  13, -17,  -8,  -5, -10, -33, -30,  -3, -25,
+         -33,  -4, -22,  -1, -56, -11,  32, -25, -17,  -6,  -1, -11, -17,   4, -15, -20,
+           0,   6,  18,  24,  10, -43, -72,  47,  63,  47,  37,  34,  -2, -18, -23, -72,
+         -97,-112,-110,-103,-112,-101, -60,-111,-123,-113,-127,-111, -98,-104,-114, -94,
+         -76, -63, -52, -54, -47, -41, -31, -39,  38,  34,  22,  -4,  -2, -46, -98, -97,
+    },
+    {
+          10,  27,  11,  15, -10, -20,  -4,  18, -10, -23,  39,   8,  27, -36,  63,  17,
+          16,  22,  36,  63,  21,   2,  57,  13,  49,   7,   1,  19,  51,  54,  24,  30,
+          41,  11,  45, -32,  75, -32, -58, -10, -20, -13, -22, -24, -23, -29,  -9, -25,
+         -30, -27, -19,  27,   8, 116, 108, -40, -69, -53, -44, -25,   6,  37,  40, 127,
+          30,  58,  24,  38,  18,  20,  -4,   1,  51,   9,  23,  22,  29,  10,  23,  33,
+          -8, -10, -33, -32, -29, -33, -34, -30, -27, -23, -14,  -3,  -5,  30,  81,  88,
+    },
+    {
+          -3,   4,  -6, -11,   2, -17,  -6,  10,  16, -13,  12,   5,  19,  -2,  34,  -1,
+          -4,  15,  19,  -5,  20,   8,  32,  12,  16,  18,  -3, -40, -99,-127, -94, -15,
+           3,  -5,  11,  11,  39,   1, -15,  17,   2,  -6,  -1,   9,  12,  -6,  11,  17,
+          15,  10,   2,   5,  14,  54,  44,  -9, -30, -12,  -8, -38, -93, -99, -68,  10,
+           9,  32,  -5,  20,   2,  -2,   2,   5,  17,  14,   6,  24,  23,   3,  24,  20,
+          -2,  -3, -13,  -8,  -8, -14, -15, -15, -14,  -6,  -2,   6,  10,  11,  22,  23,
+    },
+    {
+           3,  -6,   0,  -1,  15,  12,  -1, -19,   3,   7, -36,  -8, -24,   6, -37, -21,
+           0,   4,   8,  18,  37,  30, -31,   8, -13,  -7,   0,  -8, -33, -26,  -7, -14,
+         -39,   2, -45,  -3, -58,  -2,  27, -24, -21,   0,  -7, -11, -19,   5, -14, -21,
+         -13,   6,  15,  15,  13, -54, -83,  49,  63,  53,  44,  31,  -3, -18, -18, -74,
+         -90,-105,-110, -93,-103, -99, -61,-105,-117,-117,-119,-112,-100,-121,-127,-110,
+         -93, -78, -57, -68, -55, -46, -49, -49,  41,  48,  26,   8,   9, -32, -97,-112,
+    },
+    {
+         -82, -86,-103,-104, -89,-120,-100,-119,-127, -89,-100, -97, -51,-109, -65, -85,
+        -112,-110, -54, -86, -50, -39,  42,   7,  32,  54,  33,  26, -20,  11,  38,  -8,
+         -30, -58, -46, -63,   9, -52, -71, -64, -57, -61, -69, -73, -66, -77, -51, -55,
+         -53, -66, -80, -69, -64, -27,  61,  -6,  14,  27,  17,  -6, -37,  -7,  45,  29,
+          34,  34,  43,  56,  43,  48,  22,  33,  61,  45,  60,  53,  47,  39,  64,  58,
+          40,  26,  64,  62,  56,  61,  57,  48,  -2,  -3,  11,  15,  27,  27,  25,  16,
+    },
+    {
+          14,  30,  40,  33,  10,   9,  21,  42,  14,  12,  84,  48,  50,   8,  80,  45,
+          42,  24,  53,  65,  13, -11,  49,  16,  46,   8,  -2,  28,  53,  51,  15,  30,
+          61,  10,  67,   9, 105,  22, -25,  33,  26,  18,  20,  36,  26,  16,  36,  24,
+          12,  29,  12,  62,  35, 127, 118, -48, -91, -71, -57, -21,  12,  38,  38, 111,
+          31,  69,  45,  44,  36,  29,  18,  40,  67,  50,  57,  53,  59,  42,  76,  55,
+          17,  -4, -23, -21, -31, -39, -50, -44, -48, -70, -41, -17, -22,  36, 113, 127,
+    },
+    {
+         -98, -90,-116, -97,-101,-127,-114,-118,-125,-103, -91,-101, -73,-115, -48, -95,
+         -74,-104, -51, -55, -30,  21, 104,  31,  26,  50,  48,  64,  27,  -9, -81, -85,
+         -38, -50, -51, -61,   3, -61, -70, -64, -64, -61, -73, -64, -68, -74, -57, -60,
+         -56, -44, -63, -60, -31,  46, 109, -10,  -9,  -2,  13,   0,   6, -34, -60, -44,
+          38,  52,  35,  46,  22,  18,   1,  34,  52,  23,  34,  38,  36,  33,  45,  45,
+          -4,   9,  29,  27,  44,  42,  39,  33,  -6, -13,   3,  28,   6,  28,  31,  47,
+    },
+    {
+         -27, -48, -34, -35,  36,   6,  65,  -9,  54,   8,   8,  -4,  16, -50,  27,  19,
+          -9,   4,   4,  -6,  28, -63, -40,   7, -10,   1,  36, -22,  37, -16, -35,  25,
+         -21, -78,  -1,-109, -55,  29, -58,  65,   7,  36,  47, -16,  68,  43, -17,  14,
+         -10,   8,   3, -32,   4, -20,  46,  16, -61,  17,-127,  17, -14, -18,  12,  22,
+         -92, -17,  -6, -24,   1,  -3,   1,  10, -20, -65,   4, -12, -52, -24,   9,  35,
+         -82, -10, -21,  82, -43, -31, -43, -42,  47, -51, -44, -16, -67, -14, 117, -63,
+    },
+    {
+         -12, -10, -17, -12,   7, -16,  -7, -22,   3,   9, -38, -26, -15, -11, -46, -35,
+         -36,  -6, -48, -41,  -2,  55,  56,-114,   4,  -8,  25, -23,  -9, -23,  29,  -1,
+         -23,   6, -27,   6, -61,  -8,  25, -20,  -3,  -3, -15, -13, -12,   1, -20, -20,
+         -13, -16, -13, -38,   5, -39,  24,-127,  72,  49,  64,  12,  16, -39,   0, -52,
+         -13, -50, -23, -34, -29, -21, -16, -21, -54, -27, -32, -36, -31, -13, -31, -24,
+           8,  19,  24,  36,  30,  41,  36,  47,  45,  42,  36,  13,  34,  -2, -62, -62,
+    },
+    {
+           3,  15, -15,   1,  11,  -3,   3, -21,  26,  40, -42, -30, -24,   3, -57, -48,
+         -21,  26,   4,  30, -29,  31,  85,-102,  40,  18, -92,  36,  -6, -25,  -3, -26,
+         -35,  31, -13,  12, -79,  -2,  65, -12,   8,  14,   4,   0,   6,  13,  -1,  -1,
+          26,  30,  33,  32,  26, -60,  53,-127,  97,  33, -28,  44,  32, -18, -11, -75,
+         -51, -67, -61, -58, -58, -47,  -1, -61, -61, -60, -77, -77, -54, -77, -68, -52,
+         -75, -37, -63, -49, -69, -60, -60, -69,  30,  10,  -5,  -6,  10, -38, -69, -61,
+    },
+    {
+           4,  22,  38,  28,   1,   0,  13,  36,   0,   5,  63,  31,  42,   0,  68,  43,
+          35,  26,  50,  47,   5, -10,  46,  -3,  20,   8,   4,  17,  30,  39,  18,  37,
+          53,  12,  52,  10,  76,  14, -18,  37,  26,  27,  26,  28,  30,   6,  35,  38,
+          31,  32,  23,  73,  42, 102, 119, -49, -92, -65, -39, -34,  15,  20,  34,  92,
+          32,  67,  42,  39,  39,  36,   5,  30,  68,  46,  51,  57,  58,  27,  58,  50,
+           9,   1, -10, -16, -25, -22, -32, -45, -84, -73, -55, -36, -33,  22, 110, 127,
+    },
+    {
+           5, -18, -28, -19,  10,  -1,  10, -34,   2,   7, -57, -24, -24,  24, -67, -40,
+         -29,  -5, -12,  12,  29,  46, -16,  25, -28,  -9,  -9, -24, -44, -32, -21, -35,
+         -58,  20, -51,  19, -93,  10,  76, -25,   1,  12,  17, -12,   1,   6, -24,   0,
+           8,   4,   4,  26,  31, -64, -97,  79,  82,  75,  71,  51, -14, -16, -49,-127,
+        -105,-108,-102,-103, -97, -78,   0, -86, -95, -72, -93, -72, -74, -61,-102, -73,
+         -20, -16, -19, -34, -36, -21, -32, -43,  40,  29,   7, -10,   2, -56,-105, -97,
+    },
+};
+
+static constexpr int32_t SLAP_MODEL_B1[16] = {
+    945, 794, 686, 3082, 967, 4391, -41, 762,
+    -538, 3244, -333, -1952, 89, -6, 3049, 1137,
+};
+
+static constexpr int32_t SLAP_MODEL_M1[16] = {
+    1596315871, 1385787117, 1678192565, 2067656930, 1407781794, 1768474768, 2085451254, 1342450454,
+    2008029642, 1741481943, 1198367578, 2030428418, 1375477812, 1700437170, 1118256979, 1499198540,
+};
+
+static constexpr int8_t SLAP_MODEL_S1[16] = {
+    40, 40, 41, 41, 40, 41, 40, 40,
+    41, 41, 40, 44, 40, 41, 40, 41,
+};
+
+// Layer 2: logits (slap, bump, drop) = int32 accumulator * OUT_SCALE
+static constexpr int8_t SLAP_MODEL_W2[3][16] = {
+    {
+          63,  52,  43, -34,  49,   0,-127,  58, -34, -17, -64,  11,  51, 115, -41,  36,
+    },
+    {
+         -49, -56, -26,  33, -44,  18, 127, -53,  15,  36,  38,   4, -93,-125,  39, -22,
+    },
+    {
+         -76, -50, -63,-127, -84,-125, -39, -37,  57, -97,  34,   7,  58,  23,-115, -39,
+    },
+};
+
+static constexpr int32_t SLAP_MODEL_B2[3] = {-13, 29, -96};
+
+static constexpr float SLAP_MODEL_OUT_SCALE[3] = {0.0140010063f, 0.0149995089f, 0.00782964192f};
+
+#endif // SLAPMODEL_H
@@ -0,0 +1,56 @@
+/*
+ * Lock-free single-producer / single-consumer ring buffer
+ *
+ * One task pushes, one task pops; no locks, no allocation.
+ * Capacity must be a power of two.
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <stddef.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    // Producer side. Returns false (item dropped) when the ring is full.
+    bool push(const T &item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        if (h - t == N) return false;
+
+        buffer[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T &item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        if (h == t) return false;
+
+        item = buffer[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T buffer[N];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+};
+
+#endif // SPSCRING_H
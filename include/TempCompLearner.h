@@ -0,0 +1,214 @@
+/*
+ * Temperature Compensation Learner
+ *
+ * Learns the accelerometer bias drift over temperature from the board's
+ * own still periods, for boards that stay mounted in one place while the
+ * room warms and cools over the day:
+ *   1. samples are grouped into windows of TEMPCOMP_WINDOW_SAMPLES; a
+ *      window counts when the board was still (small accel spread, gyro
+ *      quiet) in the orientation of the first still window
+ *   2. still-window means are binned by temperature (TEMPCOMP_BIN_C), so
+ *      hours at one temperature do not outweigh a short warm spell
+ *   3. a least squares line through the bin means gives the drift per
+ *      degree on each axis once the bins span TEMPCOMP_MIN_SPAN_C
+ *
+ * The samples arrive with the active compensation already applied, so
+ * the fit is the residual slope and compose() adds it to the model.
+ * No Arduino dependencies.
+ */
+
+#ifndef TEMPCOMPLEARNER_H
+#define TEMPCOMPLEARNER_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "IMUTypes.h"
+
+#define TEMPCOMP_WINDOW_SAMPLES 1024    // ~4.6 s at 224 Hz
+#define TEMPCOMP_MAX_SPREAD_G   0.03f   // peak-to-peak per axis while still
+#define TEMPCOMP_MAX_GYRO_DPS   3.0f
+#define TEMPCOMP_MAX_TILT_COS   0.9994f // cos(2 deg): still in the same pose
+#define TEMPCOMP_BIN_C          0.5f
+#define TEMPCOMP_MIN_C          (-20.0f)
+#define TEMPCOMP_BINS           200     // -20 .. 80 degrees C
+#define TEMPCOMP_MIN_BINS       4
+#define TEMPCOMP_MIN_SPAN_C     4.0f
+#define TEMPCOMP_MAX_SLOPE      0.005f  // g per degree C, beyond is not drift
+
+struct TempCompFit {
+    bool ready;                 // enough temperature span for a fit
+    float minTempC, maxTempC;
+    uint16_t bins;              // temperature bins with still windows
+    float meanTempC;            // centre of the data
+    float slope[3];             // residual drift, g per degree C
+};
+
+class TempCompLearner {
+private:
+    // Double sums: a bin may collect days of windows, and the drift is
+    // a few mg on top of 1 g (once per window, the cost does not matter)
+    struct Bin {
+        uint32_t windows;
+        double tempSum;
+        double accelSum[3];
+    };
+
+    Bin bin[TEMPCOMP_BINS];
+    float pose[3];              // unit gravity of the first still window
+    bool poseSet;
+    uint32_t stillWindows;
+    uint32_t movedWindows;      // rejected: moving or in another pose
+    uint32_t poseChanges;
+
+    // Running window
+    uint16_t count;
+    float accelSum[3];
+    float accelMin[3];
+    float accelMax[3];
+    float gyroMaxSq;
+    float tempSum;
+
+    void resetWindow() {
+        count = 0;
+        gyroMaxSq = 0;
+        tempSum = 0;
+        for (int i = 0; i < 3; i++) {
+            accelSum[i] = 0;
+            accelMin[i] = 1e9f;
+            accelMax[i] = -1e9f;
+        }
+    }
+
+    void finishWindow() {
+        bool still = gyroMaxSq <= TEMPCOMP_MAX_GYRO_DPS * TEMPCOMP_MAX_GYRO_DPS;
+        float mean[3];
+        for (int i = 0; i < 3; i++) {
+            if (accelMax[i] - accelMin[i] > TEMPCOMP_MAX_SPREAD_G) still = false;
+            mean[i] = accelSum[i] / count;
+        }
+        float temp = tempSum / count;
+        int b = (int)floorf((temp - TEMPCOMP_MIN_C) / TEMPCOMP_BIN_C);
+        if (!still || b < 0 || b >= TEMPCOMP_BINS) {
+            movedWindows++;
+            return;
+        }
+
+        float norm = sqrtf(mean[0] * mean[0] + mean[1] * mean[1] + mean[2] * mean[2]);
+        if (norm < 0.5f) {
+            movedWindows++;
+            return;
+        }
+        float dir[3] = {mean[0] / norm, mean[1] / norm, mean[2] / norm};
+
+        // Moved to another pose: the old data no longer applies
+        if (poseSet && dir[0] * pose[0] + dir[1] * pose[1] + dir[2] * pose[2] < TEMPCOMP_MAX_TILT_COS) {
+            clear();
+            poseChanges++;
+        }
+        if (!poseSet) {
+            memcpy(pose, dir, sizeof(pose));
+            poseSet = true;
+        }
+
+        bin[b].windows++;
+        bin[b].tempSum += temp;
+        for (int i = 0; i < 3; i++) bin[b].accelSum[i] += mean[i];
+        stillWindows++;
+    }
+
+    // Data collected so far, keeping the counters
+    void clear() {
+        memset(bin, 0, sizeof(bin));
+        poseSet = false;
+        stillWindows = 0;
+    }
+
+public:
+    TempCompLearner() { reset(); }
+
+    void reset() {
+        clear();
+        movedWindows = 0;
+        poseChanges = 0;
+        resetWindow();
+    }
+
+    // One sample: accel in g, gyro in dps, sensor temperature
+    void addSample(const float accel[3], const float gyro[3], float tempC) {
+        for (int i = 0; i < 3; i++) {
+            accelSum[i] += accel[i];
+            if (accel[i] < accelMin[i]) accelMin[i] = accel[i];
+            if (accel[i] > accelMax[i]) accelMax[i] = accel[i];
+        }
+        float gyroSq = gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2];
+        if (gyroSq > gyroMaxSq) gyroMaxSq = gyroSq;
+        tempSum += tempC;
+
+        if (++count >= TEMPCOMP_WINDOW_SAMPLES) {
+            finishWindow();
+            resetWindow();
+        }
+    }
+
+    // Least squares line through the bin means, equal weight per bin
+    TempCompFit fit() const {
+        TempCompFit f;
+        memset(&f, 0, sizeof(f));
+        float st = 0, sa[3] = {0, 0, 0};
+        f.minTempC = 1e9f;
+        f.maxTempC = -1e9f;
+
+        for (int b = 0; b < TEMPCOMP_BINS; b++) {
+            if (bin[b].windows == 0) continue;
+            float t = (float)(bin[b].tempSum / bin[b].windows);
+            st += t;
+            for (int i = 0; i < 3; i++) sa[i] += (float)(bin[b].accelSum[i] / bin[b].windows);
+            if (t < f.minTempC) f.minTempC = t;
+            if (t > f.maxTempC) f.maxTempC = t;
+            f.bins++;
+        }
+        if (f.bins == 0) {
+            f.minTempC = f.maxTempC = 0;
+            return f;
+        }
+        f.meanTempC = st / f.bins;
+        if (f.bins < TEMPCOMP_MIN_BINS || f.maxTempC - f.minTempC < TEMPCOMP_MIN_SPAN_C) return f;
+
+        // Second pass about the means (float sums of t^2 lose the slope)
+        float stt = 0, sta[3] = {0, 0, 0};
+        for (int b = 0; b < TEMPCOMP_BINS; b++) {
+            if (bin[b].windows == 0) continue;
+            float dt = (float)(bin[b].tempSum / bin[b].windows) - f.meanTempC;
+            stt += dt * dt;
+            for (int i = 0; i < 3; i++) {
+                sta[i] += dt * ((float)(bin[b].accelSum[i] / bin[b].windows) - sa[i] / f.bins);
+            }
+        }
+        f.ready = true;
+        for (int i = 0; i < 3; i++) f.slope[i] = sta[i] / stt;
+        return f;
+    }
+
+    // Add a residual fit to the active model. A new model is centred on
+    // the data, an existing one keeps its reference temperature (where
+    // its correction, and the output, do not change).
+    static bool compose(const IMUTempCompensation &active, const TempCompFit &f,
+                        IMUTempCompensation &out) {
+        if (!f.ready) return false;
+        out.valid = true;
+        out.refTempC = active.valid ? active.refTempC : f.meanTempC;
+        for (int i = 0; i < 3; i++) {
+            out.accelSlope[i] = (active.valid ? active.accelSlope[i] : 0) + f.slope[i];
+            if (fabsf(out.accelSlope[i]) > TEMPCOMP_MAX_SLOPE) return false;
+        }
+        return true;
+    }
+
+    bool hasPose() const { return poseSet; }
+    uint32_t getStillWindows() const { return stillWindows; }
+    uint32_t getMovedWindows() const { return movedWindows; }
+    uint32_t getPoseChanges() const { return poseChanges; }
+};
+
+#endif // TEMPCOMPLEARNER_H
@@ -0,0 +1,140 @@
+/*
+ * Temperature Compensation Routine
+ *
+ * Drives TempCompLearner on the loop() task: while learning, every
+ * drained sample is fed with the sensor temperature. finish() fits the
+ * drift (once the still periods cover TEMPCOMP_MIN_SPAN_C), adds it to
+ * the active model, saves it to NVS and hands it to the sensor task,
+ * which applies it with the calibration at every temperature read.
+ *
+ * Learning takes hours of a board left in place while the temperature
+ * changes (a day in an unheated room); the collected data is not kept
+ * across reboots.
+ *
+ * Requests (start / finish / cancel / clear) may come from any task; the
+ * work happens in poll() and addSample() on the loop task.
+ */
+
+#ifndef TEMPCOMPENSATION_H
+#define TEMPCOMPENSATION_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "QMI8658C.h"
+#include "SensorTask.h"
+#include "Config.h"
+#include "TempCompLearner.h"
+
+enum TempCompState : uint8_t {
+    TEMPCOMP_IDLE = 0,
+    TEMPCOMP_LEARNING,
+    TEMPCOMP_DONE,      // fitted, saved and applied
+    TEMPCOMP_FAILED
+};
+
+class TempCompensator {
+private:
+    enum Request { REQ_NONE = 0, REQ_START, REQ_FINISH, REQ_CANCEL, REQ_CLEAR };
+
+    SensorTask *sensor;
+    ConfigManager *config;
+    std::atomic<int> request;
+    std::atomic<uint8_t> state;
+    const char *lastError;
+    TempCompLearner learner;
+
+    void apply(const IMUTempCompensation &comp) {
+        sensor->setTempCompensation(comp);
+        config->setTempCompensation(comp);
+        config->save();
+    }
+
+    void solve() {
+        TempCompFit f = learner.fit();
+        if (!f.ready) {
+            // Keep learning; the range may still grow
+            lastError = "Not enough temperature range yet";
+            Serial.printf("TempComp: %u bins over %.1f..%.1f C, need %.0f C\n",
+                          f.bins, f.minTempC, f.maxTempC, TEMPCOMP_MIN_SPAN_C);
+            return;
+        }
+
+        IMUTempCompensation comp;
+        if (!TempCompLearner::compose(config->getTempCompensation(), f, comp)) {
+            lastError = "Drift out of range, check the mounting";
+            state = TEMPCOMP_FAILED;
+            Serial.printf("TempComp: %s\n", lastError);
+            return;
+        }
+
+        apply(comp);
+        lastError = nullptr;
+        state = TEMPCOMP_DONE;
+        Serial.printf("TempComp: Done. %.2f %.2f %.2f mg/C around %.1f C\n",
+                      comp.accelSlope[0] * 1000, comp.accelSlope[1] * 1000,
+                      comp.accelSlope[2] * 1000, comp.refTempC);
+    }
+
+public:
+    TempCompensator(SensorTask *sensorTask, ConfigManager *cfg)
+        : sensor(sensorTask), config(cfg), request(REQ_NONE), state(TEMPCOMP_IDLE),
+          lastError(nullptr) {}
+
+    // Requests, safe to call from any task
+    void start() { request = REQ_START; }
+    void finish() { request = REQ_FINISH; }
+    void cancel() { request = REQ_CANCEL; }
+    void clear() { request = REQ_CLEAR; }
+
+    TempCompState getState() const { return (TempCompState)state.load(); }
+    const char *getLastError() const { return lastError; }
+
+    // Learning progress (loop task writes, readers get a best effort view)
+    TempCompFit getFit() const { return learner.fit(); }
+    uint32_t getStillWindows() const { return learner.getStillWindows(); }
+    uint32_t getMovedWindows() const { return learner.getMovedWindows(); }
+    uint32_t getPoseChanges() const { return learner.getPoseChanges(); }
+
+    // Handle pending requests (loop task)
+    void poll() {
+        int req = request.exchange(REQ_NONE);
+        switch (req) {
+        case REQ_START:
+            learner.reset();
+            lastError = nullptr;
+            state = TEMPCOMP_LEARNING;
+            Serial.println("TempComp: Learning, leave the board in place");
+            break;
+        case REQ_FINISH:
+            if (state == TEMPCOMP_LEARNING) solve();
+            break;
+        case REQ_CANCEL:
+            state = TEMPCOMP_IDLE;
+            break;
+        case REQ_CLEAR: {
+            IMUTempCompensation comp;
+            memset(&comp, 0, sizeof(comp));
+            apply(comp);
+            learner.reset();
+            state = TEMPCOMP_IDLE;
+            Serial.println("TempComp: Cleared");
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // Feed every sample drained from the sensor task (loop task)
+    void addSample(const IMUSample &sample) {
+        if (state != TEMPCOMP_LEARNING) return;
+
+        float aScale = QMI8658C::accelScaleFor(sample.accelRange);
+        float gScale = QMI8658C::gyroScaleFor(sensor->getGyroRange());
+        float accel[3] = {sample.accelX * aScale, sample.accelY * aScale, sample.accelZ * aScale};
+        float gyro[3] = {sample.gyroX * gScale, sample.gyroY * gScale, sample.gyroZ * gScale};
+        learner.addSample(accel, gyro, sensor->getTemperature());
+    }
+};
+
+#endif // TEMPCOMPENSATION_H
@@ -0,0 +1,430 @@
+/*
+ * Pre/Post-Trigger Waveform Capture
+ *
+ * Keeps a rolling history of full-rate IMU samples in PSRAM and freezes
+ * a window around each slap into a capture slot for download.
+ *
+ * Samples are written once, into 64-sample blocks from a PSRAM pool. The
+ * history is a list of block references; a capture takes references on
+ * the blocks that cover its window (and on new blocks until the post-
+ * trigger part is complete), so freezing never copies samples. A block
+ * returns to the pool when neither the history nor a capture uses it.
+ *
+ * push() / trigger() run in the sensor task only. The web server reads
+ * finished slots between beginRead() / endRead(); such slots are never
+ * recycled while being read.
+ *
+ * Download format: see WaveformFormat.h
+ */
+
+#ifndef WAVEFORMCAPTURE_H
+#define WAVEFORMCAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "QMI8658C.h"
+#include "MotionDetector.h"
+#include "WaveformFormat.h"
+
+#define WAVEFORM_BLOCK_SAMPLES  64
+#define WAVEFORM_HISTORY_BLOCKS 17      // ~1 s at 1 kHz ODR, newest block filling
+#define WAVEFORM_SLOTS          4
+#define WAVEFORM_SLOT_BLOCKS    18      // pre + post up to ~1 s at 1 kHz
+#define WAVEFORM_POOL_BLOCKS    (WAVEFORM_HISTORY_BLOCKS + WAVEFORM_SLOTS * WAVEFORM_SLOT_BLOCKS + 1)
+
+enum WaveformSlotState : uint8_t {
+    WAVEFORM_EMPTY = 0,
+    WAVEFORM_FILLING,           // waiting for post-trigger samples
+    WAVEFORM_READY
+};
+
+// Capture summary for listings
+struct WaveformInfo {
+    uint32_t id;
+    uint32_t timeMs;            // uptime at the trigger
+    uint32_t sampleCount;
+    uint32_t samplePeriodUs;
+    float peak;
+    size_t bytes;
+};
+
+class WaveformCapture {
+private:
+    struct Block {
+        IMUSample samples[WAVEFORM_BLOCK_SAMPLES];
+        uint32_t base;          // stream index of samples[0]
+        uint8_t refs;
+    };
+
+    struct Slot {
+        std::atomic<uint8_t> state;
+        std::atomic<int> readers;
+        std::atomic<bool> releaseRequested;
+        uint32_t id;
+        uint16_t blocks[WAVEFORM_SLOT_BLOCKS];
+        uint8_t blockCount;
+        uint32_t start;         // stream indices
+        uint32_t trigger;
+        uint32_t end;
+        uint32_t timeMs;
+        uint32_t samplePeriodUs;
+        uint8_t gyroRange;
+        SlapEvent event;
+    };
+
+    Block *pool;
+    uint16_t freeStack[WAVEFORM_POOL_BLOCKS];
+    uint16_t freeCount;
+
+    uint16_t history[WAVEFORM_HISTORY_BLOCKS];  // oldest first
+    uint8_t historyCount;
+    uint8_t historyLimit;
+    uint16_t fill;                              // samples in the newest block
+    uint32_t total;                             // samples pushed
+    uint32_t lastTimestampUs;
+
+    Slot slots[WAVEFORM_SLOTS];
+    uint8_t fillingSlots;
+    uint32_t nextId;
+
+    std::atomic<uint16_t> preMs;
+    std::atomic<uint16_t> postMs;
+    std::atomic<uint32_t> dropped;
+
+    void unref(uint16_t block) {
+        if (--pool[block].refs == 0) {
+            freeStack[freeCount++] = block;
+        }
+    }
+
+    void releaseSlot(Slot &slot) {
+        for (uint8_t i = 0; i < slot.blockCount; i++) {
+            unref(slot.blocks[i]);
+        }
+        slot.blockCount = 0;
+        slot.releaseRequested = false;
+    }
+
+    // Move a READY slot to EMPTY unless a reader holds it
+    bool recycle(Slot &slot) {
+        slot.state = WAVEFORM_EMPTY;
+        if (slot.readers.load() > 0) {
+            slot.state = WAVEFORM_READY;
+            return false;
+        }
+        releaseSlot(slot);
+        return true;
+    }
+
+    void startBlock() {
+        // Slots released by the web server are reclaimed here, in the
+        // sensor task, which owns the pool
+        for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+            if (slots[i].releaseRequested && slots[i].state == WAVEFORM_READY) {
+                recycle(slots[i]);
+            }
+        }
+
+        while (historyCount >= historyLimit) {
+            unref(history[0]);
+            memmove(&history[0], &history[1], (historyCount - 1) * sizeof(history[0]));
+            historyCount--;
+        }
+
+        uint16_t index = freeStack[--freeCount];
+        Block &block = pool[index];
+        block.base = total;
+        block.refs = 1;
+        history[historyCount++] = index;
+        fill = 0;
+
+        // Captures still collecting post-trigger samples take the new block
+        if (fillingSlots == 0) return;
+        for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+            Slot &slot = slots[i];
+            if (slot.state == WAVEFORM_FILLING && slot.end > total &&
+                slot.blockCount < WAVEFORM_SLOT_BLOCKS) {
+                slot.blocks[slot.blockCount++] = index;
+                block.refs++;
+            }
+        }
+    }
+
+    void completeSlots() {
+        for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+            Slot &slot = slots[i];
+            if (slot.state == WAVEFORM_FILLING && total >= slot.end) {
+                slot.state = WAVEFORM_READY;
+                fillingSlots--;
+            }
+        }
+    }
+
+    Slot *findSlot(uint32_t id) {
+        for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+            if (slots[i].state == WAVEFORM_READY && slots[i].id == id) return &slots[i];
+        }
+        return nullptr;
+    }
+
+    static size_t slotBytes(const Slot &slot) {
+        return sizeof(WaveformFileHeader) + (slot.end - slot.start) * sizeof(WaveformRecord);
+    }
+
+public:
+    WaveformCapture()
+        : pool(nullptr), freeCount(0), historyCount(0),
+          historyLimit(WAVEFORM_HISTORY_BLOCKS), fill(0), total(0),
+          lastTimestampUs(0), fillingSlots(0), nextId(1),
+          preMs(300), postMs(300), dropped(0) {
+        for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+            slots[i].state = WAVEFORM_EMPTY;
+            slots[i].readers = 0;
+            slots[i].releaseRequested = false;
+            slots[i].blockCount = 0;
+        }
+    }
+
+    // Allocate the block pool in PSRAM
+    bool begin() {
+        if (pool != nullptr) return true;
+        if (!psramFound()) {
+            Serial.println("WaveformCapture: No PSRAM, capture disabled");
+            return false;
+        }
+
+        pool = (Block *)ps_malloc(WAVEFORM_POOL_BLOCKS * sizeof(Block));
+        if (pool == nullptr) {
+            Serial.println("WaveformCapture: PSRAM allocation failed");
+            return false;
+        }
+        for (uint16_t i = 0; i < WAVEFORM_POOL_BLOCKS; i++) {
+            freeStack[i] = WAVEFORM_POOL_BLOCKS - 1 - i;
+        }
+        freeCount = WAVEFORM_POOL_BLOCKS;
+
+        Serial.printf("WaveformCapture: %u KB PSRAM, %d slots\n",
+                      (unsigned)(WAVEFORM_POOL_BLOCKS * sizeof(Block) / 1024), WAVEFORM_SLOTS);
+        return true;
+    }
+
+    bool isEnabled() const { return pool != nullptr; }
+
+    // Window around the event peak; applies to the next trigger
+    void setWindow(uint16_t preWindowMs, uint16_t postWindowMs) {
+        preMs = preWindowMs;
+        postMs = postWindowMs;
+    }
+    uint16_t getPreMs() const { return preMs; }
+    uint16_t getPostMs() const { return postMs; }
+    uint32_t getDropped() const { return dropped; }
+
+    // History length follows the sample rate: ~1 s (sensor task)
+    void setSampleRate(float hz) {
+        uint32_t blocks = (uint32_t)(hz / WAVEFORM_BLOCK_SAMPLES) + 2;
+        historyLimit = (uint8_t)constrain(blocks, (uint32_t)2, (uint32_t)WAVEFORM_HISTORY_BLOCKS);
+    }
+
+    // Sensor task: append one sample to the history
+    void push(const IMUSample &sample) {
+        if (pool == nullptr) return;
+        if (historyCount == 0 || fill == WAVEFORM_BLOCK_SAMPLES) {
+            startBlock();
+        }
+        pool[history[historyCount - 1]].samples[fill++] = sample;
+        total++;
+        lastTimestampUs = sample.timestampUs;
+
+        if (fillingSlots > 0) completeSlots();
+    }
+
+    // Sensor task: freeze the window around event's peak. The peak must
+    // be among the samples already pushed.
+    bool trigger(const SlapEvent &event, uint32_t samplePeriodUs, uint8_t gyroRange) {
+        if (pool == nullptr || historyCount == 0 || samplePeriodUs == 0) return false;
+
+        // Free slot, else the oldest finished one nobody is reading
+        Slot *slot = nullptr;
+        for (int i = 0; i < WAVEFORM_SLOTS && slot == nullptr; i++) {
+            if (slots[i].state == WAVEFORM_EMPTY) slot = &slots[i];
+        }
+        if (slot == nullptr) {
+            Slot *oldest = nullptr;
+            for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+                if (slots[i].state == WAVEFORM_READY &&
+                    (oldest == nullptr || slots[i].id < oldest->id)) {
+                    oldest = &slots[i];
+                }
+            }
+            if (oldest != nullptr && recycle(*oldest)) slot = oldest;
+        }
+        if (slot == nullptr) {
+            dropped++;
+            return false;
+        }
+
+        // Stream index of the peak, from the FIFO timestamps
+        uint32_t back = (lastTimestampUs - event.timestampUs + samplePeriodUs / 2) / samplePeriodUs;
+        if (back >= total) back = total - 1;
+        uint32_t peak = total - 1 - back;
+
+        uint32_t pre = (uint32_t)preMs * 1000 / samplePeriodUs;
+        uint32_t post = (uint32_t)postMs * 1000 / samplePeriodUs;
+        uint32_t oldestIndex = pool[history[0]].base;
+        if (peak < oldestIndex) peak = oldestIndex;
+        uint32_t start = peak > pre ? peak - pre : 0;
+        if (start < oldestIndex) start = oldestIndex;
+        uint32_t end = peak + post + 1;
+
+        // The window must fit the slot's block list
+        const uint32_t maxSamples = (WAVEFORM_SLOT_BLOCKS - 1) * WAVEFORM_BLOCK_SAMPLES;
+        if (end - start > maxSamples) end = start + maxSamples;
+
+        slot->id = nextId++;
+        slot->start = start;
+        slot->trigger = peak;
+        slot->end = end;
+        slot->timeMs = millis() - (micros() - event.timestampUs) / 1000;
+        slot->samplePeriodUs = samplePeriodUs;
+        slot->gyroRange = gyroRange;
+        slot->event = event;
+        slot->blockCount = 0;
+
+        // Reference the history blocks covering the window (no copy)
+        for (uint8_t i = 0; i < historyCount; i++) {
+            Block &block = pool[history[i]];
+            if (block.base + WAVEFORM_BLOCK_SAMPLES > start && block.base < end) {
+                slot->blocks[slot->blockCount++] = history[i];
+                block.refs++;
+            }
+        }
+
+        if (total >= end) {
+            slot->state = WAVEFORM_READY;
+        } else {
+            slot->state = WAVEFORM_FILLING;
+            fillingSlots++;
+        }
+        return true;
+    }
+
+    // Web server side ------------------------------------------------------
+
+    // Up to max finished captures, oldest first
+    size_t list(WaveformInfo *out, size_t max) {
+        size_t count = 0;
+        for (int i = 0; i < WAVEFORM_SLOTS && count < max; i++) {
+            const Slot &slot = slots[i];
+            if (slot.state != WAVEFORM_READY || slot.releaseRequested) continue;
+            WaveformInfo &info = out[count++];
+            info.id = slot.id;
+            info.timeMs = slot.timeMs;
+            info.sampleCount = slot.end - slot.start;
+            info.samplePeriodUs = slot.samplePeriodUs;
+            info.peak = slot.event.peak;
+            info.bytes = slotBytes(slot);
+        }
+        for (size_t i = 1; i < count; i++) {
+            for (size_t j = i; j > 0 && out[j].id < out[j - 1].id; j--) {
+                WaveformInfo t = out[j];
+                out[j] = out[j - 1];
+                out[j - 1] = t;
+            }
+        }
+        return count;
+    }
+
+    // Pin a finished capture for reading; returns its size in bytes, 0 if
+    // there is no such capture
+    size_t beginRead(uint32_t id) {
+        Slot *slot = findSlot(id);
+        if (slot == nullptr) return 0;
+        slot->readers++;
+        if (slot->state != WAVEFORM_READY || slot->id != id) {
+            slot->readers--;
+            return 0;
+        }
+        return slotBytes(*slot);
+    }
+
+    void endRead(uint32_t id) {
+        for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+            if (slots[i].id == id && slots[i].readers.load() > 0) {
+                slots[i].readers--;
+                return;
+            }
+        }
+    }
+
+    // Serialize bytes [offset, offset + maxLen) of a pinned capture
+    size_t read(uint32_t id, size_t offset, uint8_t *buf, size_t maxLen) {
+        Slot *slot = nullptr;
+        for (int i = 0; i < WAVEFORM_SLOTS; i++) {
+            if (slots[i].id == id && slots[i].readers.load() > 0) slot = &slots[i];
+        }
+        if (slot == nullptr) return 0;
+
+        size_t size = slotBytes(*slot);
+        size_t written = 0;
+        while (written < maxLen && offset < size) {
+            uint8_t tmp[sizeof(WaveformFileHeader)];
+            size_t partLen;
+            size_t partOffset;
+
+            if (offset < sizeof(WaveformFileHeader)) {
+                WaveformFileHeader h;
+                memcpy(h.magic, WAVEFORM_MAGIC, 4);
+                h.version = WAVEFORM_VERSION;
+                h.recordBytes = sizeof(WaveformRecord);
+                h.gyroRange = slot->gyroRange;
+                h.direction = slot->event.direction;
+                h.sampleCount = slot->end - slot->start;
+                h.triggerIndex = slot->trigger - slot->start;
+                h.samplePeriodUs = slot->samplePeriodUs;
+                h.firstTimestampUs = slot->event.timestampUs -
+                                     h.triggerIndex * slot->samplePeriodUs;
+                h.peak = slot->event.peak;
+                h.energy = slot->event.energy;
+                h.durationUs = slot->event.durationUs;
+                memcpy(tmp, &h, sizeof(h));
+                partLen = sizeof(h);
+                partOffset = offset;
+            } else {
+                size_t rel = offset - sizeof(WaveformFileHeader);
+                uint32_t index = slot->start + rel / sizeof(WaveformRecord);
+                uint32_t base = pool[slot->blocks[0]].base;
+                uint32_t k = (index - base) / WAVEFORM_BLOCK_SAMPLES;
+                if (k >= slot->blockCount) break;
+                const IMUSample &s = pool[slot->blocks[k]].samples[(index - base) % WAVEFORM_BLOCK_SAMPLES];
+
+                WaveformRecord r;
+                r.accel[0] = s.accelX;
+                r.accel[1] = s.accelY;
+                r.accel[2] = s.accelZ;
+                r.gyro[0] = s.gyroX;
+                r.gyro[1] = s.gyroY;
+                r.gyro[2] = s.gyroZ;
+                r.accelRange = s.accelRange;
+                memcpy(tmp, &r, sizeof(r));
+                partLen = sizeof(r);
+                partOffset = rel % sizeof(WaveformRecord);
+            }
+
+            size_t n = min(partLen - partOffset, maxLen - written);
+            memcpy(buf + written, tmp + partOffset, n);
+            written += n;
+            offset += n;
+        }
+        return written;
+    }
+
+    // Give a capture back to the pool (reclaimed by the sensor task)
+    bool release(uint32_t id) {
+        Slot *slot = findSlot(id);
+        if (slot == nullptr) return false;
+        slot->releaseRequested = true;
+        return true;
+    }
+};
+
+#endif // WAVEFORMCAPTURE_H
@@ -0,0 +1,39 @@
+/*
+ * Waveform Capture File Format
+ *
+ * Layout of the files served by /api/capture (little endian, packed):
+ * one WaveformFileHeader followed by sampleCount WaveformRecords, one
+ * per sample period. No Arduino dependencies, so host tools can read
+ * recorded captures with the same definitions.
+ */
+
+#ifndef WAVEFORMFORMAT_H
+#define WAVEFORMFORMAT_H
+
+#include <stdint.h>
+
+#define WAVEFORM_MAGIC   "SLPW"
+#define WAVEFORM_VERSION 1
+
+struct __attribute__((packed)) WaveformFileHeader {
+    char magic[4];              // "SLPW"
+    uint8_t version;
+    uint8_t recordBytes;        // sizeof(WaveformRecord)
+    uint8_t gyroRange;          // QMI8658C_GyroRange
+    int8_t direction;           // SlapEvent::direction
+    uint32_t sampleCount;
+    uint32_t triggerIndex;      // record at the event peak
+    uint32_t samplePeriodUs;
+    uint32_t firstTimestampUs;
+    float peak;                 // g
+    float energy;               // g^2*s
+    uint32_t durationUs;
+};
+
+struct __attribute__((packed)) WaveformRecord {
+    int16_t accel[3];           // counts at accelRange
+    int16_t gyro[3];            // counts at the header's gyroRange
+    uint8_t accelRange;         // QMI8658C_AccelRange
+};
+
+#endif // WAVEFORMFORMAT_H
@@ -22,12 +22,31 @@ typedef enum {
 #include <ArduinoJson.h>
 #include "Config.h"
 #include "WiFiManager.h"
+#include "SensorTask.h"
+#include "Calibration.h"
+#include "TempCompensation.h"
+#include "EventStore.h"
+#include "WaveformCapture.h"
+#include "GestureRecognizer.h"
 
 class SlapWebServer {
  private:
   AsyncWebServer *server;
+  AsyncEventSource *stream;
   ConfigManager *configMgr;
   SlapWiFiManager *wifiMgr;
+  SensorTask *sensorTask;
+  ImuCalibrator *calibrator;
+  EventStore *eventStore;
+  WaveformCapture *waveforms;
+  GestureRecognizer *gestures;
+  TempCompensator *tempComp;
+  uint32_t gestureSeq;
+
+  static const char *actionName(int bit) {
+    static const char *names[] = {"display", "network", "led"};
+    return names[bit];
+  }
 
   // HTML page with embedded CSS and JavaScript
   const char *getIndexHTML() {
@@ -128,6 +147,18 @@ class SlapWebServer {
         .slider-group {
             margin-bottom: 20px;
         }
+        .checkbox-group {
+            margin-bottom: 20px;
+            font-size: 14px;
+            color: #333;
+        }
+        .checkbox-group input[type="number"] {
+            width: 56px;
+        }
+        .noise-value {
+            margin-top: 8px;
+            color: #666;
+        }
         .slider-value {
             text-align: center;
             font-size: 24px;
@@ -319,6 +350,12 @@ class SlapWebServer {
                 <div class="slider-value"><span id="threshold-value">1.0</span>g</div>
                 <input type="range" id="threshold" min="0.1" max="5.0" step="0.1" value="1.0">
             </div>
+            <div class="checkbox-group">
+                <label><input type="checkbox" id="adaptive"> Adaptive: trigger at
+                    <input type="number" id="noise-k" min="3" max="50" step="1" value="10"> &times; noise
+                    (threshold above is the minimum)</label>
+                <div class="noise-value">Noise: <span id="noise">-</span> mg, active threshold <span id="active-threshold">-</span>g</div>
+            </div>
             <button class="button button-primary" onclick="saveThreshold()">Save Threshold</button>
         </div>
         
@@ -387,6 +424,12 @@ class SlapWebServer {
                 
                 thresholdSlider.value = data.threshold;
                 thresholdValue.textContent = data.threshold;
+                document.getElementById('adaptive').checked = data.adaptive;
+                document.getElementById('noise-k').value = data.noiseK;
+                if (data.sensor) {
+                    document.getElementById('noise').textContent = (data.sensor.noiseSigma * 1000).toFixed(1);
+                    document.getElementById('active-threshold').textContent = data.sensor.activeThreshold.toFixed(2);
+                }
                 
                 if (data.ssid) {
                     document.getElementById('ssid').value = data.ssid;
@@ -398,11 +441,13 @@ class SlapWebServer {
         
         async function saveThreshold() {
             const threshold = parseFloat(thresholdSlider.value);
+            const adaptive = document.getElementById('adaptive').checked;
+            const k = parseFloat(document.getElementById('noise-k').value);
             try {
                 const response = await fetch('/api/threshold', {
                     method: 'POST',
                     headers: { 'Content-Type': 'application/json' },
-                    body: JSON.stringify({ threshold })
+                    body: JSON.stringify({ threshold, adaptive, k })
                 });
                 if (response.ok) {
                     showMessage('✓ Threshold saved: ' + threshold + 'g');
@@ -616,9 +661,41 @@ class SlapWebServer {
   }
 
  public:
-  SlapWebServer(ConfigManager *cfg, SlapWiFiManager *wifi)
-      : configMgr(cfg), wifiMgr(wifi) {
+  SlapWebServer(ConfigManager *cfg, SlapWiFiManager *wifi,
+                SensorTask *sensor = nullptr, ImuCalibrator *cal = nullptr,
+                EventStore *events = nullptr,
+                WaveformCapture *capture = nullptr,
+                GestureRecognizer *gesture = nullptr,
+                TempCompensator *temp = nullptr)
+      : configMgr(cfg),
+        wifiMgr(wifi),
+        sensorTask(sensor),
+        calibrator(cal),
+        eventStore(events),
+        waveforms(capture),
+        gestures(gesture),
+        tempComp(temp),
+        gestureSeq(0) {
     server = new AsyncWebServer(80);
+    stream = new AsyncEventSource("/api/stream");
+  }
+
+  // Push a recognized gesture to every client of /api/stream
+  // (server-sent event "gesture")
+  void publishGesture(const GestureEvent &gesture) {
+    if (stream->count() == 0) return;
+
+    StaticJsonDocument<192> doc;
+    doc["gesture"] = GestureRecognizer::name(gesture.gesture);
+    doc["slaps"] = (int)gesture.gesture;
+    doc["peak"] = gesture.peak;
+    doc["spanMs"] = (gesture.lastUs - gesture.firstUs) / 1000;
+    doc["latencyMs"] = gesture.latencyUs / 1000;
+    doc["timeMs"] = millis();
+
+    char json[192];
+    serializeJson(doc, json, sizeof(json));
+    stream->send(json, "gesture", ++gestureSeq);
   }
 
   void begin() {
@@ -629,21 +706,284 @@ class SlapWebServer {
 
     // API: Get current status
     server->on("/api/status", HTTP_GET, [this](AsyncWebServerRequest *request) {
-      StaticJsonDocument<256> doc;
+      StaticJsonDocument<1024> doc;
 
       doc["status"] = wifiMgr->getStatusString();
       doc["isAPMode"] = wifiMgr->isAP();
       doc["ip"] = wifiMgr->getIPAddress();
       doc["rssi"] = wifiMgr->getRSSI();
       doc["threshold"] = configMgr->getThreshold();
+      doc["adaptive"] = configMgr->isAdaptiveThreshold();
+      doc["noiseK"] = configMgr->getNoiseK();
       doc["ssid"] = configMgr->getSSID();
 
+      if (sensorTask && sensorTask->isRunning()) {
+        SensorStats stats = sensorTask->getStats();
+        JsonObject sensor = doc.createNestedObject("sensor");
+        sensor["samples"] = stats.samples;
+        sensor["dropped"] = stats.droppedSamples + stats.droppedEvents;
+        sensor["maxLatencyUs"] = stats.maxLatencyUs;
+        sensor["maxIntervalUs"] = stats.maxIntervalUs;
+        sensor["detectCycles"] = stats.detectCycles;
+        sensor["featureCycles"] = stats.featureCycles;
+        sensor["classifyCycles"] = stats.classifyCycles;
+        sensor["noiseSigma"] = sensorTask->getNoiseSigma();
+        sensor["activeThreshold"] = sensorTask->getActiveThreshold();
+        sensor["accelRange"] = 2 << sensorTask->getAccelRange();
+        sensor["sampleRate"] = sensorTask->getSampleRateHz();
+        sensor["autoRange"] = sensorTask->isAutoRange();
+        sensor["onChip"] = sensorTask->isOnChipDetection();
+        sensor["fusion"] = sensorTask->isFusion();
+        sensor["temperature"] = sensorTask->getTemperature();
+
+        SensorOrientation o = sensorTask->getOrientation();
+        JsonObject orientation = sensor.createNestedObject("orientation");
+        orientation["roll"] = o.roll;
+        orientation["pitch"] = o.pitch;
+        JsonArray q = orientation.createNestedArray("q");
+        for (int i = 0; i < 4; i++) q.add(o.q[i]);
+        JsonArray linear = orientation.createNestedArray("linear");
+        for (int i = 0; i < 3; i++) linear.add(o.linear[i]);
+      }
+
       String response;
       serializeJson(doc, response);
       request->send(200, "application/json", response);
     });
 
-    // API: Set threshold
+    // API: Gesture window, bindings and recognition statistics
+    server->on("/api/gestures", HTTP_GET, [this](AsyncWebServerRequest *request) {
+      StaticJsonDocument<768> doc;
+      doc["windowMs"] = configMgr->getGestureWindowMs();
+
+      JsonObject bindings = doc.createNestedObject("bindings");
+      for (int g = GESTURE_SINGLE; g <= GESTURE_MAX_SLAPS; g++) {
+        JsonArray actions = bindings.createNestedArray(GestureRecognizer::name((Gesture)g));
+        uint8_t mask = configMgr->getGestureActions((Gesture)g);
+        for (int bit = 0; bit < 3; bit++) {
+          if (mask & (1 << bit)) actions.add(actionName(bit));
+        }
+      }
+
+      if (gestures) {
+        JsonObject recognized = doc.createNestedObject("recognized");
+        for (int g = GESTURE_SINGLE; g <= GESTURE_MAX_SLAPS; g++) {
+          recognized[GestureRecognizer::name((Gesture)g)] = gestures->getRecognized((Gesture)g);
+        }
+        doc["pending"] = gestures->getPendingSlaps();
+        doc["lastLatencyMs"] = gestures->getLastLatencyUs() / 1000.0f;
+        doc["maxLatencyMs"] = gestures->getMaxLatencyUs() / 1000.0f;
+      }
+      doc["clients"] = stream->count();
+
+      String response;
+      serializeJson(doc, response);
+      request->send(200, "application/json", response);
+    });
+
+    // API: Set gesture window and / or bindings (saved)
+    // {"windowMs":400,"bindings":{"double":["display","led"]}}
+    server->on(
+        "/api/gestures", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len,
+               size_t index, size_t total) {
+          StaticJsonDocument<512> doc;
+          DeserializationError error = deserializeJson(doc, data, len);
+
+          if (error) {
+            request->send(400, "application/json",
+                          "{\"error\":\"Invalid JSON\"}");
+            return;
+          }
+
+          // Below the detector's refractory time two slaps cannot both register
+          int windowMs = doc["windowMs"] | (int)configMgr->getGestureWindowMs();
+          if (windowMs < 150 || windowMs > 2000) {
+            request->send(400, "application/json",
+                          "{\"error\":\"windowMs must be between 150 and 2000\"}");
+            return;
+          }
+
+          uint8_t masks[GESTURE_MAX_SLAPS + 1];
+          for (int g = GESTURE_SINGLE; g <= GESTURE_MAX_SLAPS; g++) {
+            const char *name = GestureRecognizer::name((Gesture)g);
+            masks[g] = configMgr->getGestureActions((Gesture)g);
+            if (doc["bindings"][name].isNull()) continue;
+
+            masks[g] = 0;
+            for (JsonVariant action : doc["bindings"][name].as<JsonArray>()) {
+              const char *actionStr = action | "";
+              int bit = 0;
+              while (bit < 3 && strcmp(actionStr, actionName(bit)) != 0) bit++;
+              if (bit == 3) {
+                request->send(400, "application/json",
+                              "{\"error\":\"Unknown action\"}");
+                return;
+              }
+              masks[g] |= 1 << bit;
+            }
+          }
+
+          configMgr->setGestureWindowMs(windowMs);
+          for (int g = GESTURE_SINGLE; g <= GESTURE_MAX_SLAPS; g++) {
+            configMgr->setGestureActions((Gesture)g, masks[g]);
+          }
+          configMgr->save();
+
+          request->send(200, "application/json", "{\"success\":true}");
+        });
+
+    // API: Slap history after a sequence number
+    // GET /api/events?since=<seq>&limit=<n>; poll again with since=next
+    server->on("/api/events", HTTP_GET, [this](AsyncWebServerRequest *request) {
+      if (!eventStore) {
+        request->send(404, "application/json",
+                      "{\"error\":\"No event store\"}");
+        return;
+      }
+
+      uint32_t since = 0;
+      if (request->hasParam("since")) {
+        since = strtoul(request->getParam("since")->value().c_str(), NULL, 10);
+      }
+      size_t limit = 32;
+      if (request->hasParam("limit")) {
+        limit = constrain(request->getParam("limit")->value().toInt(), 1, 32);
+      }
+
+      SlapRecord records[32];
+      uint32_t lost = 0;
+      size_t count = eventStore->query(since, records, limit, lost);
+      uint32_t newest = eventStore->lastSeq();
+
+      DynamicJsonDocument doc(JSON_OBJECT_SIZE(5) + JSON_ARRAY_SIZE(32) +
+                              32 * JSON_OBJECT_SIZE(13));
+      uint32_t next = count > 0 ? records[count - 1].seq : min(since, newest);
+      doc["next"] = next;
+      doc["more"] = next < newest;
+      doc["lost"] = lost;
+      // since beyond the newest record: the device restarted
+      doc["reset"] = since > newest;
+
+      static const char *axes[] = {"-Z", "-Y", "-X", "", "+X", "+Y", "+Z"};
+      JsonArray list = doc.createNestedArray("events");
+      for (size_t i = 0; i < count; i++) {
+        JsonObject e = list.createNestedObject();
+        e["seq"] = records[i].seq;
+        e["timeMs"] = records[i].timeMs;
+        e["peak"] = records[i].peak;
+        e["durationMs"] = records[i].durationMs;
+        e["energy"] = records[i].energy;
+        e["direction"] = axes[records[i].direction + 3];
+        e["source"] = records[i].source;
+        e["rms"] = records[i].rms;
+        e["crest"] = records[i].crest;
+        e["kurtosis"] = records[i].kurtosis;
+        e["centroidHz"] = records[i].centroidHz;
+        e["class"] = SlapClassifier::labelName((SlapClass)records[i].label);
+        e["confidence"] = records[i].confidence;
+      }
+
+      String response;
+      serializeJson(doc, response);
+      request->send(200, "application/json", response);
+    });
+
+    // API: List waveform captures
+    server->on("/api/captures", HTTP_GET, [this](AsyncWebServerRequest *request) {
+      if (!waveforms || !waveforms->isEnabled()) {
+        request->send(404, "application/json",
+                      "{\"error\":\"Capture disabled\"}");
+        return;
+      }
+
+      WaveformInfo info[WAVEFORM_SLOTS];
+      size_t count = waveforms->list(info, WAVEFORM_SLOTS);
+
+      StaticJsonDocument<768> doc;
+      doc["preMs"] = waveforms->getPreMs();
+      doc["postMs"] = waveforms->getPostMs();
+      doc["dropped"] = waveforms->getDropped();
+      JsonArray list = doc.createNestedArray("captures");
+      for (size_t i = 0; i < count; i++) {
+        JsonObject c = list.createNestedObject();
+        c["id"] = info[i].id;
+        c["timeMs"] = info[i].timeMs;
+        c["samples"] = info[i].sampleCount;
+        c["sampleRate"] = 1000000.0f / info[i].samplePeriodUs;
+        c["peak"] = info[i].peak;
+        c["bytes"] = info[i].bytes;
+      }
+
+      String response;
+      serializeJson(doc, response);
+      request->send(200, "application/json", response);
+    });
+
+    // API: Download one capture (binary, see WaveformCapture.h)
+    server->on("/api/capture", HTTP_GET, [this](AsyncWebServerRequest *request) {
+      uint32_t id = 0;
+      if (request->hasParam("id")) {
+        id = strtoul(request->getParam("id")->value().c_str(), NULL, 10);
+      }
+
+      size_t size = waveforms ? waveforms->beginRead(id) : 0;
+      if (size == 0) {
+        request->send(404, "application/json",
+                      "{\"error\":\"No such capture\"}");
+        return;
+      }
+
+      WaveformCapture *capture = waveforms;
+      AsyncWebServerResponse *response = request->beginResponse(
+          "application/octet-stream", size,
+          [capture, id](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            return capture->read(id, index, buffer, maxLen);
+          });
+      char disposition[48];
+      snprintf(disposition, sizeof(disposition),
+               "attachment; filename=\"slap-%lu.bin\"", (unsigned long)id);
+      response->addHeader("Content-Disposition", disposition);
+      request->onDisconnect([capture, id]() { capture->endRead(id); });
+      request->send(response);
+    });
+
+    // API: Capture window / release a downloaded capture
+    // {"preMs": 300, "postMs": 300} and/or {"release": <id>}
+    server->on(
+        "/api/captures", HTTP_POST, [](AsyncWebServerRequest *request) {},
+        NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len,
+               size_t index, size_t total) {
+          StaticJsonDocument<128> doc;
+          DeserializationError error = deserializeJson(doc, data, len);
+
+          if (error || !waveforms) {
+            request->send(400, "application/json",
+                          "{\"error\":\"Invalid JSON\"}");
+            return;
+          }
+
+          if (!doc["preMs"].isNull() || !doc["postMs"].isNull()) {
+            int pre = doc["preMs"] | (int)waveforms->getPreMs();
+            int post = doc["postMs"] | (int)waveforms->getPostMs();
+            if (pre < 0 || post < 0 || pre + post > 1000) {
+              request->send(400, "application/json",
+                            "{\"error\":\"Window must be 0-1000 ms\"}");
+              return;
+            }
+            waveforms->setWindow(pre, post);
+          }
+
+          if (!doc["release"].isNull()) {
+            waveforms->release(doc["release"]);
+          }
+
+          request->send(200, "application/json", "{\"success\":true}");
+        });
+
+    // API: Set threshold {"threshold": g, "adaptive": bool, "k": sigmas},
+    // all fields optional
     server->on(
         "/api/threshold", HTTP_POST, [](AsyncWebServerRequest *request) {},
         NULL,
@@ -658,15 +998,245 @@ class SlapWebServer {
             return;
           }
 
-          float threshold = doc["threshold"];
-          if (threshold >= 0.1 && threshold <= 5.0) {
-            configMgr->setThreshold(threshold);
-            configMgr->save();
-            request->send(200, "application/json", "{\"success\":true}");
-          } else {
+          float threshold = doc["threshold"] | configMgr->getThreshold();
+          float k = doc["k"] | configMgr->getNoiseK();
+          if (threshold < 0.1 || threshold > 5.0) {
             request->send(400, "application/json",
                           "{\"error\":\"Invalid threshold\"}");
+            return;
+          }
+          if (k < 3.0 || k > 50.0) {
+            request->send(400, "application/json",
+                          "{\"error\":\"Invalid k\"}");
+            return;
+          }
+
+          configMgr->setThreshold(threshold);
+          configMgr->setNoiseK(k);
+          configMgr->setAdaptiveThreshold(doc["adaptive"] | configMgr->isAdaptiveThreshold());
+          configMgr->save();
+          request->send(200, "application/json", "{\"success\":true}");
+        });
+
+    // API: Set IMU range / output data rate
+    server->on(
+        "/api/imu", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len,
+               size_t index, size_t total) {
+          StaticJsonDocument<128> doc;
+          DeserializationError error = deserializeJson(doc, data, len);
+
+          if (error || !sensorTask) {
+            request->send(400, "application/json",
+                          "{\"error\":\"Invalid JSON\"}");
+            return;
+          }
+
+          // Accel range in g: 2, 4, 8 or 16
+          if (!doc["accelRange"].isNull()) {
+            int range = doc["accelRange"];
+            int code = -1;
+            for (int i = QMI8658C_ACCEL_2G; i <= QMI8658C_ACCEL_16G; i++) {
+              if (range == (2 << i)) code = i;
+            }
+            if (code < 0) {
+              request->send(400, "application/json",
+                            "{\"error\":\"Invalid accelRange\"}");
+              return;
+            }
+            sensorTask->setAccelRange((QMI8658C_AccelRange)code);
+          }
+
+          // Nominal ODR in Hz: 2000 ... 31. At 4000 Hz a frame comes
+          // every 279 us, and reading its 12 bytes at 400 kHz takes ~270 us
+          if (!doc["odr"].isNull()) {
+            int odr = doc["odr"];
+            static const int rates[] = {8000, 4000, 2000, 1000, 500,
+                                        250,  125,  62,   31};
+            int code = -1;
+            for (int i = QMI8658C_ODR_2000HZ; i < 9; i++) {
+              if (odr == rates[i]) code = i;
+            }
+            if (code < 0) {
+              request->send(400, "application/json",
+                            "{\"error\":\"Invalid odr\"}");
+              return;
+            }
+            sensorTask->setODR((QMI8658C_ODR)code);
+          }
+
+          if (!doc["autoRange"].isNull()) {
+            sensorTask->setAutoRange(doc["autoRange"]);
+          }
+
+          if (!doc["onChip"].isNull()) {
+            sensorTask->setOnChipDetection(doc["onChip"]);
+          }
+
+          if (!doc["fusion"].isNull()) {
+            sensorTask->setFusion(doc["fusion"]);
+          }
+
+          request->send(200, "application/json", "{\"success\":true}");
+        });
+
+    // API: Calibration progress and active calibration
+    server->on("/api/calibration", HTTP_GET,
+               [this](AsyncWebServerRequest *request) {
+                 StaticJsonDocument<512> doc;
+                 static const char *states[] = {"idle", "ready", "capturing",
+                                                "done", "failed"};
+
+                 if (calibrator) {
+                   doc["state"] = states[calibrator->getState()];
+                   doc["faces"] = calibrator->getCapturedFaces();
+                   doc["faceMask"] = calibrator->getFaceMask();
+                   if (calibrator->getLastError()) {
+                     doc["error"] = calibrator->getLastError();
+                   }
+                 }
+
+                 const IMUCalibration &cal = configMgr->getCalibration();
+                 doc["valid"] = cal.valid;
+                 JsonArray offset = doc.createNestedArray("accelOffset");
+                 JsonArray matrix = doc.createNestedArray("accelMatrix");
+                 JsonArray bias = doc.createNestedArray("gyroBias");
+                 for (int i = 0; i < 3; i++) {
+                   offset.add(cal.accelOffset[i]);
+                   bias.add(cal.gyroBias[i]);
+                   for (int j = 0; j < 3; j++) {
+                     matrix.add(cal.accelMatrix[i][j]);
+                   }
+                 }
+
+                 String response;
+                 serializeJson(doc, response);
+                 request->send(200, "application/json", response);
+               });
+
+    // API: Drive the calibration routine
+    // {"action": "start" | "capture" | "finish" | "cancel" | "clear"}
+    server->on(
+        "/api/calibration", HTTP_POST, [](AsyncWebServerRequest *request) {},
+        NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len,
+               size_t index, size_t total) {
+          StaticJsonDocument<128> doc;
+          DeserializationError error = deserializeJson(doc, data, len);
+
+          if (error || !calibrator) {
+            request->send(400, "application/json",
+                          "{\"error\":\"Invalid JSON\"}");
+            return;
+          }
+
+          const char *action = doc["action"] | "";
+          if (strcmp(action, "start") == 0) {
+            calibrator->start();
+          } else if (strcmp(action, "capture") == 0) {
+            calibrator->capture();
+          } else if (strcmp(action, "finish") == 0) {
+            calibrator->finish();
+          } else if (strcmp(action, "cancel") == 0) {
+            calibrator->cancel();
+          } else if (strcmp(action, "clear") == 0) {
+            calibrator->clear();
+          } else {
+            request->send(400, "application/json",
+                          "{\"error\":\"Invalid action\"}");
+            return;
+          }
+
+          request->send(200, "application/json", "{\"success\":true}");
+        });
+
+    // API: Temperature compensation progress and active model
+    server->on("/api/tempcomp", HTTP_GET, [this](AsyncWebServerRequest *request) {
+      StaticJsonDocument<768> doc;
+      static const char *states[] = {"idle", "learning", "done", "failed"};
+
+      doc["intervalMs"] = configMgr->getTemperatureInterval();
+      if (sensorTask) doc["temperature"] = sensorTask->getTemperature();
+
+      if (tempComp) {
+        doc["state"] = states[tempComp->getState()];
+        if (tempComp->getLastError()) doc["error"] = tempComp->getLastError();
+
+        TempCompFit fit = tempComp->getFit();
+        JsonObject learning = doc.createNestedObject("learning");
+        learning["stillWindows"] = tempComp->getStillWindows();
+        learning["movedWindows"] = tempComp->getMovedWindows();
+        learning["poseChanges"] = tempComp->getPoseChanges();
+        learning["bins"] = fit.bins;
+        learning["minTempC"] = fit.minTempC;
+        learning["maxTempC"] = fit.maxTempC;
+        learning["ready"] = fit.ready;
+        JsonArray residual = learning.createNestedArray("slope");
+        for (int i = 0; i < 3; i++) residual.add(fit.slope[i] * 1000.0f);  // mg/C
+      }
+
+      const IMUTempCompensation &comp = configMgr->getTempCompensation();
+      doc["valid"] = comp.valid;
+      doc["refTempC"] = comp.refTempC;
+      JsonArray slope = doc.createNestedArray("slope");
+      for (int i = 0; i < 3; i++) slope.add(comp.accelSlope[i] * 1000.0f);  // mg/C
+
+      String response;
+      serializeJson(doc, response);
+      request->send(200, "application/json", response);
+    });
+
+    // API: Drive temperature compensation learning / set the read interval
+    // {"action": "start" | "finish" | "cancel" | "clear", "intervalMs": 1000}
+    server->on(
+        "/api/tempcomp", HTTP_POST, [](AsyncWebServerRequest *request) {},
+        NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len,
+               size_t index, size_t total) {
+          StaticJsonDocument<128> doc;
+          DeserializationError error = deserializeJson(doc, data, len);
+
+          if (error) {
+            request->send(400, "application/json",
+                          "{\"error\":\"Invalid JSON\"}");
+            return;
           }
+
+          if (!doc["intervalMs"].isNull()) {
+            int ms = doc["intervalMs"];
+            if (ms < 0 || ms > 60000) {
+              request->send(400, "application/json",
+                            "{\"error\":\"Interval must be 0-60000 ms\"}");
+              return;
+            }
+            configMgr->setTemperatureInterval(ms);
+            configMgr->save();
+            if (sensorTask) sensorTask->setTemperatureInterval(ms);
+          }
+
+          if (!doc["action"].isNull()) {
+            const char *action = doc["action"] | "";
+            if (!tempComp) {
+              request->send(400, "application/json",
+                            "{\"error\":\"Not available\"}");
+              return;
+            }
+            if (strcmp(action, "start") == 0) {
+              tempComp->start();
+            } else if (strcmp(action, "finish") == 0) {
+              tempComp->finish();
+            } else if (strcmp(action, "cancel") == 0) {
+              tempComp->cancel();
+            } else if (strcmp(action, "clear") == 0) {
+              tempComp->clear();
+            } else {
+              request->send(400, "application/json",
+                            "{\"error\":\"Invalid action\"}");
+              return;
+            }
+          }
+
+          request->send(200, "application/json", "{\"success\":true}");
         });
 
     // API: Set WiFi credentials
@@ -762,6 +1332,9 @@ class SlapWebServer {
           }
         });
 
+    // Server-sent events (gestures)
+    server->addHandler(stream);
+
     // Start server
     server->begin();
     Serial.println("Web server started on port 80");
@@ -0,0 +1,120 @@
+/*
+ * I2C backends for AsyncI2C - Implementation
+ */
+
+#include "EspI2C.h"
+
+// Bus-level timeout for one transaction; shorter than the default wait()
+// so a stuck transfer completes (with an error) before its waiter gives up
+#define ESP_I2C_XFER_TIMEOUT_MS 20
+
+EspI2C::EspI2C(i2c_port_t port, int sdaPin, int sclPin, uint32_t frequency)
+    : port(port), sda(sdaPin), scl(sclPin), freq(frequency), worker(nullptr) {
+    mux = portMUX_INITIALIZER_UNLOCKED;
+}
+
+bool EspI2C::begin() {
+    i2c_config_t conf = {};
+    conf.mode = I2C_MODE_MASTER;
+    conf.sda_io_num = sda;
+    conf.scl_io_num = scl;
+    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.master.clk_speed = freq;
+
+    if (i2c_param_config(port, &conf) != ESP_OK ||
+        i2c_driver_install(port, I2C_MODE_MASTER, 0, 0, 0) != ESP_OK) {
+        Serial.println("EspI2C: Driver install failed");
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(workerEntry, "i2c", ESP_I2C_TASK_STACK, this,
+                                ESP_I2C_TASK_PRIORITY, &worker,
+                                ESP_I2C_TASK_CORE) != pdPASS) {
+        Serial.println("EspI2C: Failed to create worker task");
+        i2c_driver_delete(port);
+        return false;
+    }
+
+    Serial.printf("EspI2C: Port %d on SDA=%d SCL=%d @ %lu Hz\n",
+                  (int)port, sda, scl, (unsigned long)freq);
+    return true;
+}
+
+void EspI2C::workerEntry(void *param) {
+    EspI2C *self = static_cast<EspI2C *>(param);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->process();
+    }
+}
+
+void EspI2C::notifyWorker() {
+    if (worker != nullptr) {
+        xTaskNotifyGive(worker);
+    }
+}
+
+void *EspI2C::createSignal() {
+    return xSemaphoreCreateBinary();
+}
+
+void EspI2C::signalDone(void *signal) {
+    if (signal != nullptr) {
+        xSemaphoreGive((SemaphoreHandle_t)signal);
+    }
+}
+
+bool EspI2C::wait(I2CTransaction *txn, uint32_t timeoutMs) {
+    TickType_t start = xTaskGetTickCount();
+    TickType_t limit = pdMS_TO_TICKS(timeoutMs);
+
+    while (!txn->done()) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= limit) return false;
+
+        // A give may belong to an earlier transaction on the same signal;
+        // the loop re-checks done() either way
+        if (txn->signal != nullptr) {
+            xSemaphoreTake((SemaphoreHandle_t)txn->signal, limit - elapsed);
+        } else {
+            vTaskDelay(1);
+        }
+    }
+    return true;
+}
+
+int8_t EspI2C::transfer(I2CTransaction &txn) {
+    TickType_t timeout = pdMS_TO_TICKS(ESP_I2C_XFER_TIMEOUT_MS);
+    esp_err_t err;
+
+    if (txn.read) {
+        err = i2c_master_write_read_device(port, txn.addr, &txn.reg, 1,
+                                           txn.data, txn.len, timeout);
+    } else {
+        if (txn.len > ESP_I2C_MAX_WRITE) return I2C_ERROR;
+        txBuf[0] = txn.reg;
+        memcpy(&txBuf[1], txn.data, txn.len);
+        err = i2c_master_write_to_device(port, txn.addr, txBuf, txn.len + 1, timeout);
+    }
+
+    if (err == ESP_OK) return I2C_OK;
+    return err == ESP_ERR_TIMEOUT ? I2C_TIMEOUT : I2C_ERROR;
+}
+
+int8_t WireI2C::transfer(I2CTransaction &txn) {
+    _wire->beginTransmission(txn.addr);
+    _wire->write(txn.reg);
+
+    if (!txn.read) {
+        _wire->write(txn.data, txn.len);
+        return _wire->endTransmission() == 0 ? I2C_OK : I2C_ERROR;
+    }
+
+    if (_wire->endTransmission(false) != 0) return I2C_ERROR;
+    if (_wire->requestFrom(txn.addr, (uint8_t)txn.len) != txn.len) return I2C_ERROR;
+    for (uint16_t i = 0; i < txn.len; i++) {
+        txn.data[i] = _wire->read();
+    }
+    return I2C_OK;
+}
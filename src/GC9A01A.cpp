@@ -3,20 +3,69 @@
  */
 
 #include "GC9A01A.h"
+#include <soc/gpio_struct.h>
+
+// Init sequence: command, parameter count (| INIT_DELAY: a delay in ms
+// follows the parameters), parameters
+#define INIT_DELAY 0x80
+
+static const uint8_t initSequence[] = {
+    0xEF, 0,
+    0xEB, 1, 0x14,
+    0xFE, 0,
+    0xEF, 0,
+    0xEB, 1, 0x14,
+    0x84, 1, 0x40,
+    0x85, 1, 0xFF,
+    0x86, 1, 0xFF,
+    0x87, 1, 0xFF,
+    0x88, 1, 0x0A,
+    0x89, 1, 0x21,
+    0x8A, 1, 0x00,
+    0x8B, 1, 0x80,
+    0x8C, 1, 0x01,
+    0x8D, 1, 0x01,
+    0x8E, 1, 0xFF,
+    0x8F, 1, 0xFF,
+    0xB6, 2, 0x00, 0x00,
+    GC9A01A_MADCTL, 1, 0x68,            // Changed from 0x48 to 0x68 to fix mirroring
+    GC9A01A_COLMOD, 1, 0x05,            // 16-bit color
+    GC9A01A_SLPOUT, INIT_DELAY, 120,
+    GC9A01A_INVON, INIT_DELAY, 10,      // Display Inversion ON - fixes inverted colors
+    GC9A01A_DISPON, INIT_DELAY, 20,
+};
 
 GC9A01A::GC9A01A(int8_t cs, int8_t dc, int8_t rst) 
-    : Adafruit_GFX(128, 128), _cs(cs), _dc(dc), _rst(rst) {
+    : Adafruit_GFX(128, 128), _cs(cs), _dc(dc), _rst(rst), _writeDepth(0),
+      _freq(0), _csSet(nullptr), _csClear(nullptr), _csMask(0), _dcSet(nullptr),
+      _dcClear(nullptr), _dcMask(0) {
     _spi = &SPI;
 }
 
+void GC9A01A::gpioRegisters(int8_t pin, volatile uint32_t *&set, volatile uint32_t *&clear,
+                            uint32_t &mask) {
+    if (pin < 32) {
+        set = &GPIO.out_w1ts;
+        clear = &GPIO.out_w1tc;
+        mask = 1UL << pin;
+    } else {
+        set = &GPIO.out1_w1ts.val;
+        clear = &GPIO.out1_w1tc.val;
+        mask = 1UL << (pin - 32);
+    }
+}
+
 void GC9A01A::begin(uint32_t freq) {
     pinMode(_cs, OUTPUT);
     pinMode(_dc, OUTPUT);
     pinMode(_rst, OUTPUT);
-    
     digitalWrite(_cs, HIGH);
     digitalWrite(_dc, HIGH);
     
+    // CS and DC through the GPIO set / clear registers
+    gpioRegisters(_cs, _csSet, _csClear, _csMask);
+    gpioRegisters(_dc, _dcSet, _dcClear, _dcMask);
+    
     // Reset display
     digitalWrite(_rst, HIGH);
     delay(10);
@@ -25,87 +74,92 @@ void GC9A01A::begin(uint32_t freq) {
     digitalWrite(_rst, HIGH);
     delay(120);
     
-    // Initialize SPI
-    _spi->begin(40, -1, 38, _cs);  // SCK, MISO, MOSI, CS
-    _spi->beginTransaction(SPISettings(freq, MSBFIRST, SPI_MODE0));
-    
-    // Init sequence
-    writeCommand(0xEF);
-    writeCommand(0xEB); writeData(0x14);
-    
-    writeCommand(0xFE); writeCommand(0xEF);
-    writeCommand(0xEB); writeData(0x14);
-    writeCommand(0x84); writeData(0x40);
-    writeCommand(0x85); writeData(0xFF);
-    writeCommand(0x86); writeData(0xFF);
-    writeCommand(0x87); writeData(0xFF);
-    writeCommand(0x88); writeData(0x0A);
-    writeCommand(0x89); writeData(0x21);
-    writeCommand(0x8A); writeData(0x00);
-    writeCommand(0x8B); writeData(0x80);
-    writeCommand(0x8C); writeData(0x01);
-    writeCommand(0x8D); writeData(0x01);
-    writeCommand(0x8E); writeData(0xFF);
-    writeCommand(0x8F); writeData(0xFF);
-    
-    writeCommand(0xB6); writeData(0x00); writeData(0x00);
-    
-    writeCommand(GC9A01A_MADCTL); writeData(0x68);  // Changed from 0x48 to 0x68 to fix mirroring
-    writeCommand(GC9A01A_COLMOD); writeData(0x05);  // 16-bit color
-    
-    writeCommand(GC9A01A_SLPOUT);
-    delay(120);
-    
-    writeCommand(0x21);  // Display Inversion ON - fixes inverted colors
-    delay(10);
-    
-    writeCommand(GC9A01A_DISPON);
-    delay(20);
-    
-    _spi->endTransaction();
+    // Initialize SPI; CS stays ours, so it can span many transfers
+    _spi->begin(40, -1, 38, -1);  // SCK, MISO, MOSI, no CS
+    setFrequency(freq);
+    
+    startWrite();
+    const uint8_t *p = initSequence;
+    while (p < initSequence + sizeof(initSequence)) {
+        uint8_t cmd = *p++;
+        uint8_t count = *p++;
+        uint8_t len = count & ~INIT_DELAY;
+        writeCommand(cmd, p, len);
+        p += len;
+        if (count & INIT_DELAY) delay(*p++);
+    }
+    endWrite();
 }
 
-void GC9A01A::writeCommand(uint8_t cmd) {
-    digitalWrite(_dc, LOW);
-    digitalWrite(_cs, LOW);
-    _spi->transfer(cmd);
-    digitalWrite(_cs, HIGH);
+void GC9A01A::setFrequency(uint32_t freq) {
+    _freq = freq < GC9A01A_MAX_FREQ ? freq : GC9A01A_MAX_FREQ;
+    _settings = SPISettings(_freq, MSBFIRST, SPI_MODE0);
 }
 
-void GC9A01A::writeData(uint8_t data) {
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-    _spi->transfer(data);
-    digitalWrite(_cs, HIGH);
+void GC9A01A::startWrite(void) {
+    if (_writeDepth++ == 0) {
+        _spi->beginTransaction(_settings);
+        *_csClear = _csMask;
+    }
+}
+
+void GC9A01A::endWrite(void) {
+    if (_writeDepth > 0 && --_writeDepth == 0) {
+        *_csSet = _csMask;
+        _spi->endTransaction();
+    }
+}
+
+void GC9A01A::writeCommand(uint8_t cmd, const uint8_t *params, uint8_t len) {
+    *_dcClear = _dcMask;
+    _spi->write(cmd);
+    *_dcSet = _dcMask;
+    if (len) _spi->writeBytes(params, len);
 }
 
 void GC9A01A::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
     uint16_t x2 = x + w - 1;
     uint16_t y2 = y + h - 1;
+    uint8_t cols[4] = {(uint8_t)(x >> 8), (uint8_t)x, (uint8_t)(x2 >> 8), (uint8_t)x2};
+    uint8_t rows[4] = {(uint8_t)(y >> 8), (uint8_t)y, (uint8_t)(y2 >> 8), (uint8_t)y2};
     
-    writeCommand(GC9A01A_CASET);
-    writeData(x >> 8); writeData(x & 0xFF);
-    writeData(x2 >> 8); writeData(x2 & 0xFF);
-    
-    writeCommand(GC9A01A_RASET);
-    writeData(y >> 8); writeData(y & 0xFF);
-    writeData(y2 >> 8); writeData(y2 & 0xFF);
-    
+    writeCommand(GC9A01A_CASET, cols, 4);
+    writeCommand(GC9A01A_RASET, rows, 4);
     writeCommand(GC9A01A_RAMWR);
 }
 
-void GC9A01A::drawPixel(int16_t x, int16_t y, uint16_t color) {
+bool GC9A01A::clipRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if ((x + w) > _width)  w = _width  - x;
+    if ((y + h) > _height) h = _height - y;
+    return (w > 0) && (h > 0);
+}
+
+void GC9A01A::writePixel(int16_t x, int16_t y, uint16_t color) {
     if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) return;
-    
-    _spi->beginTransaction(SPISettings(27000000, MSBFIRST, SPI_MODE0));
     setAddrWindow(x, y, 1, 1);
-    
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-    _spi->transfer16(color);
-    digitalWrite(_cs, HIGH);
-    
-    _spi->endTransaction();
+    _spi->write16(color);
+}
+
+void GC9A01A::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (!clipRect(x, y, w, h)) return;
+    setAddrWindow(x, y, w, h);
+    writeColor(color, (uint32_t)w * h);
+}
+
+void GC9A01A::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    writeFillRect(x, y, w, 1, color);
+}
+
+void GC9A01A::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    writeFillRect(x, y, 1, h, color);
+}
+
+void GC9A01A::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    startWrite();
+    writePixel(x, y, color);
+    endWrite();
 }
 
 void GC9A01A::fillScreen(uint16_t color) {
@@ -113,34 +167,84 @@ void GC9A01A::fillScreen(uint16_t color) {
 }
 
 void GC9A01A::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-    if ((x >= _width) || (y >= _height)) return;
-    if ((x + w - 1) >= _width)  w = _width  - x;
-    if ((y + h - 1) >= _height) h = _height - y;
-    
-    _spi->beginTransaction(SPISettings(27000000, MSBFIRST, SPI_MODE0));
+    startWrite();
+    writeFillRect(x, y, w, h, color);
+    endWrite();
+}
+
+void GC9A01A::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    startWrite();
+    writeFillRect(x, y, w, 1, color);
+    endWrite();
+}
+
+void GC9A01A::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    startWrite();
+    writeFillRect(x, y, 1, h, color);
+    endWrite();
+}
+
+void GC9A01A::pushPixels(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels,
+                         int16_t stride) {
+    if (stride <= 0) stride = w;
+    int16_t x0 = x, y0 = y;
+    if (!clipRect(x, y, w, h)) return;
+    pixels += (int32_t)(y - y0) * stride + (x - x0);
+    
+    startWrite();
     setAddrWindow(x, y, w, h);
-    
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-    
-    for (uint32_t i = 0; i < (uint32_t)w * h; i++) {
-        _spi->transfer16(color);
+    if (w == stride) {
+        writePixels(pixels, (uint32_t)w * h);
+    } else {
+        // Clipped or part of a wider image: one row at a time
+        for (int16_t row = 0; row < h; row++) {
+            writePixels(pixels + (int32_t)row * stride, w);
+        }
     }
-    
-    digitalWrite(_cs, HIGH);
-    _spi->endTransaction();
+    endWrite();
 }
 
-void GC9A01A::setRotation(uint8_t r) {
-    rotation = r % 4;
-    _spi->beginTransaction(SPISettings(27000000, MSBFIRST, SPI_MODE0));
-    writeCommand(GC9A01A_MADCTL);
-    switch (rotation) {
-        case 0: writeData(0x68); break;  // Fixed mirroring
-        case 1: writeData(0xC8); break;
-        case 2: writeData(0xA8); break;
-        case 3: writeData(0x08); break;
+void GC9A01A::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h) {
+    pushPixels(x, y, w, h, bitmap);
+}
+
+void GC9A01A::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
+    pushPixels(x, y, w, h, bitmap);
+}
+
+void GC9A01A::writeColor(uint16_t color, uint32_t len) {
+    uint16_t swapped = (color >> 8) | (color << 8);
+    uint32_t fill = len < GC9A01A_LINE_PIXELS ? len : GC9A01A_LINE_PIXELS;
+    for (uint32_t i = 0; i < fill; i++) _line[i] = swapped;
+    
+    while (len > 0) {
+        uint32_t n = len < GC9A01A_LINE_PIXELS ? len : GC9A01A_LINE_PIXELS;
+        _spi->writeBytes((const uint8_t *)_line, n * 2);
+        len -= n;
+    }
+}
+
+void GC9A01A::writePixels(const uint16_t *pixels, uint32_t len) {
+    while (len > 0) {
+        uint32_t n = len < GC9A01A_LINE_PIXELS ? len : GC9A01A_LINE_PIXELS;
+        for (uint32_t i = 0; i < n; i++) {
+            _line[i] = (pixels[i] >> 8) | (pixels[i] << 8);
+        }
+        _spi->writeBytes((const uint8_t *)_line, n * 2);
+        pixels += n;
+        len -= n;
     }
-    _spi->endTransaction();
 }
 
+void GC9A01A::setRotation(uint8_t r) {
+    static const uint8_t madctl[] = {
+        0x68,   // Fixed mirroring
+        0xC8,
+        0xA8,
+        0x08,
+    };
+    rotation = r % 4;
+    startWrite();
+    writeCommand(GC9A01A_MADCTL, &madctl[rotation], 1);
+    endWrite();
+}
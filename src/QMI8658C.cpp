@@ -4,14 +4,49 @@
 
 #include "QMI8658C.h"
 
+// 6DOF sample period per ODR setting, in microseconds
+static const uint32_t ODR_PERIOD_US[] = {
+    139, 279, 558, 1115, 2230, 4460, 8921, 17841, 35682
+};
+
 QMI8658C::QMI8658C() {
-    _wire = nullptr;
+    _bus = nullptr;
+    _wireBus = nullptr;
+    _signal = nullptr;
     _addr = QMI8658C_I2C_ADDR;
+    memset(&data, 0, sizeof(data));
+    memset(&rawData, 0, sizeof(rawData));
+    lastBusTimeUs = 0;
+    fifoEnabled = false;
+    fifoCtrl = 0;
+    fifoOverflows = 0;
+    lastFifoTimestampUs = 0;
+    fifoWatermark = 0;
+    ctrl1 = QMI8658C_CTRL1_ADDR_AI;
+    intPin = -1;
+    intSource = QMI8658C_INT_DATA_READY;
+    notifyTask = nullptr;
+    irqTimestampUs = 0;
+    irqLatencyUs = 0;
+    ctrl8 = 0;
+    motionIntPin = -1;
+    motionIrqTimestampUs = 0;
+    identityCalibration(calibration);
+    memset(&tempComp, 0, sizeof(tempComp));
 }
 
 bool QMI8658C::begin(TwoWire &wire, uint8_t addr) {
-    _wire = &wire;
+    delete _wireBus;
+    _wireBus = new WireI2C(wire);
+    return begin(*_wireBus, addr);
+}
+
+bool QMI8658C::begin(AsyncI2C &bus, uint8_t addr) {
+    _bus = &bus;
     _addr = addr;
+    if (_signal == nullptr) {
+        _signal = bus.createSignal();
+    }
     
     // Check WHO_AM_I
     uint8_t chipId = readRegister(QMI8658C_WHO_AM_I);
@@ -26,20 +61,25 @@ bool QMI8658C::begin(TwoWire &wire, uint8_t addr) {
     delay(10);
     
     // CTRL1: Serial Interface and Sensor Enable
-    writeRegister(QMI8658C_CTRL1, 0x40); // Enable sensors
+    // Bit 6 (ADDR_AI) enables register address auto-increment, which the
+    // burst read in readRaw() relies on
+    writeRegister(QMI8658C_CTRL1, ctrl1);
     delay(10);
     
-    // CTRL2: Accelerometer settings
-    // ODR = 250Hz, Range = ±2g
-    writeRegister(QMI8658C_CTRL2, 0x15);
+    // CTRL2: Accelerometer settings (defaults: ODR = 250Hz, Range = ±2g)
+    writeCtrl2();
     
-    // CTRL3: Gyroscope settings
-    // ODR = 250Hz, Range = ±250dps
-    writeRegister(QMI8658C_CTRL3, 0x55);
+    // CTRL3: Gyroscope settings (defaults: ODR = 250Hz, Range = ±256dps)
+    writeCtrl3();
     
     // CTRL7: Enable accelerometer and gyroscope
     writeRegister(QMI8658C_CTRL7, 0x03);
     
+    // CTRL8: Report CTRL9 command completion in STATUSINT (polled by
+    // sendCommand) so INT1 stays free for the motion engines
+    ctrl8 = QMI8658C_CTRL8_HS_STATUSINT;
+    writeRegister(QMI8658C_CTRL8, ctrl8);
+    
     delay(100); // Wait for sensor to stabilize
     
     Serial.println("QMI8658C: Initialized successfully!");
@@ -47,56 +87,725 @@ bool QMI8658C::begin(TwoWire &wire, uint8_t addr) {
 }
 
 bool QMI8658C::isConnected() {
-    if (_wire == nullptr) return false;
+    if (_bus == nullptr) return false;
     uint8_t chipId = readRegister(QMI8658C_WHO_AM_I);
     return (chipId == QMI8658C_CHIP_ID);
 }
 
 void QMI8658C::update() {
-    if (_wire == nullptr) return;
+    if (_bus == nullptr) return;
     
-    // Read accelerometer data
-    int16_t ax = readInt16(QMI8658C_AX_L);
-    int16_t ay = readInt16(QMI8658C_AY_L);
-    int16_t az = readInt16(QMI8658C_AZ_L);
+    if (!readRaw(rawData)) return;
     
-    // Read gyroscope data
-    int16_t gx = readInt16(QMI8658C_GX_L);
-    int16_t gy = readInt16(QMI8658C_GY_L);
-    int16_t gz = readInt16(QMI8658C_GZ_L);
+    int peak = max(max(abs(rawData.accelX), abs(rawData.accelY)), abs(rawData.accelZ));
     
-    // Read temperature
-    int16_t temp = readInt16(QMI8658C_TEMP_L);
+    // rawData stays as read; calibrate a copy
+    IMURawData cal = rawData;
+    applyCalibration(cal);
     
     // Convert to physical units
-    data.accelX = ax * accelScale;
-    data.accelY = ay * accelScale;
-    data.accelZ = az * accelScale;
+    data.accelX = cal.accelX * accelScale;
+    data.accelY = cal.accelY * accelScale;
+    data.accelZ = cal.accelZ * accelScale;
+    
+    data.gyroX = cal.gyroX * gyroScale;
+    data.gyroY = cal.gyroY * gyroScale;
+    data.gyroZ = cal.gyroZ * gyroScale;
+    
+    updateAutoRange(peak, 1);
+}
+
+bool QMI8658C::readRaw(IMURawData &raw) {
+    if (_bus == nullptr) return false;
+    
+    // One burst read instead of single-byte reads: TEMP_L..GZ_H when the
+    // temperature is due, AX_L..GZ_H otherwise
+    bool withTemp = temperatureDue();
+    uint8_t buf[QMI8658C_SAMPLE_BYTES];
+    uint32_t start = micros();
+    bool ok = withTemp ? readRegisters(QMI8658C_TEMP_L, buf, QMI8658C_SAMPLE_BYTES)
+                       : readRegisters(QMI8658C_AX_L, buf + 2, QMI8658C_MOTION_BYTES);
+    lastBusTimeUs = micros() - start;
+    if (!ok) return false;
+    
+    if (withTemp) {
+        setTemperature((int16_t)((buf[1] << 8) | buf[0]));
+    }
+    raw.temperature = rawData.temperature;
+    raw.accelX = (int16_t)((buf[3] << 8) | buf[2]);
+    raw.accelY = (int16_t)((buf[5] << 8) | buf[4]);
+    raw.accelZ = (int16_t)((buf[7] << 8) | buf[6]);
+    raw.gyroX = (int16_t)((buf[9] << 8) | buf[8]);
+    raw.gyroY = (int16_t)((buf[11] << 8) | buf[10]);
+    raw.gyroZ = (int16_t)((buf[13] << 8) | buf[12]);
+    return true;
+}
+
+bool QMI8658C::temperatureDue() {
+    uint32_t now = millis();
+    if (temperatureReads > 0 && tempIntervalMs > 0 && now - lastTempMs < tempIntervalMs) {
+        return false;
+    }
+    lastTempMs = now;
+    return true;
+}
+
+bool QMI8658C::readTemperature() {
+    if (_bus == nullptr) return false;
     
-    data.gyroX = gx * gyroScale;
-    data.gyroY = gy * gyroScale;
-    data.gyroZ = gz * gyroScale;
+    uint8_t buf[2];
+    if (!readRegisters(QMI8658C_TEMP_L, buf, sizeof(buf))) return false;
+    setTemperature((int16_t)((buf[1] << 8) | buf[0]));
+    return true;
+}
+
+void QMI8658C::setTemperature(int16_t raw) {
+    rawData.temperature = raw;
+    data.temperature = raw / 256.0f;
+    temperatureReads++;
     
-    data.temperature = temp / 256.0;  // Temperature conversion
+    // The bias correction follows the temperature
+    if (tempComp.valid) {
+        updateCalibrationTransform();
+    }
 }
 
 IMUData QMI8658C::getData() {
     return data;
 }
 
+bool QMI8658C::setAccelRange(QMI8658C_AccelRange range) {
+    QMI8658C_AccelRange previous = accelRange;
+    accelRange = range;
+    accelScale = accelScaleFor(range);
+    quietSamples = 0;
+    updateCalibrationTransform();
+    if (_bus == nullptr) return false;
+    writeCtrl2();
+    
+    // Frames already buffered were taken at the old range: remember how
+    // many, so readFifo() tags them with it (to within the frame being
+    // sampled at the switch)
+    if (fifoEnabled && previous != range) {
+        markRangeSwitch(previous);
+    }
+    return true;
+}
+
+void QMI8658C::markRangeSwitch(QMI8658C_AccelRange previous) {
+    uint16_t frames = getFifoCount();
+    if (frames == 0) return;
+    
+    // No new frames since the last switch: the previous range has none
+    if (rangeMarkCount > 0 && rangeMarks[rangeMarkCount - 1].frames == frames) return;
+    
+    if (rangeMarkCount == QMI8658C_RANGE_MARKS) {
+        // Out of marks: the oldest segment takes the next one's range
+        memmove(rangeMarks, rangeMarks + 1, (QMI8658C_RANGE_MARKS - 1) * sizeof(RangeMark));
+        rangeMarkCount--;
+    }
+    rangeMarks[rangeMarkCount].frames = frames;
+    rangeMarks[rangeMarkCount].range = previous;
+    rangeMarkCount++;
+}
+
+bool QMI8658C::setGyroRange(QMI8658C_GyroRange range) {
+    gyroRange = range;
+    gyroScale = gyroScaleFor(range);
+    updateCalibrationTransform();
+    if (_bus == nullptr) return false;
+    writeCtrl3();
+    return true;
+}
+
+bool QMI8658C::setODR(QMI8658C_ODR rate) {
+    odr = rate;
+    samplePeriodUs = ODR_PERIOD_US[rate];
+    if (_bus == nullptr) return false;
+    
+    writeCtrl2();
+    writeCtrl3();
+    
+    // Frames already buffered were taken at the old rate
+    if (fifoEnabled) {
+        return enableFifo(fifoWatermark, (QMI8658C_FifoSize)((fifoCtrl >> 2) & 0x03));
+    }
+    return true;
+}
+
+void QMI8658C::setAutoRange(bool enabled, QMI8658C_AccelRange base) {
+    autoRange = enabled;
+    autoRangeBase = base;
+    quietSamples = 0;
+    if (enabled && accelRange < base) {
+        setAccelRange(base);
+    }
+}
+
+void QMI8658C::updateAutoRange(int peak, size_t samples) {
+    if (!autoRange) return;
+    
+    // Near saturation: straight to ±16g, the rest of the impact must not
+    // clip again on the way up
+    if (peak >= QMI8658C_AUTORANGE_HIGH && accelRange < QMI8658C_ACCEL_16G) {
+        setAccelRange(QMI8658C_ACCEL_16G);
+        rangeSwitches++;
+        return;
+    }
+    
+    // Quiet for a full second: step back down towards the base range
+    if (peak < QMI8658C_AUTORANGE_LOW && accelRange > autoRangeBase) {
+        quietSamples += samples;
+        if (quietSamples * samplePeriodUs >= 1000000) {
+            setAccelRange((QMI8658C_AccelRange)(accelRange - 1));
+            rangeSwitches++;
+        }
+    } else {
+        quietSamples = 0;
+    }
+}
+
+void QMI8658C::identityCalibration(IMUCalibration &cal) {
+    memset(&cal, 0, sizeof(cal));
+    for (int i = 0; i < 3; i++) {
+        cal.accelMatrix[i][i] = 1.0f;
+    }
+}
+
+void QMI8658C::setCalibration(const IMUCalibration &cal) {
+    calibration = cal;
+    updateCalibrationTransform();
+}
+
+void QMI8658C::clearCalibration() {
+    identityCalibration(calibration);
+    updateCalibrationTransform();
+}
+
+void QMI8658C::setTempCompensation(const IMUTempCompensation &comp) {
+    tempComp = comp;
+    updateCalibrationTransform();
+}
+
+void QMI8658C::clearTempCompensation() {
+    memset(&tempComp, 0, sizeof(tempComp));
+    updateCalibrationTransform();
+}
+
+void QMI8658C::updateCalibrationTransform() {
+    calEnabled = calibration.valid || tempComp.valid;
+    if (!calEnabled) return;
+    
+    IMUCalibration cal = calibration;
+    if (!cal.valid) identityCalibration(cal);
+    
+    // Bias drift at the last temperature read (none before the first)
+    float drift[3] = {0, 0, 0};
+    if (tempComp.valid && temperatureReads > 0) {
+        for (int i = 0; i < 3; i++) {
+            drift[i] = tempComp.accelSlope[i] * (data.temperature - tempComp.refTempC);
+        }
+    }
+    
+    // Raw counts stay in counts: the matrix is unitless, offsets are
+    // converted at the current scale
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            calMatrix[i][j] = (int32_t)lroundf(cal.accelMatrix[i][j] * 16384.0f);
+        }
+        calAccelOffset[i] = (int32_t)lroundf((cal.accelOffset[i] - drift[i]) / accelScale);
+        calGyroOffset[i] = (int32_t)lroundf(cal.gyroBias[i] / gyroScale);
+    }
+}
+
+static inline int16_t saturate16(int32_t v) {
+    return v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+}
+
+template <typename T>
+void QMI8658C::applyCalibration(T &s, int rangeShift) {
+    if (!calEnabled) return;
+    
+    // Offsets are counts at the current range; a sample taken rangeShift
+    // range steps below it (above, if negative) counts 2^rangeShift finer
+    int32_t off[3];
+    for (int i = 0; i < 3; i++) {
+        off[i] = rangeShift >= 0 ? calAccelOffset[i] * (1 << rangeShift)
+                                 : calAccelOffset[i] / (1 << -rangeShift);
+    }
+    
+    int32_t ax = s.accelX, ay = s.accelY, az = s.accelZ;
+    s.accelX = saturate16(((calMatrix[0][0] * ax + calMatrix[0][1] * ay +
+                            calMatrix[0][2] * az + 8192) >> 14) + off[0]);
+    s.accelY = saturate16(((calMatrix[1][0] * ax + calMatrix[1][1] * ay +
+                            calMatrix[1][2] * az + 8192) >> 14) + off[1]);
+    s.accelZ = saturate16(((calMatrix[2][0] * ax + calMatrix[2][1] * ay +
+                            calMatrix[2][2] * az + 8192) >> 14) + off[2]);
+    
+    s.gyroX = saturate16(s.gyroX - calGyroOffset[0]);
+    s.gyroY = saturate16(s.gyroY - calGyroOffset[1]);
+    s.gyroZ = saturate16(s.gyroZ - calGyroOffset[2]);
+}
+
+IMUData QMI8658C::toIMUData(const IMUSample &sample) {
+    // Samples carry the range they were taken at (auto-ranging may have
+    // switched since)
+    float scale = accelScaleFor(sample.accelRange);
+    
+    IMUData out;
+    out.accelX = sample.accelX * scale;
+    out.accelY = sample.accelY * scale;
+    out.accelZ = sample.accelZ * scale;
+    out.gyroX = sample.gyroX * gyroScale;
+    out.gyroY = sample.gyroY * gyroScale;
+    out.gyroZ = sample.gyroZ * gyroScale;
+    out.temperature = data.temperature;
+    return out;
+}
+
+bool QMI8658C::enableFifo(uint8_t watermark, QMI8658C_FifoSize size) {
+    if (_bus == nullptr) return false;
+    
+    // FIFO must be configured with the sensors disabled
+    writeRegister(QMI8658C_CTRL7, 0x00);
+    
+    // Watermark is counted in samples (one accel + gyro frame each)
+    writeRegister(QMI8658C_FIFO_WTM_TH, watermark);
+    fifoWatermark = watermark;
+    
+    // Stream mode: the oldest frames are overwritten when the FIFO is full
+    fifoCtrl = (size << 2) | QMI8658C_FIFO_MODE_STREAM;
+    writeRegister(QMI8658C_FIFO_CTRL, fifoCtrl);
+    
+    bool ok = sendCommand(QMI8658C_CMD_RST_FIFO);
+    
+    // With the FIFO active, DRDY is not needed on INT2
+    writeRegister(QMI8658C_CTRL7, 0x03 | QMI8658C_CTRL7_DRDY_DIS);
+    
+    fifoEnabled = ok;
+    lastFifoTimestampUs = 0;
+    rangeMarkCount = 0;
+    
+    if (!ok) {
+        Serial.println("QMI8658C: FIFO reset command timed out");
+    }
+    return ok;
+}
+
+bool QMI8658C::resetFifo() {
+    if (!fifoEnabled) return false;
+    lastFifoTimestampUs = 0;
+    rangeMarkCount = 0;
+    return sendCommand(QMI8658C_CMD_RST_FIFO);
+}
+
+void QMI8658C::disableFifo() {
+    if (_bus == nullptr) return;
+    fifoCtrl = 0;
+    writeRegister(QMI8658C_FIFO_CTRL, 0x00);  // Bypass mode
+    writeRegister(QMI8658C_CTRL7, 0x03);
+    fifoEnabled = false;
+}
+
+uint16_t QMI8658C::getFifoCount() {
+    if (!fifoEnabled) return 0;
+    
+    // FIFO_SMPL_CNT and FIFO_STATUS are adjacent: one burst read for both
+    uint8_t buf[2];
+    if (!readRegisters(QMI8658C_FIFO_SMPL_CNT, buf, sizeof(buf))) return 0;
+    
+    if (buf[1] & QMI8658C_FIFO_OVFLOW) {
+        fifoOverflows++;
+    }
+    
+    // Count is in 16-bit words, split over FIFO_STATUS[1:0] and FIFO_SMPL_CNT
+    uint16_t words = ((buf[1] & 0x03) << 8) | buf[0];
+    return (words * 2) / QMI8658C_FIFO_FRAME_BYTES;
+}
+
+size_t QMI8658C::readFifo(IMUSample *out, size_t maxSamples) {
+    if (!fifoEnabled || maxSamples == 0) return 0;
+    
+    size_t count = getFifoCount();
+    if (count == 0) return 0;
+    if (count > maxSamples) count = maxSamples;
+    
+    uint32_t now = micros();
+    bool irqDriven = (intPin >= 0 && intSource == QMI8658C_INT_FIFO_WATERMARK &&
+                      irqTimestampUs != 0);
+    if (irqDriven) {
+        irqLatencyUs = now - irqTimestampUs;
+    }
+    
+    // Enter FIFO read mode
+    if (!sendCommand(QMI8658C_CMD_REQ_FIFO)) return 0;
+    
+    // Drain in chunks that fit the Wire receive buffer, double buffered:
+    // chunk k+1 is on the bus while chunk k is decoded
+    const size_t framesPerChunk = FIFO_CHUNK_BYTES / QMI8658C_FIFO_FRAME_BYTES;
+    const size_t chunks = (count + framesPerChunk - 1) / framesPerChunk;
+    size_t done = 0;
+    int peak = 0;
+    size_t current = 0;     // frames at the current range
+    uint8_t mark = 0;
+    
+    uint32_t start = micros();
+    size_t queued = 0;
+    while (queued < chunks && queued < 2 && submitFifoChunk(queued, count)) {
+        queued++;
+    }
+    for (size_t k = 0; k < queued; k++) {
+        I2CTransaction &txn = fifoTxn[k & 1];
+        if (!_bus->wait(&txn, 50) || !txn.ok()) break;
+        
+        size_t frames = txn.len / QMI8658C_FIFO_FRAME_BYTES;
+        for (size_t i = 0; i < frames; i++) {
+            const uint8_t *f = &fifoBuf[k & 1][i * QMI8658C_FIFO_FRAME_BYTES];
+            IMUSample &s = out[done + i];
+            s.accelX = (int16_t)((f[1] << 8) | f[0]);
+            s.accelY = (int16_t)((f[3] << 8) | f[2]);
+            s.accelZ = (int16_t)((f[5] << 8) | f[4]);
+            s.gyroX = (int16_t)((f[7] << 8) | f[6]);
+            s.gyroY = (int16_t)((f[9] << 8) | f[8]);
+            s.gyroZ = (int16_t)((f[11] << 8) | f[10]);
+            
+            // Frames buffered before a range switch keep their range
+            while (mark < rangeMarkCount && done + i >= rangeMarks[mark].frames) mark++;
+            if (mark < rangeMarkCount) {
+                s.accelRange = rangeMarks[mark].range;
+            } else {
+                s.accelRange = accelRange;
+                peak = max(peak, max(max(abs(s.accelX), abs(s.accelY)), abs(s.accelZ)));
+                current++;
+            }
+            applyCalibration(s, (int)accelRange - (int)s.accelRange);
+        }
+        done += frames;
+        
+        // This buffer is free again: queue the chunk after next into it
+        if (queued < chunks && submitFifoChunk(queued, count)) {
+            queued++;
+        }
+    }
+    
+    // After an error, let a chunk still in flight finish before its
+    // buffer is reused
+    _bus->wait(&fifoTxn[0], 50);
+    _bus->wait(&fifoTxn[1], 50);
+    lastBusTimeUs = micros() - start;
+    
+    // Leave FIFO read mode
+    writeRegister(QMI8658C_FIFO_CTRL, fifoCtrl);
+    
+    // FIFO frames carry no temperature: read it separately when due
+    if (temperatureDue()) {
+        readTemperature();
+    }
+    
+    if (done == 0) return 0;
+    
+    // Timestamps: when interrupt-driven, the watermark frame was sampled at
+    // the interrupt; otherwise the newest frame was sampled just before the
+    // drain. Keep batches contiguous unless the estimate has drifted by more
+    // than a sample period (e.g. after an overflow).
+    uint32_t first = now - (done - 1) * samplePeriodUs;
+    if (irqDriven && fifoWatermark > 0 && done >= fifoWatermark) {
+        first = irqTimestampUs - (fifoWatermark - 1) * samplePeriodUs;
+    }
+    if (lastFifoTimestampUs != 0) {
+        uint32_t expected = lastFifoTimestampUs + samplePeriodUs;
+        int32_t drift = (int32_t)(first - expected);
+        if (drift > -(int32_t)samplePeriodUs && drift < (int32_t)samplePeriodUs) {
+            first = expected;
+        }
+    }
+    for (size_t i = 0; i < done; i++) {
+        out[i].timestampUs = first + i * samplePeriodUs;
+    }
+    lastFifoTimestampUs = out[done - 1].timestampUs;
+    
+    // Marks count from the oldest buffered frame: drop what was drained
+    uint8_t kept = 0;
+    for (uint8_t m = 0; m < rangeMarkCount; m++) {
+        if (rangeMarks[m].frames <= done) continue;
+        rangeMarks[kept].frames = rangeMarks[m].frames - done;
+        rangeMarks[kept].range = rangeMarks[m].range;
+        kept++;
+    }
+    rangeMarkCount = kept;
+    
+    // Only frames at the current range say whether it fits
+    updateAutoRange(peak, current);
+    
+    return done;
+}
+
+bool QMI8658C::submitFifoChunk(size_t chunk, size_t count) {
+    const size_t framesPerChunk = FIFO_CHUNK_BYTES / QMI8658C_FIFO_FRAME_BYTES;
+    size_t frames = min(count - chunk * framesPerChunk, framesPerChunk);
+    
+    I2CTransaction &txn = fifoTxn[chunk & 1];
+    txn.setRead(_addr, QMI8658C_FIFO_DATA, fifoBuf[chunk & 1],
+                frames * QMI8658C_FIFO_FRAME_BYTES);
+    txn.signal = _signal;
+    return _bus->submit(&txn);
+}
+
 uint8_t QMI8658C::readRegister(uint8_t reg) {
-    _wire->beginTransmission(_addr);
-    _wire->write(reg);
-    _wire->endTransmission(false);
-    _wire->requestFrom(_addr, (uint8_t)1);
-    return _wire->read();
+    uint8_t value = 0;
+    _bus->readRegisters(_addr, reg, &value, 1, _signal);
+    return value;
+}
+
+bool QMI8658C::readRegisters(uint8_t reg, uint8_t *buf, size_t len) {
+    return _bus->readRegisters(_addr, reg, buf, len, _signal);
 }
 
 void QMI8658C::writeRegister(uint8_t reg, uint8_t value) {
-    _wire->beginTransmission(_addr);
-    _wire->write(reg);
-    _wire->write(value);
-    _wire->endTransmission();
+    _bus->writeRegister(_addr, reg, value, _signal);
+}
+
+bool QMI8658C::readSample(IMUSample &sample) {
+    uint32_t now = micros();
+    bool irqDriven = (intPin >= 0 && intSource == QMI8658C_INT_DATA_READY &&
+                      irqTimestampUs != 0);
+    if (irqDriven) {
+        irqLatencyUs = now - irqTimestampUs;
+    }
+    
+    IMURawData raw;
+    if (!readRaw(raw)) return false;
+    
+    sample.timestampUs = irqDriven ? (uint32_t)irqTimestampUs : now;
+    sample.accelX = raw.accelX;
+    sample.accelY = raw.accelY;
+    sample.accelZ = raw.accelZ;
+    sample.gyroX = raw.gyroX;
+    sample.gyroY = raw.gyroY;
+    sample.gyroZ = raw.gyroZ;
+    sample.accelRange = accelRange;
+    applyCalibration(sample);
+    
+    updateAutoRange(max(max(abs(raw.accelX), abs(raw.accelY)), abs(raw.accelZ)), 1);
+    return true;
+}
+
+bool QMI8658C::enableInterrupt(QMI8658C_IntSource source, uint8_t pin) {
+    if (_bus == nullptr) return false;
+    if (source == QMI8658C_INT_FIFO_WATERMARK && !fifoEnabled) return false;
+    
+    disableInterrupt();
+    
+    intSource = source;
+    intPin = pin;
+    irqTimestampUs = 0;
+    
+    // Data-ready and FIFO watermark both signal on INT2 (push-pull, active high)
+    if (source == QMI8658C_INT_DATA_READY) {
+        writeRegister(QMI8658C_CTRL7, 0x03);
+    }
+    ctrl1 |= QMI8658C_CTRL1_INT2_EN;
+    writeRegister(QMI8658C_CTRL1, ctrl1);
+    
+    pinMode(pin, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(pin), handleInterrupt, this, RISING);
+    return true;
+}
+
+void QMI8658C::disableInterrupt() {
+    if (intPin < 0) return;
+    detachInterrupt(digitalPinToInterrupt(intPin));
+    ctrl1 &= ~QMI8658C_CTRL1_INT2_EN;
+    writeRegister(QMI8658C_CTRL1, ctrl1);
+    intPin = -1;
+}
+
+bool QMI8658C::configureTap(const QMI8658C_TapConfig &config) {
+    if (_bus == nullptr) return false;
+    
+    // First parameter block: windows and axis priority
+    uint8_t first[8] = {
+        config.peakWindow, config.priority,
+        (uint8_t)(config.tapWindow & 0xFF), (uint8_t)(config.tapWindow >> 8),
+        (uint8_t)(config.doubleTapWindow & 0xFF), (uint8_t)(config.doubleTapWindow >> 8),
+        0x00, 0x01
+    };
+    
+    // Second parameter block: filters and thresholds; the peak threshold
+    // is a squared magnitude, both in U5.11 format
+    uint16_t peakMag = (uint16_t)(config.peakThresholdG * config.peakThresholdG * 2048.0f);
+    uint16_t quiet = (uint16_t)(config.quietThresholdG * 2048.0f);
+    uint8_t second[8] = {
+        config.alpha, config.gamma,
+        (uint8_t)(peakMag & 0xFF), (uint8_t)(peakMag >> 8),
+        (uint8_t)(quiet & 0xFF), (uint8_t)(quiet >> 8),
+        0x00, 0x02
+    };
+    
+    return sendConfigCommand(QMI8658C_CMD_CONFIGURE_TAP, first) &&
+           sendConfigCommand(QMI8658C_CMD_CONFIGURE_TAP, second);
+}
+
+bool QMI8658C::configureAnyMotion(float thresholdG, uint8_t windowSamples) {
+    if (_bus == nullptr) return false;
+    
+    // Thresholds are U3.5 g (max 7.97 g), one per axis
+    float clamped = constrain(thresholdG, 0.0f, 7.96f);
+    uint8_t thr = (uint8_t)(clamped * 32.0f);
+    
+    // MOTION_MODE_CTRL: any-motion on X, Y and Z (bits 2:0); bit 3 clear,
+    // so any one axis triggers (set, all three would have to)
+    const uint8_t modeCtrl = 0x07;
+    uint8_t first[8] = {
+        thr, thr, thr,          // any-motion X/Y/Z
+        0x00, 0x00, 0x00,       // no-motion X/Y/Z (unused)
+        modeCtrl, 0x01
+    };
+    
+    uint8_t second[8] = {
+        windowSamples, 0x00,    // any-motion / no-motion window
+        0x00, 0x00,             // significant-motion wait window (unused)
+        0x00, 0x00,             // significant-motion confirm window (unused)
+        0x00, 0x02
+    };
+    
+    return sendConfigCommand(QMI8658C_CMD_CONFIGURE_MOTION, first) &&
+           sendConfigCommand(QMI8658C_CMD_CONFIGURE_MOTION, second);
+}
+
+bool QMI8658C::enableMotionEngines(uint8_t engines, uint8_t pin) {
+    if (_bus == nullptr) return false;
+    
+    disableMotionEngines();
+    
+    motionIntPin = pin;
+    motionIrqTimestampUs = 0;
+    
+    ctrl8 = QMI8658C_CTRL8_HS_STATUSINT | QMI8658C_CTRL8_ACT_INT1 | engines;
+    writeRegister(QMI8658C_CTRL8, ctrl8);
+    
+    ctrl1 |= QMI8658C_CTRL1_INT1_EN;
+    writeRegister(QMI8658C_CTRL1, ctrl1);
+    
+    pinMode(pin, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(pin), handleMotionInterrupt, this, RISING);
+    return true;
+}
+
+void QMI8658C::disableMotionEngines() {
+    if (_bus == nullptr) return;
+    
+    if (motionIntPin >= 0) {
+        detachInterrupt(digitalPinToInterrupt(motionIntPin));
+        motionIntPin = -1;
+    }
+    
+    ctrl8 = QMI8658C_CTRL8_HS_STATUSINT;
+    writeRegister(QMI8658C_CTRL8, ctrl8);
+    
+    ctrl1 &= ~QMI8658C_CTRL1_INT1_EN;
+    writeRegister(QMI8658C_CTRL1, ctrl1);
+}
+
+bool QMI8658C::readMotionEvent(QMI8658C_MotionEvent &event) {
+    if (_bus == nullptr) return false;
+    
+    // Reading STATUS1 clears the motion interrupt
+    uint8_t status = readRegister(QMI8658C_STATUS1);
+    
+    event.tap = (status & QMI8658C_STATUS1_TAP) != 0;
+    event.anyMotion = (status & QMI8658C_STATUS1_ANYMOTION) != 0;
+    event.tapCount = 0;
+    event.tapAxis = 0;
+    event.tapNegative = false;
+    
+    if (event.tap) {
+        // TAP_STATUS: [1:0] count, [5:4] axis (1 = X .. 3 = Z), [7] polarity
+        uint8_t tap = readRegister(QMI8658C_TAP_STATUS);
+        event.tapCount = tap & 0x03;
+        uint8_t axis = (tap >> 4) & 0x03;
+        event.tapAxis = axis > 0 ? axis - 1 : 0;
+        event.tapNegative = (tap & 0x80) != 0;
+    }
+    
+    return event.tap || event.anyMotion;
+}
+
+uint32_t QMI8658C::waitForEvents(TickType_t timeout) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, timeout);
+    return bits;
+}
+
+bool QMI8658C::waitForData(TickType_t timeout) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, QMI8658C_NOTIFY_DATA, &bits, timeout);
+    return (bits & QMI8658C_NOTIFY_DATA) != 0;
+}
+
+void IRAM_ATTR QMI8658C::handleInterrupt(void *arg) {
+    QMI8658C *self = (QMI8658C *)arg;
+    self->irqTimestampUs = micros();
+    
+    if (self->notifyTask != nullptr) {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(self->notifyTask, QMI8658C_NOTIFY_DATA, eSetBits, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+void QMI8658C::writeCtrl2() {
+    writeRegister(QMI8658C_CTRL2, (accelRange << 4) | odr);
+}
+
+void QMI8658C::writeCtrl3() {
+    writeRegister(QMI8658C_CTRL3, (gyroRange << 4) | odr);
+}
+
+void IRAM_ATTR QMI8658C::handleMotionInterrupt(void *arg) {
+    QMI8658C *self = (QMI8658C *)arg;
+    self->motionIrqTimestampUs = micros();
+    
+    if (self->notifyTask != nullptr) {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(self->notifyTask, QMI8658C_NOTIFY_MOTION, eSetBits, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+bool QMI8658C::sendConfigCommand(uint8_t cmd, const uint8_t params[8]) {
+    // Engines are configured with the sensors disabled
+    writeRegister(QMI8658C_CTRL7, 0x00);
+    
+    for (uint8_t i = 0; i < 8; i++) {
+        writeRegister(QMI8658C_CAL1_L + i, params[i]);
+    }
+    bool ok = sendCommand(cmd);
+    
+    writeRegister(QMI8658C_CTRL7, fifoEnabled ? (0x03 | QMI8658C_CTRL7_DRDY_DIS) : 0x03);
+    return ok;
+}
+
+bool QMI8658C::sendCommand(uint8_t cmd) {
+    // CTRL9 handshake: issue command, wait for CmdDone, then acknowledge
+    writeRegister(QMI8658C_CTRL9, cmd);
+    
+    unsigned long start = millis();
+    while (!(readRegister(QMI8658C_STATUSINT) & 0x80)) {
+        if (millis() - start > 10) return false;
+    }
+    
+    writeRegister(QMI8658C_CTRL9, QMI8658C_CMD_ACK);
+    
+    start = millis();
+    while (readRegister(QMI8658C_STATUSINT) & 0x80) {
+        if (millis() - start > 10) return false;
+    }
+    return true;
 }
 
 int16_t QMI8658C::readInt16(uint8_t regLow) {
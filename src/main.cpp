@@ -10,7 +10,7 @@
  */
 
 #include <Arduino.h>
-#include <Wire.h>
+#include "EspI2C.h"
 #include "QMI8658C.h"
 #include "GC9A01A.h"
 #include "Config.h"
@@ -18,6 +18,13 @@
 #include "WebServer.h"
 #include "ButtonHandler.h"
 #include "DisplayHelper.h"
+#include "FrameBuffer.h"
+#include "SensorTask.h"
+#include "Calibration.h"
+#include "TempCompensation.h"
+#include "EventStore.h"
+#include "WaveformCapture.h"
+#include "GestureRecognizer.h"
 
 // Display pins
 #define TFT_CS   35
@@ -28,6 +35,12 @@
 // IMU pins
 #define IMU_SDA 12
 #define IMU_SCL 11
+#define IMU_INT1 18
+#define IMU_INT2 21
+
+// Detect slaps with the IMU's tap / any-motion engines (MCU sleeps while idle)
+// instead of running the detector on the FIFO stream
+#define SLAP_DETECT_ON_CHIP false
 
 // Button pin
 #define BUTTON_PIN 47
@@ -37,18 +50,80 @@
 
 // Objects
 GC9A01A display(TFT_CS, TFT_DC, TFT_RST);
+EspI2C imuBus(I2C_NUM_0, IMU_SDA, IMU_SCL, 400000);
 QMI8658C imu;
+SensorTask sensorTask(&imu, IMU_INT2, IMU_INT1);
 ConfigManager configMgr;
 SlapWiFiManager wifiMgr(&configMgr);
-SlapWebServer webServer(&configMgr, &wifiMgr);
+ImuCalibrator calibrator(&sensorTask, &configMgr);
+TempCompensator tempComp(&sensorTask, &configMgr);
+EventStore eventStore;
+WaveformCapture waveforms;
+GestureRecognizer gestures;
+SlapWebServer webServer(&configMgr, &wifiMgr, &sensorTask, &calibrator, &eventStore,
+                        &waveforms, &gestures, &tempComp);
 ButtonHandler button(BUTTON_PIN, 5000);  // 5 second long press
+FrameBuffer frameBuffer;
 DisplayHelper displayHelper(&display);
 
+// IMU FIFO watermark: the sensor task is woken every 16 samples (~71 ms)
+#define IMU_FIFO_WATERMARK 16
+
 // Motion detection state
 float peakMotion = 0.0;
 unsigned long lastMotionTime = 0;
 const unsigned long DISPLAY_TIMEOUT = 3000;  // 3 seconds
 
+// Gesture LED blink: toggles left and time of the next toggle
+int ledToggles = 0;
+unsigned long ledNextToggle = 0;
+const unsigned long LED_BLINK_MS = 120;
+
+// Show a slap count; sinceSlapUs is the time from the last slap's peak
+// until now
+void showSlaps(uint8_t slaps, uint32_t sinceSlapUs) {
+    lastMotionTime = millis();
+    uint32_t drawStart = micros();
+    if (!displayHelper.showGesture(slaps)) return;  // already on screen
+    uint32_t drawUs = micros() - drawStart;
+    // With the flush task the SPI time comes after; the previous
+    // flush stands in for it
+    uint32_t flushUs = frameBuffer.isAsync() ? frameBuffer.getLastFlushUs() : 0;
+    Serial.printf("   Display: %luus in loop, %luus flush, %lu bytes, slap to screen %lums\n",
+                  (unsigned long)drawUs, (unsigned long)flushUs,
+                  (unsigned long)displayHelper.getLastFlushBytes(),
+                  (unsigned long)((sinceSlapUs + drawUs + flushUs) / 1000));
+}
+
+// Run the actions bound to a recognized gesture
+void onGesture(const GestureEvent &gesture) {
+    Serial.printf("👋 Gesture: %s (%u slaps over %lums, latency %lums)\n",
+                  GestureRecognizer::name(gesture.gesture), (unsigned)gesture.gesture,
+                  (unsigned long)((gesture.lastUs - gesture.firstUs) / 1000),
+                  (unsigned long)(gesture.latencyUs / 1000));
+    
+    // Usually on screen already (see loop()); upgrades a shown slap count
+    if (gesture.actions & GESTURE_ACTION_DISPLAY) {
+        showSlaps(gesture.gesture, gesture.latencyUs);
+    }
+    if (gesture.actions & GESTURE_ACTION_NETWORK) {
+        webServer.publishGesture(gesture);
+    }
+    if (gesture.actions & GESTURE_ACTION_LED) {
+        // One blink per slap
+        ledToggles = 2 * gesture.gesture;
+        ledNextToggle = millis();
+    }
+}
+
+void updateLed() {
+    if (ledToggles > 0 && (long)(millis() - ledNextToggle) >= 0) {
+        ledToggles--;
+        digitalWrite(LED_PWR, (ledToggles & 1) ? HIGH : LOW);
+        ledNextToggle = millis() + LED_BLINK_MS;
+    }
+}
+
 // Callback for factory reset
 void onFactoryReset() {
     Serial.println("🔄 FACTORY RESET TRIGGERED");
@@ -98,19 +173,34 @@ void setup() {
     
     // Initialize IMU
     Serial.println("[2/5] Initializing IMU...");
-    Wire.begin(IMU_SDA, IMU_SCL);
-    Wire.setClock(400000);
+    // ±8g at rest, so a slap's first peak does not clip; ±16g on hard slaps
+    imu.setAutoRange(true);
+    
+    // Rolling waveform history for slap captures (PSRAM)
+    if (waveforms.begin()) {
+        sensorTask.setWaveformCapture(&waveforms);
+    }
     
-    if (!imu.begin(Wire)) {
+    if (!imuBus.begin() || !imu.begin(imuBus)) {
         Serial.println("      ❌ IMU FAILED!");
+    } else if (!imu.enableFifo(IMU_FIFO_WATERMARK)) {
+        Serial.println("      ⚠️ IMU FIFO FAILED!");
+    } else if (!sensorTask.begin()) {
+        Serial.println("      ⚠️ Sensor task FAILED!");
     } else {
+        sensorTask.setOnChipDetection(SLAP_DETECT_ON_CHIP);
         Serial.println("      ✅ IMU OK!");
+        Serial.printf("      Classifier: arena %u bytes, model %u bytes\n",
+                      (unsigned)SlapClassifier::ARENA_BYTES, (unsigned)SlapClassifier::MODEL_BYTES);
     }
     
     // Load configuration
     Serial.println("[3/5] Loading Configuration...");
     configMgr.load();
     Serial.printf("      Threshold: %.2fg\n", configMgr.getThreshold());
+    sensorTask.setCalibration(configMgr.getCalibration());
+    sensorTask.setTempCompensation(configMgr.getTempCompensation());
+    sensorTask.setTemperatureInterval(configMgr.getTemperatureInterval());
     Serial.println("      ✅ Config OK!");
     
     // Initialize WiFi
@@ -120,6 +210,7 @@ void setup() {
     
     // Initialize Web Server
     Serial.println("[5/5] Starting Web Server...");
+    eventStore.begin();
     webServer.begin();
     Serial.println("      ✅ Web server OK!");
     
@@ -132,6 +223,13 @@ void setup() {
     delay(200);
     display.fillScreen(0x0000);  // Black
     
+    // Screens are composed in PSRAM and only the changes flushed, by a
+    // task on core 0 so loop() never waits on SPI
+    if (frameBuffer.begin()) {
+        displayHelper.setFrameBuffer(&frameBuffer);
+        frameBuffer.startFlushTask(display);
+    }
+    
     Serial.println("\n========================================");
     Serial.println("  🚀 SYSTEM READY!");
     Serial.println("========================================\n");
@@ -147,9 +245,6 @@ void setup() {
 }
 
 void loop() {
-    static unsigned long lastUpdate = 0;
-    static float gravityX = 0, gravityY = 0, gravityZ = 1.0;
-    
     // Update WiFi status
     wifiMgr.update();
     
@@ -186,70 +281,113 @@ void loop() {
     
     lastWiFiState = currentWiFiState;
     
+    // Frames submitted while the flush task was busy
+    displayHelper.update();
+    
     // Motion detection (only when connected or in AP mode, not while connecting)
-    if (wifiMgr.isConnected() || wifiMgr.isAP()) {
-        if (millis() - lastUpdate >= 100) {  // 10Hz update
-            lastUpdate = millis();
-            
-            // Read IMU
-            imu.update();
-            IMUData data = imu.getData();
-            
-            // Low-pass filter for gravity estimation
-            const float alpha = 0.8;
-            gravityX = alpha * gravityX + (1 - alpha) * data.accelX;
-            gravityY = alpha * gravityY + (1 - alpha) * data.accelY;
-            gravityZ = alpha * gravityZ + (1 - alpha) * data.accelZ;
-            
-            // Linear acceleration (motion only, gravity removed)
-            float linearX = data.accelX - gravityX;
-            float linearY = data.accelY - gravityY;
-            float linearZ = data.accelZ - gravityZ;
-            
-            // Motion magnitude
-            float motionAccel = sqrt(linearX * linearX + 
-                                    linearY * linearY + 
-                                    linearZ * linearZ);
-            
-            // Get threshold from config
-            float threshold = configMgr.getThreshold();
-            
-            // Motion detection
-            bool motionDetected = (motionAccel > threshold);
-            
-            if (motionDetected) {
-                if (motionAccel > peakMotion) {
-                    peakMotion = motionAccel;
-                    Serial.printf("💥 SLAP! Peak: %6.3fg (threshold: %.2fg)\n", 
-                                 peakMotion, threshold);
-                }
-                lastMotionTime = millis();
+    bool detectionActive = wifiMgr.isConnected() || wifiMgr.isAP();
+    
+    sensorTask.setDetectionEnabled(detectionActive);
+    sensorTask.setThreshold(configMgr.getThreshold());
+    sensorTask.setAdaptiveThreshold(configMgr.isAdaptiveThreshold(), configMgr.getNoiseK());
+    
+    // Consume samples published by the sensor task
+    static uint32_t samplesConsumed = 0;
+    IMUSample sample;
+    calibrator.poll();
+    tempComp.poll();
+    while (sensorTask.popSample(sample)) {
+        calibrator.addSample(sample);
+        tempComp.addSample(sample);
+        samplesConsumed++;
+    }
+    
+    // Consume slap events published by the sensor task; the horizon is
+    // read first so no event can arrive behind it
+    gestures.setConfig(configMgr.getGestureConfig());
+    uint32_t horizonUs = sensorTask.getEventHorizonUs();
+    GestureEvent gesture;
+    SlapEvent event;
+    while (sensorTask.popEvent(event)) {
+        eventStore.append(event);
+        if (event.peak > peakMotion) {
+            peakMotion = event.peak;
+        }
+        Serial.printf("💥 SLAP! Peak: %6.3fg, %lums, energy %.4f g²s (threshold: %.2fg)\n",
+                     event.peak, (unsigned long)(event.durationUs / 1000),
+                     event.energy, sensorTask.getActiveThreshold());
+        if (event.label != SLAP_CLASS_UNKNOWN) {
+            Serial.printf("   Class: %s (%u%%)\n", SlapClassifier::labelName(event.label),
+                          event.confidence);
+        }
+        if (event.features.rms > 0) {
+            Serial.printf("   RMS %.3fg, crest %.1f, kurtosis %.1f, centroid %.1f Hz, peak %.1f Hz\n",
+                          event.features.rms, event.features.crest, event.features.kurtosis,
+                          event.features.centroidHz, event.features.peakHz);
+        }
+        
+        // Bumps and drops are not part of a gesture
+        if (detectionActive && event.label != SLAP_CLASS_BUMP && event.label != SLAP_CLASS_DROP) {
+            if (gestures.addSlap(event.timestampUs, event.peak, micros(), gesture)) {
+                onGesture(gesture);
             }
             
-            // Check timeout
-            unsigned long timeSinceMotion = millis() - lastMotionTime;
-            bool displayActive = (timeSinceMotion < DISPLAY_TIMEOUT);
-            
-            if (!displayActive) {
-                peakMotion = 0.0;
+            // Show the slaps so far without waiting out the gesture window;
+            // a double or triple replaces the screen once recognized
+            uint8_t slaps = gestures.getPendingSlaps();
+            if (slaps > 0 && (gestures.getConfig().actions[slaps] & GESTURE_ACTION_DISPLAY)) {
+                showSlaps(slaps, micros() - event.timestampUs);
             }
-            
-            // Update display based on motion
-            static bool wasMotionActive = false;
-            
-            if (displayActive && !wasMotionActive) {
-                // Motion just detected - show SLAP
-                displayHelper.showSlap();
-            } else if (!displayActive && wasMotionActive) {
-                // Motion timeout - return to appropriate state
-                if (wifiMgr.isAP()) {
-                    displayHelper.showAPMode(wifiMgr.getIPAddress().c_str());
-                } else if (wifiMgr.isConnected()) {
-                    displayHelper.showConnected();  // Black screen
-                }
+        }
+    }
+    if (gestures.poll(horizonUs, micros(), gesture)) {
+        onGesture(gesture);
+    }
+    if (!detectionActive) {
+        gestures.reset();
+    }
+    updateLed();
+    
+    // Report sampling cadence every 10 seconds
+    static unsigned long lastStatsTime = 0;
+    if (sensorTask.isRunning() && millis() - lastStatsTime >= 10000) {
+        lastStatsTime = millis();
+        SensorStats stats = sensorTask.getStats();
+        SensorOrientation orientation = sensorTask.getOrientation();
+        Serial.printf("📈 IMU: %lu samples (%.1f Hz), drain interval %lu-%luus, "
+                      "IRQ latency max %luus, detector %lu cycles/sample, dropped %lu, "
+                      "noise %.1f mg, threshold %.2fg, roll %.1f° pitch %.1f°\n",
+                      (unsigned long)samplesConsumed, samplesConsumed / 10.0f,
+                      (unsigned long)stats.minIntervalUs, (unsigned long)stats.maxIntervalUs,
+                      (unsigned long)stats.maxLatencyUs, (unsigned long)stats.detectCycles,
+                      (unsigned long)(stats.droppedSamples + stats.droppedEvents),
+                      sensorTask.getNoiseSigma() * 1000.0f, sensorTask.getActiveThreshold(),
+                      orientation.roll, orientation.pitch);
+        samplesConsumed = 0;
+    }
+    
+    if (detectionActive) {
+        // Check timeout
+        unsigned long timeSinceMotion = millis() - lastMotionTime;
+        bool displayActive = (timeSinceMotion < DISPLAY_TIMEOUT);
+        
+        if (!displayActive) {
+            peakMotion = 0.0;
+        }
+        
+        // Gestures draw themselves (onGesture); return to the idle screen
+        // DISPLAY_TIMEOUT after the last one
+        static bool wasMotionActive = false;
+        
+        if (!displayActive && wasMotionActive) {
+            // Motion timeout - return to appropriate state
+            if (wifiMgr.isAP()) {
+                displayHelper.showAPMode(wifiMgr.getIPAddress().c_str());
+            } else if (wifiMgr.isConnected()) {
+                displayHelper.showConnected();  // Black screen
             }
-            
-            wasMotionActive = displayActive;
         }
+        
+        wasMotionActive = displayActive;
     }
 }
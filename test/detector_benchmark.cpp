@@ -0,0 +1,128 @@
+/*
+ * Detector Benchmark - cycles per sample
+ * Runs the slap detectors over a synthetic trace (gravity + noise +
+ * periodic impacts) and reports CPU cycles per sample for each path.
+ * No sensor needed.
+ *
+ * Usage: copy to src/main.cpp, build and upload, open serial monitor.
+ */
+
+#include <Arduino.h>
+#include "QMI8658C.h"
+#include "MotionDetector.h"
+#include "SlapDetector.h"
+
+#define TRACE_LEN  2048
+#define PASSES     20
+#define SAMPLE_HZ  224.2f
+
+QMI8658C imu;  // only used for count -> g conversion
+IMUSample trace[TRACE_LEN];
+
+void buildTrace() {
+    randomSeed(42);
+    for (int i = 0; i < TRACE_LEN; i++) {
+        IMUSample &s = trace[i];
+        s.timestampUs = i * 4460;
+        s.accelRange = QMI8658C_ACCEL_2G;
+
+        // ±2g counts: 16384 per g, ~10 mg noise, 1 g on Z
+        s.accelX = random(-160, 161);
+        s.accelY = random(-160, 161);
+        s.accelZ = 16384 + random(-160, 161);
+        s.gyroX = s.gyroY = s.gyroZ = 0;
+
+        // 1.2 g impact every 256 samples
+        if ((i % 256) == 128) {
+            s.accelX += 19660;
+        }
+    }
+}
+
+void report(const char *name, uint32_t cycles, int events) {
+    float perSample = (float)cycles / (TRACE_LEN * PASSES);
+    Serial.printf("  %-28s %8.1f cycles/sample  %6.2f us/sample  (%d events)\n",
+                  name, perSample, perSample / ESP.getCpuFreqMHz(), events);
+}
+
+void runBenchmarks() {
+    SlapEvent event;
+
+    // Float path as used before: convert to g, filter, sqrt
+    {
+        MotionDetector detector;
+        detector.setSampleRate(SAMPLE_HZ);
+        detector.setThreshold(0.5f);
+        int events = 0;
+
+        uint32_t start = ESP.getCycleCount();
+        for (int p = 0; p < PASSES; p++) {
+            for (int i = 0; i < TRACE_LEN; i++) {
+                if (detector.update(imu.toIMUData(trace[i]), trace[i].timestampUs, event)) {
+                    events++;
+                }
+            }
+        }
+        report("float (toIMUData + sqrt)", ESP.getCycleCount() - start, events);
+    }
+
+    // Fixed-point path on raw counts
+    {
+        FixedMotionDetector detector;
+        detector.setSampleRate(SAMPLE_HZ);
+        detector.setThreshold(0.5f);
+        int events = 0;
+
+        uint32_t start = ESP.getCycleCount();
+        for (int p = 0; p < PASSES; p++) {
+            for (int i = 0; i < TRACE_LEN; i++) {
+                if (detector.update(trace[i], event)) {
+                    events++;
+                }
+            }
+        }
+        report("fixed (int16 counts)", ESP.getCycleCount() - start, events);
+    }
+
+    // Streaming pipeline: biquad high-pass, jerk, peak picking
+    {
+        SlapDetector detector;
+        detector.setSampleRate(SAMPLE_HZ);
+        detector.setThreshold(0.5f);
+        int events = 0;
+
+        uint32_t start = ESP.getCycleCount();
+        for (int p = 0; p < PASSES; p++) {
+            for (int i = 0; i < TRACE_LEN; i++) {
+                if (detector.update(trace[i], event)) {
+                    events++;
+                }
+            }
+        }
+        report("slap (biquad + jerk + peak)", ESP.getCycleCount() - start, events);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    unsigned long start = millis();
+    while (!Serial && (millis() - start < 3000)) {
+        delay(100);
+    }
+    delay(500);
+
+    Serial.println("========================================");
+    Serial.println("  DETECTOR BENCHMARK");
+    Serial.printf("  %d samples x %d passes @ %lu MHz\n",
+                  TRACE_LEN, PASSES, (unsigned long)ESP.getCpuFreqMHz());
+    Serial.println("========================================\n");
+
+    buildTrace();
+}
+
+void loop() {
+    runBenchmarks();
+    Serial.println();
+    delay(5000);
+}
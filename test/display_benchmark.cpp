@@ -0,0 +1,327 @@
+/*
+ * Display Benchmark - time per fill / blit / text / slap screen
+ * Times full-screen fills the old way (one transfer16 per pixel) and with
+ * the line-buffer bulk path, blits, and the slap screen DisplayHelper
+ * draws on every gesture (fill + text). The slap screen time adds to the
+ * gesture latency for slap-to-red-screen.
+ * Text and shapes are timed through the batched GFX interface and through
+ * a reference panel that only implements drawPixel() the old way (one
+ * transaction and address window per pixel).
+ * With the PSRAM framebuffer, reports the pixel bytes each screen update
+ * flushes (slap screen, connecting-dots frame, progress bar step), and
+ * with the flush task the time loop() spends per update against the SPI
+ * time the task spends, plus how many of a burst of updates get replaced.
+ * Finally the transport throughput in bytes/s per operation type (command
+ * packets, single pixels, spans, fills, blits) at several SPI clocks.
+ *
+ * Usage: copy to src/main.cpp, build and upload, open serial monitor.
+ */
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "GC9A01A.h"
+#include "DisplayHelper.h"
+#include "FrameBuffer.h"
+
+#define TFT_CS   35
+#define TFT_DC   36
+#define TFT_RST  34
+#define TFT_BL   33
+
+#define TFT_FREQ 27000000
+
+#define PASSES   20
+#define PIXELS   (128 * 128)
+
+GC9A01A display(TFT_CS, TFT_DC, TFT_RST);
+DisplayHelper displayHelper(&display);
+FrameBuffer frameBuffer;
+DisplayHelper bufferedHelper(&display);
+FrameBuffer asyncBuffer;
+DisplayHelper asyncHelper(&display);
+uint16_t image[PIXELS];
+
+// Reference: the per-pixel path the driver used before the bulk and
+// batched writes, a transaction per pixel and DC and CS set per byte
+void legacyWrite(bool data, uint8_t value) {
+    digitalWrite(TFT_DC, data ? HIGH : LOW);
+    digitalWrite(TFT_CS, LOW);
+    SPI.transfer(value);
+    digitalWrite(TFT_CS, HIGH);
+}
+
+void legacyWindow(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    legacyWrite(false, GC9A01A_CASET);
+    legacyWrite(true, 0); legacyWrite(true, x);
+    legacyWrite(true, 0); legacyWrite(true, x + w - 1);
+    legacyWrite(false, GC9A01A_RASET);
+    legacyWrite(true, 0); legacyWrite(true, y);
+    legacyWrite(true, 0); legacyWrite(true, y + h - 1);
+    legacyWrite(false, GC9A01A_RAMWR);
+}
+
+void legacyFillScreen(uint16_t color) {
+    SPI.beginTransaction(SPISettings(27000000, MSBFIRST, SPI_MODE0));
+    legacyWindow(0, 0, 128, 128);
+
+    digitalWrite(TFT_DC, HIGH);
+    digitalWrite(TFT_CS, LOW);
+    for (uint32_t i = 0; i < PIXELS; i++) {
+        SPI.transfer16(color);
+    }
+    digitalWrite(TFT_CS, HIGH);
+    SPI.endTransaction();
+}
+
+// GFX target that only has drawPixel(): every glyph and line goes
+// through it pixel by pixel
+class LegacyPanel : public Adafruit_GFX {
+public:
+    LegacyPanel() : Adafruit_GFX(128, 128) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+        if ((x < 0) || (x >= 128) || (y < 0) || (y >= 128)) return;
+        SPI.beginTransaction(SPISettings(27000000, MSBFIRST, SPI_MODE0));
+        legacyWindow(x, y, 1, 1);
+        digitalWrite(TFT_DC, HIGH);
+        digitalWrite(TFT_CS, LOW);
+        SPI.transfer16(color);
+        digitalWrite(TFT_CS, HIGH);
+        SPI.endTransaction();
+    }
+};
+
+LegacyPanel legacy;
+
+// 21 characters, one line of size 1 text
+const char *TEXT_LINE = "Connect to: 10.0.0.42";
+
+void drawText(Adafruit_GFX &gfx, const char *text, uint8_t size, bool opaque) {
+    if (opaque) {
+        gfx.setTextColor(COLOR_WHITE, COLOR_BLACK);
+    } else {
+        gfx.setTextColor(COLOR_WHITE);
+    }
+    gfx.setTextSize(size);
+    gfx.setCursor(0, 60);
+    gfx.print(text);
+}
+
+void report(const char *name, uint32_t us, uint32_t pixelsPerPass) {
+    float perPass = (float)us / PASSES;
+    float mbps = perPass > 0 ? pixelsPerPass * 2.0f / perPass : 0;   // bytes/us = MB/s
+    if (pixelsPerPass) {
+        Serial.printf("  %-28s %9.1f us  %6.2f MB/s\n", name, perPass, mbps);
+    } else {
+        Serial.printf("  %-28s %9.1f us\n", name, perPass);
+    }
+}
+
+void runBenchmarks() {
+    uint32_t start;
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) legacyFillScreen(p & 1 ? COLOR_RED : COLOR_BLACK);
+    report("fillScreen (per pixel)", micros() - start, PIXELS);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) display.fillScreen(p & 1 ? COLOR_RED : COLOR_BLACK);
+    report("fillScreen (line buffer)", micros() - start, PIXELS);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) display.fillRect(0, 95, 128, 20, p & 1 ? COLOR_YELLOW : COLOR_BLACK);
+    report("fillRect 128x20", micros() - start, 128 * 20);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) display.pushPixels(0, 0, 128, 128, image);
+    report("pushPixels 128x128", micros() - start, PIXELS);
+
+    // Text and shapes: reference per-pixel panel, then batched writes
+    start = micros();
+    for (int p = 0; p < PASSES; p++) drawText(legacy, TEXT_LINE, 1, false);
+    report("text 1x (per pixel)", micros() - start, 0);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) drawText(display, TEXT_LINE, 1, false);
+    report("text 1x (batched)", micros() - start, 0);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) drawText(display, TEXT_LINE, 1, true);
+    report("text 1x opaque (batched)", micros() - start, 0);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) drawText(legacy, "SLAP!", 3, false);
+    report("text 3x (per pixel)", micros() - start, 0);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) drawText(display, "SLAP!", 3, false);
+    report("text 3x (batched)", micros() - start, 0);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) legacy.drawRect(12, 68, 104, 14, COLOR_WHITE);
+    report("drawRect 104x14 (per pixel)", micros() - start, 0);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) display.drawRect(12, 68, 104, 14, COLOR_WHITE);
+    report("drawRect 104x14 (batched)", micros() - start, 0);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) display.drawRGBBitmap(48, 48, image, 32, 32);
+    report("drawRGBBitmap 32x32", micros() - start, 32 * 32);
+
+    // Slap screen: alternate single / double so every pass redraws
+    start = micros();
+    for (int p = 0; p < PASSES; p++) displayHelper.showGesture(p & 1 ? 2 : 1);
+    report("showGesture (fill + text)", micros() - start, PIXELS);
+
+    if (!frameBuffer.isReady()) return;
+
+    // Framebuffer: time and pixel bytes flushed per update
+    frameBuffer.invalidate();
+    start = micros();
+    for (int p = 0; p < PASSES; p++) bufferedHelper.showGesture(p & 1 ? 2 : 1);
+    report("showGesture (framebuffer)", micros() - start, 0);
+    Serial.printf("  %-28s %9lu bytes/frame\n", "  flushed",
+                  (unsigned long)frameBuffer.getLastFlushBytes());
+
+    bufferedHelper.showConnecting("HomeNet");
+    Serial.printf("  %-28s %9lu bytes/frame\n", "connecting screen",
+                  (unsigned long)frameBuffer.getLastFlushBytes());
+    uint32_t dotBytes = 0;
+    for (int p = 0; p < 4; p++) {
+        delay(510);     // dots advance every 500 ms
+        bufferedHelper.showConnecting("HomeNet");
+        dotBytes += frameBuffer.getLastFlushBytes();
+    }
+    Serial.printf("  %-28s %9lu bytes/frame\n", "connecting dots",
+                  (unsigned long)(dotBytes / 4));
+
+    bufferedHelper.showResetting(0.5f);
+    bufferedHelper.showResetting(0.6f);
+    Serial.printf("  %-28s %9lu bytes/frame\n", "progress bar +10%",
+                  (unsigned long)frameBuffer.getLastFlushBytes());
+    bufferedHelper.setState(DISPLAY_IDLE);
+
+    if (!asyncBuffer.isAsync()) return;
+
+    // Flush task: loop() side cost per update, then the task's SPI time
+    asyncBuffer.invalidate();
+    asyncHelper.showConnected();
+    while (asyncBuffer.isFlushing()) delay(1);
+
+    uint32_t loopUs = 0, flushUs = 0;
+    for (int p = 0; p < PASSES; p++) {
+        start = micros();
+        asyncHelper.showGesture(p & 1 ? 2 : 1);
+        loopUs += micros() - start;
+        while (asyncBuffer.isFlushing()) delay(1);
+        flushUs += asyncBuffer.getLastFlushUs();
+    }
+    report("showGesture (task, loop)", loopUs, 0);
+    report("showGesture (task, SPI)", flushUs, 0);
+
+    // Burst faster than the panel: later frames replace pending ones
+    uint32_t submitted = asyncBuffer.getSubmitted();
+    uint32_t replaced = asyncBuffer.getReplaced();
+    uint32_t frames = asyncBuffer.getFrames();
+    for (int p = 0; p < PASSES; p++) {
+        asyncHelper.showGesture(p & 1 ? 2 : 1);
+        asyncHelper.update();
+    }
+    while (asyncBuffer.isFlushing() || asyncBuffer.poll()) delay(1);
+    Serial.printf("  %-28s %lu submitted, %lu replaced, %lu flushed\n", "burst",
+                  (unsigned long)(asyncBuffer.getSubmitted() - submitted),
+                  (unsigned long)(asyncBuffer.getReplaced() - replaced),
+                  (unsigned long)(asyncBuffer.getFrames() - frames));
+    asyncHelper.setState(DISPLAY_IDLE);
+}
+
+// Bytes on the wire per operation, including command packets
+// (CASET + 4, RASET + 4, RAMWR: 11 bytes per address window)
+#define WINDOW_BYTES 11
+
+void reportRate(const char *name, uint32_t us, uint32_t ops, uint32_t bytesPerOp) {
+    float bytesPerSec = us > 0 ? (float)ops * bytesPerOp * 1e6f / us : 0;
+    Serial.printf("  %-28s %8.2f us/op  %10.0f bytes/s\n", name, (float)us / ops, bytesPerSec);
+}
+
+void runThroughput(uint32_t freq) {
+    const uint32_t ops = 200;
+    uint32_t start;
+
+    display.setFrequency(freq);
+    Serial.printf("  -- SPI %lu MHz (%lu bytes/s on the wire) --\n",
+                  (unsigned long)(display.getFrequency() / 1000000),
+                  (unsigned long)(display.getFrequency() / 8));
+
+    start = micros();
+    for (uint32_t i = 0; i < ops; i++) display.setRotation(0);
+    reportRate("command + 1 param", micros() - start, ops, 2);
+
+    start = micros();
+    for (uint32_t i = 0; i < ops; i++) display.drawPixel(i & 127, 64, COLOR_WHITE);
+    reportRate("drawPixel (window + 1 px)", micros() - start, ops, WINDOW_BYTES + 2);
+
+    display.startWrite();
+    start = micros();
+    for (uint32_t i = 0; i < ops; i++) display.writePixel(i & 127, 66, COLOR_WHITE);
+    uint32_t us = micros() - start;
+    display.endWrite();
+    reportRate("writePixel (batched)", us, ops, WINDOW_BYTES + 2);
+
+    start = micros();
+    for (uint32_t i = 0; i < ops; i++) display.drawFastHLine(0, i & 127, 128, COLOR_BLUE);
+    reportRate("drawFastHLine 128", micros() - start, ops, WINDOW_BYTES + 256);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) display.fillScreen(p & 1 ? COLOR_RED : COLOR_BLACK);
+    reportRate("fillScreen", micros() - start, PASSES, WINDOW_BYTES + PIXELS * 2);
+
+    start = micros();
+    for (int p = 0; p < PASSES; p++) display.pushPixels(0, 0, 128, 128, image);
+    reportRate("pushPixels 128x128", micros() - start, PASSES, WINDOW_BYTES + PIXELS * 2);
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    unsigned long start = millis();
+    while (!Serial && (millis() - start < 3000)) {
+        delay(100);
+    }
+    delay(500);
+
+    pinMode(TFT_BL, OUTPUT);
+    digitalWrite(TFT_BL, HIGH);
+    display.begin(TFT_FREQ);
+
+    if (frameBuffer.begin()) {
+        bufferedHelper.setFrameBuffer(&frameBuffer);
+    }
+    if (asyncBuffer.begin() && asyncBuffer.startFlushTask(display)) {
+        asyncHelper.setFrameBuffer(&asyncBuffer);
+    }
+
+    // Gradient test image
+    for (int y = 0; y < 128; y++) {
+        for (int x = 0; x < 128; x++) {
+            image[y * 128 + x] = ((x >> 2) << 11) | ((y >> 1) << 5) | ((x + y) >> 3);
+        }
+    }
+
+    Serial.println("========================================");
+    Serial.println("  DISPLAY BENCHMARK");
+    Serial.printf("  %d passes per line @ %lu MHz CPU\n",
+                  PASSES, (unsigned long)ESP.getCpuFreqMHz());
+    Serial.println("========================================\n");
+}
+
+void loop() {
+    runBenchmarks();
+    Serial.println();
+    static const uint32_t clocks[] = {27000000, 40000000, 80000000};
+    for (uint32_t freq : clocks) runThroughput(freq);
+    display.setFrequency(TFT_FREQ);
+    Serial.println();
+    delay(5000);
+}
@@ -0,0 +1,101 @@
+/*
+ * Feature Extraction Benchmark - cycles per window
+ * Runs the scalar reference and the ESP-DSP path of FeatureExtractor
+ * over the same synthetic impact windows and reports CPU cycles per
+ * window and the largest difference between the two results.
+ * No sensor needed.
+ *
+ * Usage: copy to src/main.cpp, build and upload, open serial monitor.
+ */
+
+#include <Arduino.h>
+#include "FeatureExtractor.h"
+
+#define WINDOWS    16
+#define PASSES     50
+#define SAMPLE_HZ  224.2f
+
+FeatureExtractor extractor;
+float windows[WINDOWS][FEATURE_WINDOW];
+
+void buildWindows() {
+    randomSeed(42);
+    for (int w = 0; w < WINDOWS; w++) {
+        // Decaying ring-down at a different frequency per window + noise
+        float hz = 10.0f + w * 5.0f;
+        for (int i = 0; i < FEATURE_WINDOW; i++) {
+            float t = i / SAMPLE_HZ;
+            float ring = i >= 64 ? 2.0f * expf(-(i - 64) / 8.0f) * sinf(2.0f * PI * hz * t) : 0;
+            windows[w][i] = ring + random(-100, 101) / 10000.0f;
+        }
+    }
+}
+
+uint32_t run(bool scalar, SlapFeatures *out) {
+    uint32_t start = ESP.getCycleCount();
+    for (int p = 0; p < PASSES; p++) {
+        for (int w = 0; w < WINDOWS; w++) {
+            if (scalar) {
+                extractor.extractScalar(windows[w], out[w]);
+            } else {
+                extractor.extract(windows[w], out[w]);
+            }
+        }
+    }
+    return ESP.getCycleCount() - start;
+}
+
+void report(const char *name, uint32_t cycles) {
+    float perWindow = (float)cycles / (WINDOWS * PASSES);
+    Serial.printf("  %-20s %9.0f cycles/window  %7.1f us/window\n",
+                  name, perWindow, perWindow / ESP.getCpuFreqMHz());
+}
+
+void runBenchmarks() {
+    static SlapFeatures ref[WINDOWS];
+    static SlapFeatures fast[WINDOWS];
+
+    uint32_t scalarCycles = run(true, ref);
+    uint32_t dspCycles = run(false, fast);
+
+    report("scalar reference", scalarCycles);
+    report(FEATURES_USE_ESP_DSP ? "esp-dsp" : "esp-dsp (missing)", dspCycles);
+    Serial.printf("  speedup %.2fx\n", (float)scalarCycles / dspCycles);
+
+    float maxDiff = 0;
+    for (int w = 0; w < WINDOWS; w++) {
+        maxDiff = max(maxDiff, fabsf(ref[w].rms - fast[w].rms));
+        maxDiff = max(maxDiff, fabsf(ref[w].kurtosis - fast[w].kurtosis));
+        maxDiff = max(maxDiff, fabsf(ref[w].centroidHz - fast[w].centroidHz));
+    }
+    Serial.printf("  max difference %.6f\n", maxDiff);
+    Serial.printf("  last window: RMS %.3fg crest %.2f kurtosis %.2f centroid %.1f Hz\n",
+                  fast[WINDOWS - 1].rms, fast[WINDOWS - 1].crest,
+                  fast[WINDOWS - 1].kurtosis, fast[WINDOWS - 1].centroidHz);
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    unsigned long start = millis();
+    while (!Serial && (millis() - start < 3000)) {
+        delay(100);
+    }
+    delay(500);
+
+    Serial.println("========================================");
+    Serial.println("  FEATURE EXTRACTION BENCHMARK");
+    Serial.printf("  %d-point windows x %d x %d passes @ %lu MHz\n",
+                  FEATURE_WINDOW, WINDOWS, PASSES, (unsigned long)ESP.getCpuFreqMHz());
+    Serial.println("========================================\n");
+
+    extractor.setSampleRate(SAMPLE_HZ);
+    extractor.begin();
+    buildWindows();
+}
+
+void loop() {
+    runBenchmarks();
+    Serial.println();
+    delay(5000);
+}
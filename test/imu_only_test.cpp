@@ -104,7 +104,8 @@ void loop() {
                      data.accelX, data.accelY, data.accelZ);
         Serial.printf("Gyro: X=%7.2f Y=%7.2f Z=%7.2f °/s  |  ", 
                      data.gyroX, data.gyroY, data.gyroZ);
-        Serial.printf("Temp: %5.1f°C\n", data.temperature);
+        Serial.printf("Temp: %5.1f°C  |  ", data.temperature);
+        Serial.printf("Bus: %4luus\n", (unsigned long)imu.getLastBusTimeUs());
         
         // Every 10 readings, show a separator
         if (counter % 10 == 0) {
@@ -0,0 +1,69 @@
+/*
+ * Host-side mock bus for AsyncI2C
+ *
+ * Transactions stay queued until the test calls process() (or wait()),
+ * so tests can inspect the queue between submit and completion. A stalled
+ * bus makes wait() time out instead. Each
+ * device address owns a 256-byte register map; every transfer is logged.
+ */
+
+#ifndef MOCKI2CBUS_H
+#define MOCKI2CBUS_H
+
+#include <string.h>
+#include <vector>
+#include "AsyncI2C.h"
+
+struct MockTransfer {
+    uint8_t addr;
+    uint8_t reg;
+    bool read;
+    uint16_t len;
+};
+
+class MockI2CBus : public AsyncI2C {
+public:
+    std::vector<MockTransfer> log;
+    uint8_t regs[128][256];
+    int failAt;             // index into log of a transfer to fail, -1 = none
+    int notifications;
+    int signals;
+    bool stalled;           // wait() times out without running anything
+
+    MockI2CBus() : failAt(-1), notifications(0), signals(0), stalled(false) {
+        memset(regs, 0, sizeof(regs));
+    }
+
+    // Like a worker task catching up: run everything queued
+    bool wait(I2CTransaction *txn, uint32_t timeoutMs) override {
+        (void)timeoutMs;
+        if (stalled) return txn->done();
+        process();
+        return txn->done();
+    }
+
+protected:
+    int8_t transfer(I2CTransaction &txn) override {
+        MockTransfer t = {txn.addr, txn.reg, txn.read, txn.len};
+        log.push_back(t);
+        if ((int)log.size() - 1 == failAt) return I2C_ERROR;
+
+        uint8_t *map = regs[txn.addr & 0x7F];
+        for (uint16_t i = 0; i < txn.len; i++) {
+            uint8_t r = (uint8_t)(txn.reg + i);
+            if (txn.read) {
+                txn.data[i] = map[r];
+            } else {
+                map[r] = txn.data[i];
+            }
+        }
+        return I2C_OK;
+    }
+
+    void notifyWorker() override { notifications++; }
+    void signalDone(void *signal) override {
+        if (signal != nullptr) signals++;
+    }
+};
+
+#endif // MOCKI2CBUS_H
@@ -0,0 +1,206 @@
+/*
+ * AsyncI2C queue tests (host)
+ *
+ * Usage: pio test -e native -f native/test_async_i2c
+ */
+
+#include <unity.h>
+#include "MockI2CBus.h"
+
+#define DEV 0x6B
+
+static MockI2CBus *bus;
+
+void setUp() {
+    bus = new MockI2CBus();
+}
+
+void tearDown() {
+    delete bus;
+}
+
+static void recordOrder(I2CTransaction *txn, void *context) {
+    std::vector<uint8_t> *order = static_cast<std::vector<uint8_t> *>(context);
+    order->push_back(txn->reg);
+    // The status is published after the callback returns
+    TEST_ASSERT_FALSE(txn->done());
+}
+
+void test_transactions_run_in_submission_order() {
+    I2CTransaction txn[5];
+    uint8_t buf[5];
+    std::vector<uint8_t> order;
+
+    for (int i = 0; i < 5; i++) {
+        txn[i].setRead(DEV, (uint8_t)(0x30 - i), &buf[i], 1);
+        txn[i].callback = recordOrder;
+        txn[i].context = &order;
+        TEST_ASSERT_TRUE(bus->submit(&txn[i]));
+    }
+    TEST_ASSERT_EQUAL(5, bus->pending());
+    TEST_ASSERT_EQUAL(5, bus->notifications);
+
+    TEST_ASSERT_EQUAL(5, bus->process());
+    TEST_ASSERT_EQUAL(0, bus->pending());
+    TEST_ASSERT_EQUAL(5, order.size());
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0x30 - i, order[i]);
+        TEST_ASSERT_EQUAL_HEX8(0x30 - i, bus->log[i].reg);
+    }
+}
+
+void test_pending_until_processed() {
+    uint8_t buf[6];
+    I2CTransaction txn;
+    txn.setRead(DEV, 0x35, buf, sizeof(buf));
+
+    TEST_ASSERT_TRUE(txn.done());
+    TEST_ASSERT_TRUE(bus->submit(&txn));
+    TEST_ASSERT_FALSE(txn.done());
+    TEST_ASSERT_EQUAL(I2C_PENDING, txn.status.load());
+
+    TEST_ASSERT_TRUE(bus->wait(&txn, 50));
+    TEST_ASSERT_TRUE(txn.ok());
+}
+
+void test_process_limit_completes_prefix() {
+    uint8_t buf[3];
+    I2CTransaction txn[3];
+    for (int i = 0; i < 3; i++) {
+        txn[i].setRead(DEV, (uint8_t)i, &buf[i], 1);
+        bus->submit(&txn[i]);
+    }
+
+    TEST_ASSERT_EQUAL(1, bus->process(1));
+    TEST_ASSERT_TRUE(txn[0].done());
+    TEST_ASSERT_FALSE(txn[1].done());
+    TEST_ASSERT_FALSE(txn[2].done());
+
+    TEST_ASSERT_EQUAL(2, bus->process());
+    TEST_ASSERT_TRUE(txn[2].ok());
+}
+
+void test_queue_full_rejects() {
+    I2CTransaction txn[ASYNC_I2C_QUEUE_LEN + 1];
+    uint8_t buf[ASYNC_I2C_QUEUE_LEN + 1];
+    for (int i = 0; i < ASYNC_I2C_QUEUE_LEN; i++) {
+        txn[i].setRead(DEV, 0x00, &buf[i], 1);
+        TEST_ASSERT_TRUE(bus->submit(&txn[i]));
+    }
+    txn[ASYNC_I2C_QUEUE_LEN].setRead(DEV, 0x00, &buf[ASYNC_I2C_QUEUE_LEN], 1);
+    TEST_ASSERT_FALSE(bus->submit(&txn[ASYNC_I2C_QUEUE_LEN]));
+    TEST_ASSERT_TRUE(txn[ASYNC_I2C_QUEUE_LEN].done());
+
+    // Space frees up as the worker completes transactions
+    bus->process(1);
+    TEST_ASSERT_TRUE(bus->submit(&txn[ASYNC_I2C_QUEUE_LEN]));
+}
+
+void test_in_flight_transaction_cannot_be_resubmitted() {
+    uint8_t value = 0;
+    I2CTransaction txn;
+    txn.setRead(DEV, 0x00, &value, 1);
+
+    TEST_ASSERT_TRUE(bus->submit(&txn));
+    TEST_ASSERT_FALSE(bus->submit(&txn));
+    TEST_ASSERT_EQUAL(1, bus->pending());
+
+    bus->process();
+    TEST_ASSERT_TRUE(bus->submit(&txn));
+}
+
+void test_error_completes_with_status() {
+    uint8_t buf[2];
+    I2CTransaction txn[2];
+    txn[0].setRead(DEV, 0x10, &buf[0], 1);
+    txn[1].setRead(DEV, 0x11, &buf[1], 1);
+    bus->failAt = 0;
+
+    bus->submit(&txn[0]);
+    bus->submit(&txn[1]);
+    bus->process();
+
+    TEST_ASSERT_TRUE(txn[0].done());
+    TEST_ASSERT_FALSE(txn[0].ok());
+    TEST_ASSERT_EQUAL(I2C_ERROR, txn[0].status.load());
+    TEST_ASSERT_TRUE(txn[1].ok());
+}
+
+void test_register_helpers_round_trip() {
+    TEST_ASSERT_TRUE(bus->writeRegister(DEV, 0x02, 0x40));
+    TEST_ASSERT_EQUAL_HEX8(0x40, bus->regs[DEV][0x02]);
+
+    bus->regs[DEV][0x35] = 0x12;
+    bus->regs[DEV][0x36] = 0x34;
+    uint8_t buf[2] = {0, 0};
+    TEST_ASSERT_TRUE(bus->readRegisters(DEV, 0x35, buf, 2));
+    TEST_ASSERT_EQUAL_HEX8(0x12, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, buf[1]);
+
+    bus->failAt = (int)bus->log.size();
+    TEST_ASSERT_FALSE(bus->readRegisters(DEV, 0x35, buf, 2));
+}
+
+void test_signal_raised_per_completion() {
+    int token;
+    uint8_t buf[2];
+    I2CTransaction txn[2];
+    txn[0].setRead(DEV, 0x00, &buf[0], 1);
+    txn[0].signal = &token;
+    txn[1].setRead(DEV, 0x01, &buf[1], 1);
+
+    bus->submit(&txn[0]);
+    bus->submit(&txn[1]);
+    bus->process();
+
+    // Only transactions with a signal wake a waiter
+    TEST_ASSERT_EQUAL(1, bus->signals);
+}
+
+void test_cancel_removes_queued_transaction() {
+    uint8_t buf[3];
+    I2CTransaction txn[3];
+    for (int i = 0; i < 3; i++) {
+        txn[i].setRead(DEV, (uint8_t)i, &buf[i], 1);
+        bus->submit(&txn[i]);
+    }
+
+    TEST_ASSERT_TRUE(bus->cancel(&txn[1]));
+    TEST_ASSERT_EQUAL(I2C_TIMEOUT, txn[1].status.load());
+    TEST_ASSERT_EQUAL(2, bus->pending());
+    TEST_ASSERT_FALSE(bus->cancel(&txn[1]));
+
+    bus->process();
+    TEST_ASSERT_EQUAL(2, bus->log.size());
+    TEST_ASSERT_EQUAL_HEX8(0x00, bus->log[0].reg);
+    TEST_ASSERT_EQUAL_HEX8(0x02, bus->log[1].reg);
+    TEST_ASSERT_FALSE(bus->cancel(&txn[0]));
+}
+
+void test_timed_out_helper_leaves_nothing_queued() {
+    bus->stalled = true;
+    TEST_ASSERT_FALSE(bus->writeRegister(DEV, 0x02, 0x40));
+    TEST_ASSERT_EQUAL(0, bus->pending());
+
+    // The worker catching up later must not touch the dead stack frame
+    bus->process();
+    TEST_ASSERT_EQUAL(0, bus->log.size());
+    TEST_ASSERT_EQUAL_HEX8(0x00, bus->regs[DEV][0x02]);
+}
+
+int main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_transactions_run_in_submission_order);
+    RUN_TEST(test_pending_until_processed);
+    RUN_TEST(test_process_limit_completes_prefix);
+    RUN_TEST(test_queue_full_rejects);
+    RUN_TEST(test_in_flight_transaction_cannot_be_resubmitted);
+    RUN_TEST(test_error_completes_with_status);
+    RUN_TEST(test_register_helpers_round_trip);
+    RUN_TEST(test_cancel_removes_queued_transaction);
+    RUN_TEST(test_timed_out_helper_leaves_nothing_queued);
+    RUN_TEST(test_signal_raised_per_completion);
+    return UNITY_END();
+}
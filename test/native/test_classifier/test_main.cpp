@@ -0,0 +1,158 @@
+/*
+ * Slap classifier tests (host, int8 inference with the shipped model)
+ *
+ * Usage: pio test -e native -f native/test_classifier
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "SlapClassifier.h"
+
+#define N   CLASSIFIER_WINDOW
+#define DT  (1.0f / 224.2f)
+
+static SlapClassifier classifier;
+static float accelSq[N];
+static float gyroSq[N];
+
+void setUp() {
+    for (int i = 0; i < N; i++) {
+        accelSq[i] = 1.0f;      // at rest, 1 g
+        gyroSq[i] = 1.0f;       // 1 dps noise
+    }
+}
+
+void tearDown() {}
+
+void test_requantize_matches_real_multiplier() {
+    // 0.3 = 0.6 * 2^-1 -> Q31 mantissa, shift 32
+    int32_t mult = (int32_t)llround(0.6 * (1LL << 31));
+    const int32_t values[] = {0, 1, -1, 7, -7, 1000, -1000, 1500000, -1500000};
+    for (int32_t acc : values) {
+        TEST_ASSERT_EQUAL_INT32((int32_t)lround(acc * 0.3), SlapClassifier::requantize(acc, mult, 32));
+    }
+}
+
+void test_arena_layout() {
+    TEST_ASSERT_EQUAL(0, SlapClassifier::LOGITS_OFFSET % 4);
+    TEST_ASSERT_TRUE(SlapClassifier::HIDDEN_OFFSET >= CLASSIFIER_INPUTS);
+    TEST_ASSERT_TRUE(SlapClassifier::LOGITS_OFFSET >= SlapClassifier::HIDDEN_OFFSET + CLASSIFIER_HIDDEN);
+    TEST_ASSERT_EQUAL(SlapClassifier::LOGITS_OFFSET + CLASSIFIER_CLASSES * 4, SlapClassifier::ARENA_BYTES);
+    TEST_ASSERT_TRUE(sizeof(SlapClassifier) <= SlapClassifier::ARENA_BYTES + 4);
+}
+
+void test_input_quantization() {
+    accelSq[0] = accelSq[1] = 0;                // free fall: mean |a| - 1 = -1 g
+    accelSq[N - 2] = 25.0f;                     // pooled with 1 g: peak 5 g
+    gyroSq[N - 2] = gyroSq[N - 1] = 2000.0f * 2000.0f;
+
+    classifier.setInput(accelSq, gyroSq);
+    const int8_t *in = classifier.getInput();
+    int last = CLASSIFIER_STEPS - 1;
+
+    TEST_ASSERT_EQUAL_INT8((int8_t)lrintf(-127.0f / CLASSIFIER_ACCEL_MEAN_FS), in[0]);
+    TEST_ASSERT_EQUAL_INT8(0, in[1]);
+    TEST_ASSERT_EQUAL_INT8((int8_t)lrintf(4.0f / CLASSIFIER_ACCEL_PEAK_FS * 127.0f), in[CLASSIFIER_STEPS + last]);
+    TEST_ASSERT_EQUAL_INT8(127, in[2 * CLASSIFIER_STEPS + last]);   // clamped
+}
+
+// Same network in float on the same int8 input, no intermediate rounding
+static void referenceLogits(const int8_t *in, float *out) {
+    float h[CLASSIFIER_HIDDEN];
+    for (int j = 0; j < CLASSIFIER_HIDDEN; j++) {
+        double acc = SLAP_MODEL_B1[j];
+        for (int i = 0; i < CLASSIFIER_INPUTS; i++) acc += SLAP_MODEL_W1[j][i] * in[i];
+        double v = acc * SLAP_MODEL_M1[j] / pow(2.0, SLAP_MODEL_S1[j]);
+        h[j] = (float)(v < 0 ? 0 : (v > 127 ? 127 : v));
+    }
+    for (int k = 0; k < CLASSIFIER_CLASSES; k++) {
+        double acc = SLAP_MODEL_B2[k];
+        for (int j = 0; j < CLASSIFIER_HIDDEN; j++) acc += SLAP_MODEL_W2[k][j] * h[j];
+        out[k] = (float)(acc * SLAP_MODEL_OUT_SCALE[k]);
+    }
+}
+
+void test_integer_path_matches_reference() {
+    for (int i = 0; i < N; i++) {
+        float t = (i - CLASSIFIER_PRE) * DT;
+        float a = 1.0f + (t >= 0 ? 3.0f * expf(-t / 0.01f) : 0);
+        accelSq[i] = a * a;
+        gyroSq[i] = 900.0f;
+    }
+    classifier.classify(accelSq, gyroSq);
+
+    float ref[CLASSIFIER_CLASSES];
+    referenceLogits(classifier.getInput(), ref);
+    for (int k = 0; k < CLASSIFIER_CLASSES; k++) {
+        // One hidden LSB of rounding per unit at most
+        float tolerance = 0.5f + fabsf(ref[k]) * 0.05f;
+        TEST_ASSERT_FLOAT_WITHIN(tolerance, ref[k], classifier.getLogit(k));
+    }
+}
+
+void test_sharp_impact_is_slap() {
+    for (int i = CLASSIFIER_PRE; i < N; i++) {
+        float t = (i - CLASSIFIER_PRE) * DT;
+        float pulse = 3.0f * expf(-t / 0.012f) * cosf(2.0f * (float)M_PI * 40.0f * t);
+        accelSq[i] = 1.0f + pulse * pulse;      // sideways hit
+        float w = 60.0f * expf(-t / 0.03f);
+        gyroSq[i] = w * w;
+    }
+    SlapClassification result = classifier.classify(accelSq, gyroSq);
+    TEST_ASSERT_EQUAL(SLAP_CLASS_SLAP, result.label);
+    TEST_ASSERT_TRUE(result.confidence > 50 && result.confidence <= 100);
+}
+
+void test_free_fall_then_impact_is_drop() {
+    for (int i = 0; i < N; i++) {
+        float t = (i - CLASSIFIER_PRE) * DT;
+        if (t < 0 && t >= -0.15f) {
+            accelSq[i] = 0.0004f;
+            gyroSq[i] = 250.0f * 250.0f;
+        } else if (t >= 0) {
+            float a = 1.0f + 8.0f * expf(-t / 0.01f) * cosf(2.0f * (float)M_PI * 50.0f * t);
+            accelSq[i] = a * a;
+            float w = 250.0f * expf(-t / 0.05f);
+            gyroSq[i] = w * w;
+        }
+    }
+    SlapClassification result = classifier.classify(accelSq, gyroSq);
+    TEST_ASSERT_EQUAL(SLAP_CLASS_DROP, result.label);
+}
+
+void test_slow_heavy_push_is_bump() {
+    for (int i = 0; i < N; i++) {
+        float t = (i - CLASSIFIER_PRE) * DT;
+        float sway = 0.15f * sinf(2.0f * (float)M_PI * 1.5f * t);
+        float pulse = 0;
+        if (t >= 0) {
+            pulse = 1.2f * expf(-t / 0.1f) * cosf(2.0f * (float)M_PI * 6.0f * t);
+        } else if (t > -0.03f) {
+            pulse = 1.2f * (1.0f + t / 0.03f);
+        }
+        float a = 1.0f + pulse + sway;
+        accelSq[i] = a * a;
+        gyroSq[i] = 100.0f;
+    }
+    SlapClassification result = classifier.classify(accelSq, gyroSq);
+    TEST_ASSERT_EQUAL(SLAP_CLASS_BUMP, result.label);
+}
+
+void test_label_names() {
+    TEST_ASSERT_EQUAL_STRING("slap", SlapClassifier::labelName(SLAP_CLASS_SLAP));
+    TEST_ASSERT_EQUAL_STRING("drop", SlapClassifier::labelName(SLAP_CLASS_DROP));
+    TEST_ASSERT_EQUAL_STRING("unknown", SlapClassifier::labelName(SLAP_CLASS_UNKNOWN));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_requantize_matches_real_multiplier);
+    RUN_TEST(test_arena_layout);
+    RUN_TEST(test_input_quantization);
+    RUN_TEST(test_integer_path_matches_reference);
+    RUN_TEST(test_sharp_impact_is_slap);
+    RUN_TEST(test_free_fall_then_impact_is_drop);
+    RUN_TEST(test_slow_heavy_push_is_bump);
+    RUN_TEST(test_label_names);
+    return UNITY_END();
+}
@@ -0,0 +1,37 @@
+/*
+ * Detector Corpus Baseline
+ *
+ * Configurations the regression suite runs and the metrics they reached
+ * when last accepted. Update deliberately: paste the lines the suite
+ * prints, and say why in the commit. ns/sample is from the native_bench
+ * env (-O2) on a desktop x86-64 host; re-baseline it when the reference
+ * host changes.
+ */
+
+#ifndef DETECTOR_CORPUS_BASELINE_H
+#define DETECTOR_CORPUS_BASELINE_H
+
+#define CORPUS_METRIC_TOLERANCE 0.02f   // allowed drop in precision / recall
+#define CORPUS_SPEED_TOLERANCE  1.5f    // allowed ns/sample growth (factor)
+
+struct CorpusBaseline {
+    const char *name;
+    float threshold;            // g
+    float adaptiveK;            // 0 = fixed threshold
+    float jerkThreshold;        // g/s
+    bool fusion;
+    float detectPrecision;
+    float detectRecall;
+    float slapPrecision;
+    float slapRecall;
+    float nsPerSample;
+};
+
+static const CorpusBaseline CORPUS_BASELINE[] = {
+    {"high-pass", 1.00f, 0.0f, 50.0f, false, 1.000f, 0.932f, 0.974f, 0.884f, 90.6f},
+    {"fusion", 1.00f, 0.0f, 50.0f, true, 1.000f, 0.932f, 0.974f, 0.884f, 93.9f},
+    {"fusion-adaptive", 0.15f, 10.0f, 50.0f, true, 0.862f, 0.949f, 0.977f, 0.977f, 93.9f},
+    {"fusion-no-jerk", 1.00f, 0.0f, 0.0f, true, 1.000f, 0.932f, 1.000f, 0.884f, 93.5f},
+};
+
+#endif // DETECTOR_CORPUS_BASELINE_H
@@ -0,0 +1,321 @@
+/*
+ * Labeled Detector Corpus (host)
+ *
+ * Deterministic 6-axis traces with ground truth, built from the same
+ * parametric impacts as tools/classifier/Synthetic.h but as full sample
+ * streams through a simulated orientation (gravity follows the gyro):
+ *   desk-slaps      singles, doubles and triples, 1.3-6 g, any direction,
+ *                   and light taps around the 1 g threshold
+ *   desk-bumps      shoves and knocks: slow onset, low-frequency decay
+ *   drops           free fall with tumbling, hard impact, picked back up
+ *   idle-handling   tilts, flips and carrying, no impacts
+ *   idle-vibration  engine-like vibration, no impacts
+ *   vehicle-slaps   slaps on a board in heavy vibration, above any fixed
+ *                   threshold low enough for light taps: exercises the
+ *                   adaptive threshold
+ *
+ * Own RNG and Box-Muller so the corpus (and the stored baseline) is the
+ * same with every standard library.
+ */
+
+#ifndef DETECTOR_CORPUS_H
+#define DETECTOR_CORPUS_H
+
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#include "IMUTypes.h"
+#include "SlapClassifier.h"
+
+#define CORPUS_PERIOD_US   4460         // 224.2 Hz
+#define CORPUS_GYRO_RANGE  QMI8658C_GYRO_1024DPS
+
+struct CorpusImpact {
+    uint32_t onsetUs;
+    SlapClass label;
+};
+
+struct CorpusTrace {
+    const char *name;
+    std::vector<IMUSample> samples;
+    std::vector<CorpusImpact> impacts;
+};
+
+class CorpusRng {
+private:
+    uint64_t state;
+
+public:
+    explicit CorpusRng(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+    // xorshift64*
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return (uint32_t)((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+
+    float uniform(float a, float b) { return a + (b - a) * (next() >> 8) * (1.0f / 16777216.0f); }
+
+    float normal(float sigma) {
+        float u = (next() >> 8) * (1.0f / 16777216.0f) + 1e-7f;
+        float v = (next() >> 8) * (1.0f / 16777216.0f);
+        return sigma * sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+    }
+
+    void unit(float v[3]) {
+        float n;
+        do {
+            for (int i = 0; i < 3; i++) v[i] = normal(1.0f);
+            n = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        } while (n < 1e-3f);
+        for (int i = 0; i < 3; i++) v[i] /= n;
+    }
+};
+
+// Layers of motion in physical units, turned into sensor counts by build()
+class CorpusBuilder {
+private:
+    struct Motion {
+        float linear[3];        // g
+        float omega[3];         // dps
+        float gravity;          // 1, 0 in free fall
+    };
+
+    std::vector<Motion> motion;
+    std::vector<CorpusImpact> impacts;
+
+public:
+    CorpusRng rng;
+
+    CorpusBuilder(float seconds, uint64_t seed)
+        : motion((size_t)(seconds * 1e6f / CORPUS_PERIOD_US)), rng(seed) {
+        for (Motion &m : motion) {
+            m = Motion{{0, 0, 0}, {0, 0, 0}, 1.0f};
+        }
+    }
+
+    size_t index(float t) const { return (size_t)(t * 1e6f / CORPUS_PERIOD_US); }
+    float time(size_t i) const { return i * CORPUS_PERIOD_US * 1e-6f; }
+
+    // Turn by degrees about a sensor axis with a half-sine rate profile
+    void turn(float t, float seconds, const float axis[3], float degrees) {
+        size_t first = index(t), n = index(seconds);
+        float peakDps = degrees * (float)M_PI / (2.0f * seconds);
+        for (size_t k = 0; k < n && first + k < motion.size(); k++) {
+            float rate = peakDps * sinf((float)M_PI * (k + 0.5f) / n);
+            for (int a = 0; a < 3; a++) motion[first + k].omega[a] += rate * axis[a];
+        }
+    }
+
+    // Sinusoidal linear motion (vibration, sway, carrying)
+    void shake(float t, float seconds, const float dir[3], float g, float hz) {
+        size_t first = index(t), n = index(seconds);
+        for (size_t k = 0; k < n && first + k < motion.size(); k++) {
+            float v = g * sinf(2.0f * (float)M_PI * hz * time(k));
+            for (int a = 0; a < 3; a++) motion[first + k].linear[a] += v * dir[a];
+        }
+    }
+
+    // Damped oscillation starting at t (linear ramp of rise seconds before
+    // it) with a decaying spin about a random axis
+    void pulse(float t, const float dir[3], float g, float hz, float tau, float rise, float spinDps) {
+        float spin[3];
+        rng.unit(spin);
+        size_t onset = index(t);
+        size_t first = index(t - rise);
+        size_t last = index(t + 8 * tau + 0.1f);
+        for (size_t i = first; i <= last && i < motion.size(); i++) {
+            float s = time(i) - time(onset);
+            float v = 0, w = 0;
+            if (s >= 0) {
+                v = g * expf(-s / tau) * cosf(2.0f * (float)M_PI * hz * s);
+                w = spinDps * expf(-s / 0.03f);
+            } else if (rise > 0) {
+                v = g * (1.0f + s / rise);
+            }
+            for (int a = 0; a < 3; a++) {
+                motion[i].linear[a] += v * dir[a];
+                motion[i].omega[a] += w * spin[a];
+            }
+        }
+    }
+
+    void freeFall(float t, float seconds, float tumbleDps) {
+        float spin[3];
+        rng.unit(spin);
+        size_t first = index(t), n = index(seconds);
+        for (size_t k = 0; k < n && first + k < motion.size(); k++) {
+            motion[first + k].gravity = 0;
+            for (int a = 0; a < 3; a++) motion[first + k].omega[a] += tumbleDps * spin[a];
+        }
+    }
+
+    void label(float t, SlapClass cls) { impacts.push_back({(uint32_t)(index(t) * CORPUS_PERIOD_US), cls}); }
+
+    // Integrate the orientation, add sensor noise and gyro bias, quantize
+    // at the smallest accel range that fits (as auto-range would)
+    CorpusTrace build(const char *name, float gravityStart[3]) {
+        CorpusTrace trace;
+        trace.name = name;
+        trace.samples.resize(motion.size());
+        float g[3] = {gravityStart[0], gravityStart[1], gravityStart[2]};
+        float bias[3] = {rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1)};
+        float dt = CORPUS_PERIOD_US * 1e-6f;
+        float gScale = imuGyroScale(CORPUS_GYRO_RANGE);
+        const float rad = (float)M_PI / 180.0f;
+
+        for (size_t i = 0; i < motion.size(); i++) {
+            const Motion &m = motion[i];
+            float wx = m.omega[0] * rad, wy = m.omega[1] * rad, wz = m.omega[2] * rad;
+            float nx = g[0] + (g[1] * wz - g[2] * wy) * dt;
+            float ny = g[1] + (g[2] * wx - g[0] * wz) * dt;
+            float nz = g[2] + (g[0] * wy - g[1] * wx) * dt;
+            float inv = 1.0f / sqrtf(nx * nx + ny * ny + nz * nz);
+            g[0] = nx * inv;
+            g[1] = ny * inv;
+            g[2] = nz * inv;
+
+            float a[3], w[3], aMax = 0;
+            for (int k = 0; k < 3; k++) {
+                a[k] = m.gravity * g[k] + m.linear[k] + rng.normal(0.01f);
+                w[k] = m.omega[k] + bias[k] + rng.normal(0.5f);
+                if (fabsf(a[k]) > aMax) aMax = fabsf(a[k]);
+            }
+
+            IMUSample &s = trace.samples[i];
+            s.timestampUs = 1000000 + i * CORPUS_PERIOD_US;
+            s.accelRange = QMI8658C_ACCEL_2G;
+            while (s.accelRange < QMI8658C_ACCEL_16G && aMax >= 32767 * imuAccelScale(s.accelRange)) {
+                s.accelRange++;
+            }
+            float aScale = imuAccelScale(s.accelRange);
+            int16_t *counts[6] = {&s.accelX, &s.accelY, &s.accelZ, &s.gyroX, &s.gyroY, &s.gyroZ};
+            for (int k = 0; k < 6; k++) {
+                float c = roundf(k < 3 ? a[k] / aScale : w[k - 3] / gScale);
+                *counts[k] = (int16_t)fmaxf(-32768.0f, fminf(32767.0f, c));
+            }
+        }
+
+        for (CorpusImpact &impact : impacts) impact.onsetUs += 1000000;
+        trace.impacts = impacts;
+        return trace;
+    }
+};
+
+static inline void corpusSlap(CorpusBuilder &b, float t, float minG = 1.3f, float maxG = 6.0f) {
+    float dir[3];
+    b.rng.unit(dir);
+    b.pulse(t, dir, b.rng.uniform(minG, maxG), b.rng.uniform(20.0f, 60.0f),
+            b.rng.uniform(0.006f, 0.025f), b.rng.uniform(0.0f, 0.006f), b.rng.uniform(5.0f, 150.0f));
+    b.label(t, SLAP_CLASS_SLAP);
+}
+
+static inline std::vector<CorpusTrace> buildCorpus() {
+    std::vector<CorpusTrace> corpus;
+    float flat[3] = {0, 0, 1};
+
+    {
+        CorpusBuilder b(50.0f, 1);
+        float t = 1.0f;
+        for (int n = 0; n < 12; n++, t += b.rng.uniform(1.5f, 2.5f)) {
+            corpusSlap(b, t);
+        }
+        for (int burst = 0; burst < 6; burst++, t += 2.0f) {
+            int slaps = burst < 3 ? 2 : 3;
+            for (int n = 0; n < slaps; n++, t += b.rng.uniform(0.2f, 0.35f)) {
+                corpusSlap(b, t);
+            }
+        }
+        for (int n = 0; n < 6; n++, t += 1.5f) {
+            corpusSlap(b, t, 0.7f, 1.2f);
+        }
+        corpus.push_back(b.build("desk-slaps", flat));
+    }
+
+    {
+        CorpusBuilder b(24.0f, 2);
+        for (int n = 0; n < 10; n++) {
+            float t = 1.0f + n * 2.2f;
+            float dir[3];
+            b.rng.unit(dir);
+            b.shake(t - 0.5f, 0.5f, dir, b.rng.uniform(0.0f, 0.2f), b.rng.uniform(0.5f, 3.0f));
+            b.pulse(t, dir, b.rng.uniform(1.4f, 2.5f), b.rng.uniform(3.0f, 15.0f),
+                    b.rng.uniform(0.04f, 0.15f), b.rng.uniform(0.01f, 0.05f), b.rng.uniform(0.0f, 40.0f));
+            b.label(t, SLAP_CLASS_BUMP);
+        }
+        corpus.push_back(b.build("desk-bumps", flat));
+    }
+
+    {
+        CorpusBuilder b(30.0f, 3);
+        for (int n = 0; n < 6; n++) {
+            float t = 1.0f + n * 4.5f;
+            float fall = b.rng.uniform(0.08f, 0.22f);
+            float dir[3], axis[3];
+            b.freeFall(t, fall, b.rng.uniform(30.0f, 400.0f));
+            b.rng.unit(dir);
+            b.pulse(t + fall, dir, b.rng.uniform(3.0f, 12.0f), b.rng.uniform(30.0f, 90.0f),
+                    b.rng.uniform(0.004f, 0.02f), 0, b.rng.uniform(0.0f, 400.0f));
+            b.label(t + fall, SLAP_CLASS_DROP);
+
+            // Picked up and turned around a second later
+            b.rng.unit(axis);
+            b.turn(t + 1.5f, 1.5f, axis, b.rng.uniform(-120.0f, 120.0f));
+        }
+        corpus.push_back(b.build("drops", flat));
+    }
+
+    {
+        CorpusBuilder b(40.0f, 4);
+        const float x[3] = {1, 0, 0}, y[3] = {0, 1, 0}, z[3] = {0, 0, 1};
+        for (int n = 0; n < 6; n++) {
+            float t = 1.0f + n * 3.0f;
+            const float *axis = n % 2 ? x : y;
+            float deg = b.rng.uniform(60.0f, 90.0f);
+            b.turn(t, b.rng.uniform(0.25f, 0.5f), axis, deg);
+            b.turn(t + 1.5f, b.rng.uniform(0.25f, 0.5f), axis, -deg);
+        }
+        // Flipped over and back
+        b.turn(19.0f, 0.3f, x, 180.0f);
+        b.turn(21.0f, 0.3f, y, -180.0f);
+        // Carried: 2 Hz steps, swinging
+        b.shake(24.0f, 10.0f, z, 0.25f, 2.0f);
+        b.shake(24.0f, 10.0f, x, 0.1f, 1.0f);
+        b.turn(25.0f, 3.0f, y, 30.0f);
+        b.turn(29.0f, 3.0f, y, -30.0f);
+        // Set down onto the desk gently
+        b.pulse(36.0f, z, 0.4f, 8.0f, 0.05f, 0.02f, 0);
+        corpus.push_back(b.build("idle-handling", flat));
+    }
+
+    {
+        CorpusBuilder b(20.0f, 5);
+        float dir[3];
+        b.rng.unit(dir);
+        b.shake(0, 20.0f, dir, 0.15f, 27.0f);
+        b.rng.unit(dir);
+        b.shake(0, 20.0f, dir, 0.08f, 54.0f);
+        float tilted[3] = {0, 0.17f, 0.985f};
+        corpus.push_back(b.build("idle-vibration", tilted));
+    }
+
+    {
+        CorpusBuilder b(30.0f, 6);
+        float dir[3];
+        b.rng.unit(dir);
+        b.shake(0, 30.0f, dir, 0.35f, 23.0f);
+        b.rng.unit(dir);
+        b.shake(0, 30.0f, dir, 0.15f, 46.0f);
+        // After the noise estimate has filled
+        for (float t = 3.0f; t < 28.0f; t += b.rng.uniform(2.0f, 3.0f)) {
+            corpusSlap(b, t, 2.5f, 6.0f);
+        }
+        corpus.push_back(b.build("vehicle-slaps", flat));
+    }
+
+    return corpus;
+}
+
+#endif // DETECTOR_CORPUS_H
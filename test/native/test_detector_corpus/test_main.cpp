@@ -0,0 +1,169 @@
+/*
+ * Detector regression suite (host)
+ *
+ * Runs the labeled corpus (Corpus.h) through DetectionPipeline for each
+ * detector configuration and reports detection and slap precision /
+ * recall and ns per sample. Fails when a metric drops more than
+ * CORPUS_METRIC_TOLERANCE below Baseline.h, or (native_bench env, built
+ * with optimization) when ns/sample exceeds CORPUS_SPEED_TOLERANCE times
+ * the baseline. The measured values are printed in Baseline.h format for
+ * deliberate updates.
+ *
+ * Usage: pio test -e native -f native/test_detector_corpus -v
+ *        pio test -e native_bench -v       (also gates speed)
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "DetectionPipeline.h"
+#include "Corpus.h"
+#include "Baseline.h"
+
+#define MATCH_BEFORE_US   60000     // event peak vs labeled onset
+#define MATCH_AFTER_US    150000
+#define TIMING_PASSES     5
+#define FIFO_BATCH        16
+
+struct CorpusMetrics {
+    float detectPrecision, detectRecall;
+    float slapPrecision, slapRecall;
+    float nsPerSample;
+};
+
+static std::vector<CorpusTrace> corpus;
+
+static void configure(DetectionPipeline &pipeline, const CorpusBaseline &config) {
+    SlapDetectorConfig detector;
+    detector.jerkThreshold = config.jerkThreshold;
+    pipeline.setDetectorConfig(detector);
+    pipeline.setSamplePeriodUs(CORPUS_PERIOD_US);
+    pipeline.setGyroRange(CORPUS_GYRO_RANGE);
+    pipeline.setThreshold(config.threshold);
+    pipeline.setAdaptiveThreshold(config.adaptiveK > 0, config.adaptiveK);
+    pipeline.setFusion(config.fusion);
+    pipeline.begin();
+}
+
+template <typename Sink>
+static void replay(const CorpusTrace &trace, const CorpusBaseline &config, Sink &&sink) {
+    DetectionPipeline pipeline;
+    configure(pipeline, config);
+    const std::vector<IMUSample> &s = trace.samples;
+    for (size_t i = 0; i < s.size(); i += FIFO_BATCH) {
+        size_t count = s.size() - i < FIFO_BATCH ? s.size() - i : FIFO_BATCH;
+        pipeline.process(&s[i], count, sink);
+    }
+    pipeline.flush(sink);
+}
+
+static CorpusMetrics evaluate(const CorpusBaseline &config) {
+    int events = 0, matchedEvents = 0, truths = 0, matchedTruths = 0;
+    int slapEvents = 0, slapHits = 0, slapTruths = 0;
+
+    for (const CorpusTrace &trace : corpus) {
+        std::vector<SlapEvent> found;
+        replay(trace, config, [&found](const SlapEvent &e) { found.push_back(e); });
+
+        std::vector<bool> taken(trace.impacts.size(), false);
+        for (const SlapEvent &e : found) {
+            events++;
+            if (e.label == SLAP_CLASS_SLAP) slapEvents++;
+            for (size_t k = 0; k < trace.impacts.size(); k++) {
+                const CorpusImpact &truth = trace.impacts[k];
+                int32_t offset = (int32_t)(e.timestampUs - truth.onsetUs);
+                if (taken[k] || offset < -MATCH_BEFORE_US || offset > MATCH_AFTER_US) continue;
+                taken[k] = true;
+                matchedEvents++;
+                if (e.label == SLAP_CLASS_SLAP && truth.label == SLAP_CLASS_SLAP) slapHits++;
+                break;
+            }
+        }
+        for (size_t k = 0; k < trace.impacts.size(); k++) {
+            truths++;
+            if (taken[k]) matchedTruths++;
+            if (trace.impacts[k].label == SLAP_CLASS_SLAP) slapTruths++;
+        }
+    }
+
+    // Best of several passes: least disturbed by the host
+    double bestNs = 1e30;
+    size_t samples = 0;
+    for (const CorpusTrace &trace : corpus) samples += trace.samples.size();
+    for (int p = 0; p < TIMING_PASSES; p++) {
+        volatile uint32_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const CorpusTrace &trace : corpus) {
+            replay(trace, config, [&sink](const SlapEvent &e) { sink = sink + e.timestampUs; });
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / samples;
+        if (ns < bestNs) bestNs = ns;
+    }
+
+    CorpusMetrics m;
+    m.detectPrecision = events ? (float)matchedEvents / events : 1.0f;
+    m.detectRecall = truths ? (float)matchedTruths / truths : 1.0f;
+    m.slapPrecision = slapEvents ? (float)slapHits / slapEvents : 1.0f;
+    m.slapRecall = slapTruths ? (float)slapHits / slapTruths : 1.0f;
+    m.nsPerSample = (float)bestNs;
+
+    printf("%-16s events %3d/%3d  detect P %.3f R %.3f  slap P %.3f R %.3f  %6.1f ns/sample\n",
+           config.name, matchedEvents, events, m.detectPrecision, m.detectRecall,
+           m.slapPrecision, m.slapRecall, m.nsPerSample);
+    printf("    {\"%s\", %.2ff, %.1ff, %.1ff, %s, %.3ff, %.3ff, %.3ff, %.3ff, %.1ff},\n", config.name,
+           config.threshold, config.adaptiveK, config.jerkThreshold, config.fusion ? "true" : "false",
+           m.detectPrecision, m.detectRecall, m.slapPrecision, m.slapRecall, m.nsPerSample);
+    return m;
+}
+
+static void checkConfig(const char *name) {
+    const CorpusBaseline *config = nullptr;
+    for (const CorpusBaseline &b : CORPUS_BASELINE) {
+        if (strcmp(b.name, name) == 0) config = &b;
+    }
+    TEST_ASSERT_NOT_NULL(config);
+
+    CorpusMetrics m = evaluate(*config);
+    TEST_ASSERT_GREATER_OR_EQUAL(config->detectPrecision - CORPUS_METRIC_TOLERANCE, m.detectPrecision);
+    TEST_ASSERT_GREATER_OR_EQUAL(config->detectRecall - CORPUS_METRIC_TOLERANCE, m.detectRecall);
+    TEST_ASSERT_GREATER_OR_EQUAL(config->slapPrecision - CORPUS_METRIC_TOLERANCE, m.slapPrecision);
+    TEST_ASSERT_GREATER_OR_EQUAL(config->slapRecall - CORPUS_METRIC_TOLERANCE, m.slapRecall);
+#ifdef CORPUS_CHECK_SPEED
+    TEST_ASSERT_LESS_OR_EQUAL(config->nsPerSample * CORPUS_SPEED_TOLERANCE, m.nsPerSample);
+#endif
+}
+
+void setUp() {
+    if (corpus.empty()) corpus = buildCorpus();
+}
+
+void tearDown() {}
+
+void test_corpus_is_labeled() {
+    int impacts[SLAP_CLASS_DROP + 1] = {};
+    for (const CorpusTrace &trace : corpus) {
+        TEST_ASSERT_TRUE(trace.samples.size() > 0);
+        for (const CorpusImpact &impact : trace.impacts) impacts[impact.label]++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, impacts[SLAP_CLASS_SLAP]);
+    TEST_ASSERT_GREATER_THAN(0, impacts[SLAP_CLASS_BUMP]);
+    TEST_ASSERT_GREATER_THAN(0, impacts[SLAP_CLASS_DROP]);
+}
+
+void test_high_pass() { checkConfig("high-pass"); }
+void test_fusion() { checkConfig("fusion"); }
+void test_fusion_adaptive() { checkConfig("fusion-adaptive"); }
+void test_fusion_no_jerk_gate() { checkConfig("fusion-no-jerk"); }
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_corpus_is_labeled);
+    RUN_TEST(test_high_pass);
+    RUN_TEST(test_fusion);
+    RUN_TEST(test_fusion_adaptive);
+    RUN_TEST(test_fusion_no_jerk_gate);
+    return UNITY_END();
+}
@@ -0,0 +1,101 @@
+/*
+ * Dirty region tracking tests (host)
+ *
+ * Usage: pio test -e native -f native/test_dirty_region
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "DirtyRegion.h"
+
+#define W 128
+#define H 128
+
+static DirtyRegion region;
+static uint16_t now[W * H];
+static uint16_t shown[W * H];
+
+void setUp() {
+    region.clear();
+    memset(now, 0, sizeof(now));
+    memset(shown, 0, sizeof(shown));
+}
+
+void tearDown() {}
+
+void test_glyph_pixels_merge() {
+    // 5x7 glyph drawn pixel by pixel
+    for (int y = 0; y < 7; y++) {
+        for (int x = 0; x < 5; x += 2) region.add(20 + x, 40 + y, 1, 1);
+    }
+    TEST_ASSERT_EQUAL_INT(1, region.size());
+    TEST_ASSERT_EQUAL_INT(20, region[0].x);
+    TEST_ASSERT_EQUAL_INT(40, region[0].y);
+    TEST_ASSERT_EQUAL_INT(5, region[0].w);
+    TEST_ASSERT_EQUAL_INT(7, region[0].h);
+}
+
+void test_distant_rects_stay_apart() {
+    region.add(0, 0, 10, 10);
+    region.add(100, 100, 10, 10);
+    TEST_ASSERT_EQUAL_INT(2, region.size());
+
+    // A rectangle bridging both folds everything into one
+    region.add(0, 0, 110, 110);
+    TEST_ASSERT_EQUAL_INT(1, region.size());
+    TEST_ASSERT_EQUAL_INT(110 * 110, region[0].area());
+}
+
+void test_full_list_grows_least() {
+    for (int i = 0; i < DIRTY_MAX_RECTS; i++) region.add(i * 16, i * 16, 2, 2);
+    TEST_ASSERT_EQUAL_INT(DIRTY_MAX_RECTS, region.size());
+
+    region.add(3 * 16 + 8, 3 * 16 + 8, 2, 2);
+    TEST_ASSERT_EQUAL_INT(DIRTY_MAX_RECTS, region.size());
+    int32_t covered = 0;
+    for (int i = 0; i < region.size(); i++) covered += region[i].area();
+    // Joined a neighbour (10x10 box), not a far corner
+    TEST_ASSERT_EQUAL_INT((DIRTY_MAX_RECTS - 1) * 4 + 100, covered);
+}
+
+void test_trim_to_changed_pixels() {
+    // Dots row: 128x20 cleared and redrawn, only a 6x6 dot changed
+    for (int y = 100; y < 106; y++) {
+        for (int x = 70; x < 76; x++) now[y * W + x] = 0xFFE0;
+    }
+    DirtyRect r = {0, 95, 128, 20};
+    TEST_ASSERT_TRUE(DirtyRegion::trim(now, shown, W, r));
+    TEST_ASSERT_EQUAL_INT(70, r.x);
+    TEST_ASSERT_EQUAL_INT(100, r.y);
+    TEST_ASSERT_EQUAL_INT(6, r.w);
+    TEST_ASSERT_EQUAL_INT(6, r.h);
+}
+
+void test_trim_spans_rows() {
+    now[96 * W + 90] = 1;
+    now[110 * W + 10] = 1;
+    DirtyRect r = {0, 95, 128, 20};
+    TEST_ASSERT_TRUE(DirtyRegion::trim(now, shown, W, r));
+    TEST_ASSERT_EQUAL_INT(10, r.x);
+    TEST_ASSERT_EQUAL_INT(96, r.y);
+    TEST_ASSERT_EQUAL_INT(81, r.w);
+    TEST_ASSERT_EQUAL_INT(15, r.h);
+}
+
+void test_trim_unchanged() {
+    // Redrawn with the same content: nothing to send
+    for (int i = 0; i < W * H; i++) now[i] = shown[i] = (uint16_t)i;
+    DirtyRect r = {0, 0, W, H};
+    TEST_ASSERT_FALSE(DirtyRegion::trim(now, shown, W, r));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_glyph_pixels_merge);
+    RUN_TEST(test_distant_rects_stay_apart);
+    RUN_TEST(test_full_list_grows_least);
+    RUN_TEST(test_trim_to_changed_pixels);
+    RUN_TEST(test_trim_spans_rows);
+    RUN_TEST(test_trim_unchanged);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+/*
+ * Feature extraction tests (host, scalar reference path)
+ *
+ * Usage: pio test -e native -f native/test_features
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include "FeatureExtractor.h"
+
+#define N         FEATURE_WINDOW
+#define SAMPLE_HZ 256.0f   // bin spacing of exactly 2 Hz
+
+static FeatureExtractor extractor;
+static float window[N];
+
+void setUp() {
+    extractor.setSampleRate(SAMPLE_HZ);
+    extractor.begin();
+}
+
+void tearDown() {}
+
+static void sine(float amplitude, int bin) {
+    for (int i = 0; i < N; i++) {
+        window[i] = amplitude * sinf(2.0f * (float)M_PI * bin * i / N);
+    }
+}
+
+void test_sine_moments() {
+    SlapFeatures f;
+    sine(0.8f, 8);
+    extractor.extractScalar(window, f);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.8f / sqrtf(2.0f), f.rms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, sqrtf(2.0f), f.crest);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, 1.5f, f.kurtosis);
+}
+
+void test_sine_spectrum() {
+    SlapFeatures f;
+    sine(1.0f, 12);
+    extractor.extractScalar(window, f);
+
+    float binHz = SAMPLE_HZ / N;
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 12 * binHz, f.peakHz);
+    // Hann leakage is symmetric around the tone
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 12 * binHz, f.centroidHz);
+
+    const float *spectrum = extractor.getSpectrum();
+    TEST_ASSERT_TRUE(spectrum[12] > 100.0f * spectrum[20]);
+}
+
+void test_centroid_between_two_tones() {
+    SlapFeatures f;
+    for (int i = 0; i < N; i++) {
+        window[i] = sinf(2.0f * (float)M_PI * 8 * i / N) +
+                    sinf(2.0f * (float)M_PI * 24 * i / N);
+    }
+    extractor.extractScalar(window, f);
+
+    float binHz = SAMPLE_HZ / N;
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 16 * binHz, f.centroidHz);
+}
+
+void test_matches_direct_dft() {
+    srand(7);
+    for (int i = 0; i < N; i++) {
+        window[i] = (rand() % 2001 - 1000) / 1000.0f;
+    }
+    SlapFeatures f;
+    extractor.extractScalar(window, f);
+
+    // O(N^2) DFT of the Hann-windowed input
+    const float *spectrum = extractor.getSpectrum();
+    for (int k = 1; k < N / 2; k++) {
+        double re = 0, im = 0;
+        for (int i = 0; i < N; i++) {
+            double w = 0.5 - 0.5 * cos(2.0 * M_PI * i / (N - 1));
+            re += window[i] * w * cos(2.0 * M_PI * k * i / N);
+            im -= window[i] * w * sin(2.0 * M_PI * k * i / N);
+        }
+        double p = re * re + im * im;
+        TEST_ASSERT_FLOAT_WITHIN(1e-3 * p + 1e-3, p, spectrum[k]);
+    }
+}
+
+void test_impulse_is_peaky() {
+    SlapFeatures f;
+    for (int i = 0; i < N; i++) window[i] = 0;
+    window[N / 2] = 2.0f;
+    window[N / 2 + 1] = -1.0f;
+    extractor.extractScalar(window, f);
+
+    TEST_ASSERT_TRUE(f.kurtosis > 30.0f);
+    TEST_ASSERT_TRUE(f.crest > 8.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, sqrtf(5.0f / N), f.rms);
+}
+
+void test_silence_is_zero() {
+    SlapFeatures f;
+    for (int i = 0; i < N; i++) window[i] = 0;
+    extractor.extractScalar(window, f);
+
+    TEST_ASSERT_EQUAL_FLOAT(0, f.rms);
+    TEST_ASSERT_EQUAL_FLOAT(0, f.crest);
+    TEST_ASSERT_EQUAL_FLOAT(0, f.kurtosis);
+    TEST_ASSERT_EQUAL_FLOAT(0, f.centroidHz);
+    TEST_ASSERT_EQUAL_FLOAT(0, f.peakHz);
+}
+
+void test_extract_matches_reference() {
+    srand(11);
+    for (int i = 0; i < N; i++) {
+        window[i] = (rand() % 2001 - 1000) / 500.0f;
+    }
+    SlapFeatures ref, fast;
+    extractor.extractScalar(window, ref);
+    extractor.extract(window, fast);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, ref.rms, fast.rms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, ref.crest, fast.crest);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, ref.kurtosis, fast.kurtosis);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, ref.centroidHz, fast.centroidHz);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, ref.peakHz, fast.peakHz);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sine_moments);
+    RUN_TEST(test_sine_spectrum);
+    RUN_TEST(test_centroid_between_two_tones);
+    RUN_TEST(test_matches_direct_dft);
+    RUN_TEST(test_impulse_is_peaky);
+    RUN_TEST(test_silence_is_zero);
+    RUN_TEST(test_extract_matches_reference);
+    return UNITY_END();
+}
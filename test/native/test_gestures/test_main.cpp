@@ -0,0 +1,123 @@
+/*
+ * Gesture recognizer tests (host)
+ *
+ * Usage: pio test -e native -f native/test_gestures
+ */
+
+#include <unity.h>
+#include "GestureRecognizer.h"
+
+#define MS 1000UL
+
+static GestureRecognizer *recognizer;
+static GestureEvent gesture;
+
+void setUp() {
+    recognizer = new GestureRecognizer();
+    GestureConfig config;
+    config.windowUs = 400 * MS;
+    recognizer->setConfig(config);
+}
+
+void tearDown() {
+    delete recognizer;
+}
+
+void test_single_after_window() {
+    TEST_ASSERT_FALSE(recognizer->addSlap(1000 * MS, 1.5f, 1100 * MS, gesture));
+    TEST_ASSERT_TRUE(recognizer->isPending());
+
+    // Horizon not yet past the window
+    TEST_ASSERT_FALSE(recognizer->poll(1400 * MS, 1500 * MS, gesture));
+    TEST_ASSERT_TRUE(recognizer->poll(1401 * MS, 1500 * MS, gesture));
+
+    TEST_ASSERT_EQUAL(GESTURE_SINGLE, gesture.gesture);
+    TEST_ASSERT_EQUAL_UINT32(500 * MS, gesture.latencyUs);
+    TEST_ASSERT_FALSE(recognizer->isPending());
+}
+
+void test_double() {
+    recognizer->addSlap(1000 * MS, 1.2f, 1100 * MS, gesture);
+    TEST_ASSERT_FALSE(recognizer->addSlap(1300 * MS, 2.0f, 1400 * MS, gesture));
+    TEST_ASSERT_FALSE(recognizer->poll(1650 * MS, 1750 * MS, gesture));
+    TEST_ASSERT_TRUE(recognizer->poll(1750 * MS, 1850 * MS, gesture));
+
+    TEST_ASSERT_EQUAL(GESTURE_DOUBLE, gesture.gesture);
+    TEST_ASSERT_EQUAL_UINT32(1000 * MS, gesture.firstUs);
+    TEST_ASSERT_EQUAL_UINT32(1300 * MS, gesture.lastUs);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, gesture.peak);
+}
+
+void test_triple_is_immediate() {
+    recognizer->addSlap(1000 * MS, 1.0f, 1100 * MS, gesture);
+    recognizer->addSlap(1300 * MS, 1.0f, 1400 * MS, gesture);
+    TEST_ASSERT_TRUE(recognizer->addSlap(1600 * MS, 1.0f, 1650 * MS, gesture));
+
+    TEST_ASSERT_EQUAL(GESTURE_TRIPLE, gesture.gesture);
+    TEST_ASSERT_EQUAL_UINT32(50 * MS, gesture.latencyUs);
+    TEST_ASSERT_FALSE(recognizer->isPending());
+}
+
+void test_slow_pipeline_does_not_split() {
+    // The second slap is delivered late, but the horizon held back: no
+    // gesture may end before it arrives
+    recognizer->addSlap(1000 * MS, 1.0f, 1100 * MS, gesture);
+    TEST_ASSERT_FALSE(recognizer->poll(1299 * MS, 1600 * MS, gesture));
+    TEST_ASSERT_FALSE(recognizer->addSlap(1300 * MS, 1.0f, 1700 * MS, gesture));
+    TEST_ASSERT_TRUE(recognizer->poll(1701 * MS, 1800 * MS, gesture));
+    TEST_ASSERT_EQUAL(GESTURE_DOUBLE, gesture.gesture);
+}
+
+void test_late_slap_starts_new_sequence() {
+    // Poll missed: the late slap flushes the single and starts over
+    recognizer->addSlap(1000 * MS, 1.0f, 1100 * MS, gesture);
+    TEST_ASSERT_TRUE(recognizer->addSlap(1500 * MS, 1.0f, 1600 * MS, gesture));
+    TEST_ASSERT_EQUAL(GESTURE_SINGLE, gesture.gesture);
+    TEST_ASSERT_EQUAL(1, recognizer->getPendingSlaps());
+}
+
+void test_horizon_behind_last_slap() {
+    // Horizon read before the slap was drained
+    recognizer->addSlap(1000 * MS, 1.0f, 1100 * MS, gesture);
+    TEST_ASSERT_FALSE(recognizer->poll(900 * MS, 1100 * MS, gesture));
+}
+
+void test_wraparound() {
+    uint32_t t = 0xFFFFFFFFUL - 100 * MS;
+    recognizer->addSlap(t, 1.0f, t, gesture);
+    recognizer->addSlap(t + 300 * MS, 1.0f, t + 300 * MS, gesture);
+    TEST_ASSERT_FALSE(recognizer->poll(t + 500 * MS, t + 500 * MS, gesture));
+    TEST_ASSERT_TRUE(recognizer->poll(t + 701 * MS, t + 701 * MS, gesture));
+    TEST_ASSERT_EQUAL(GESTURE_DOUBLE, gesture.gesture);
+    TEST_ASSERT_EQUAL_UINT32(401 * MS, gesture.latencyUs);
+}
+
+void test_bindings_and_stats() {
+    recognizer->setActions(GESTURE_DOUBLE, GESTURE_ACTION_LED);
+    recognizer->addSlap(1000 * MS, 1.0f, 1100 * MS, gesture);
+    recognizer->addSlap(1200 * MS, 1.0f, 1300 * MS, gesture);
+    recognizer->poll(1700 * MS, 1900 * MS, gesture);
+    TEST_ASSERT_EQUAL(GESTURE_ACTION_LED, gesture.actions);
+
+    recognizer->addSlap(5000 * MS, 1.0f, 5100 * MS, gesture);
+    recognizer->poll(5500 * MS, 5600 * MS, gesture);
+    TEST_ASSERT_EQUAL(GESTURE_ACTION_DISPLAY | GESTURE_ACTION_NETWORK, gesture.actions);
+
+    TEST_ASSERT_EQUAL_UINT32(1, recognizer->getRecognized(GESTURE_SINGLE));
+    TEST_ASSERT_EQUAL_UINT32(1, recognizer->getRecognized(GESTURE_DOUBLE));
+    TEST_ASSERT_EQUAL_UINT32(700 * MS, recognizer->getMaxLatencyUs());
+    TEST_ASSERT_EQUAL_UINT32(600 * MS, recognizer->getLastLatencyUs());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_after_window);
+    RUN_TEST(test_double);
+    RUN_TEST(test_triple_is_immediate);
+    RUN_TEST(test_slow_pipeline_does_not_split);
+    RUN_TEST(test_late_slap_starts_new_sequence);
+    RUN_TEST(test_horizon_behind_last_slap);
+    RUN_TEST(test_wraparound);
+    RUN_TEST(test_bindings_and_stats);
+    return UNITY_END();
+}
@@ -0,0 +1,87 @@
+/*
+ * Adaptive noise floor tests (host)
+ *
+ * Usage: pio test -e native -f native/test_noise_floor
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <random>
+#include "NoiseFloor.h"
+
+static NoiseFloorEstimator *noise;
+static std::mt19937 rng;
+
+void setUp() {
+    noise = new NoiseFloorEstimator();
+    rng.seed(1);
+}
+
+void tearDown() {
+    delete noise;
+}
+
+// |a| of isotropic Gaussian noise with the given sigma per axis
+static float gaussianMagnitude(float sigma) {
+    std::normal_distribution<float> n(0.0f, sigma);
+    float x = n(rng), y = n(rng), z = n(rng);
+    return sqrtf(x * x + y * y + z * z);
+}
+
+void test_not_ready_until_filled() {
+    for (int i = 0; i < NOISE_MIN_FILL - 1; i++) noise->push(0.01f);
+    TEST_ASSERT_FALSE(noise->isReady());
+    TEST_ASSERT_EQUAL_FLOAT(0, noise->update());
+    noise->push(0.01f);
+    TEST_ASSERT_TRUE(noise->isReady());
+}
+
+void test_recovers_gaussian_sigma() {
+    const float sigmas[] = {0.002f, 0.005f, 0.02f};
+    for (float sigma : sigmas) {
+        noise->reset();
+        for (int i = 0; i < NOISE_WINDOW; i++) noise->push(gaussianMagnitude(sigma));
+        // Bin width and sampling error
+        TEST_ASSERT_FLOAT_WITHIN(sigma * 0.06f + NOISE_BIN_G, sigma, noise->update());
+    }
+}
+
+void test_impacts_do_not_raise_the_floor() {
+    for (int i = 0; i < NOISE_WINDOW; i++) {
+        // 20% of the window inside large impacts
+        bool impact = (i % 100) < 20;
+        noise->push(impact ? 3.0f : gaussianMagnitude(0.005f));
+    }
+    float sigma = noise->update();
+    TEST_ASSERT_TRUE(sigma > 0.005f && sigma < 0.008f);
+}
+
+void test_window_slides() {
+    for (int i = 0; i < NOISE_WINDOW; i++) noise->push(gaussianMagnitude(0.003f));
+    float quiet = noise->update();
+
+    // Move to a vehicle: the old samples age out after one window
+    for (int i = 0; i < NOISE_WINDOW; i++) noise->push(gaussianMagnitude(0.03f));
+    float loud = noise->update();
+
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 0.003f, quiet);
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 0.03f, loud);
+    TEST_ASSERT_EQUAL(NOISE_WINDOW, noise->getCount());
+}
+
+void test_saturates_at_top_bin() {
+    for (int i = 0; i < NOISE_WINDOW; i++) noise->push(10.0f);
+    float sigma = noise->update();
+    TEST_ASSERT_TRUE(sigma <= NOISE_BINS * NOISE_BIN_G / 1.5382f);
+    TEST_ASSERT_TRUE(sigma > (NOISE_BINS - 1) * NOISE_BIN_G / 1.5382f);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_not_ready_until_filled);
+    RUN_TEST(test_recovers_gaussian_sigma);
+    RUN_TEST(test_impacts_do_not_raise_the_floor);
+    RUN_TEST(test_window_slides);
+    RUN_TEST(test_saturates_at_top_bin);
+    return UNITY_END();
+}
@@ -0,0 +1,104 @@
+/*
+ * Orientation filter tests (host)
+ *
+ * Usage: pio test -e native -f native/test_orientation
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "OrientationFilter.h"
+
+#define SAMPLE_HZ 224.2f
+#define DT        (1.0f / SAMPLE_HZ)
+#define DEG       ((float)M_PI / 180.0f)
+
+static OrientationFilter filter;
+
+void setUp() {
+    filter.setConfig(OrientationConfig());
+    filter.reset();
+}
+
+void tearDown() {}
+
+static float linearMagnitude() {
+    const float *l = filter.getLinear();
+    return sqrtf(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+}
+
+void test_levels_to_first_sample() {
+    // 30 degrees of roll
+    float ay = sinf(30 * DEG), az = cosf(30 * DEG);
+    filter.update(0, ay, az, 0, 0, 0, DT);
+
+    TEST_ASSERT_TRUE(filter.isInitialized());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, ay, filter.getGravity()[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, az, filter.getGravity()[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 30.0f, filter.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0, linearMagnitude());
+}
+
+void test_rotation_does_not_leak() {
+    // Roll at 180 dps for one second; accel sees only the turning gravity
+    filter.update(0, 0, 1, 0, 0, 0, DT);
+    float worst = 0;
+    for (int i = 1; i <= (int)SAMPLE_HZ; i++) {
+        float angle = 180.0f * DEG * i * DT;
+        filter.update(0, sinf(angle), cosf(angle), 180.0f, 0, 0, DT);
+        if (linearMagnitude() > worst) worst = linearMagnitude();
+    }
+    TEST_ASSERT_TRUE(worst < 0.002f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -1.0f, filter.getGravity()[2]);
+}
+
+void test_tracks_gyro_bias() {
+    // 2 dps of bias on X while lying still
+    for (int i = 0; i < 120 * (int)SAMPLE_HZ; i++) {
+        filter.update(0, 0, 1, 2.0f, 0, 0, DT);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, -2.0f, filter.getBiasCorrection(0));
+    TEST_ASSERT_TRUE(linearMagnitude() < 0.002f);
+}
+
+void test_impacts_do_not_tilt() {
+    for (int i = 0; i < 100; i++) filter.update(0, 0, 1, 0, 0, 0, DT);
+
+    // 3 g slap along X for 20 ms
+    for (int i = 0; i < 5; i++) {
+        filter.update(3.0f, 0, 1, 0, 0, 0, DT);
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 3.0f, filter.getLinear()[0]);
+    }
+    filter.update(0, 0, 1, 0, 0, 0, DT);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0, linearMagnitude());
+}
+
+void test_converges_after_tilt_without_gyro() {
+    // Board tilted while the gyro reports nothing: accel pulls it back
+    filter.update(0, 0, 1, 0, 0, 0, DT);
+    float ay = sinf(10 * DEG), az = cosf(10 * DEG);
+    for (int i = 0; i < 5 * (int)SAMPLE_HZ; i++) {
+        filter.update(0, ay, az, 0, 0, 0, DT);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 10.0f, filter.getRoll());
+}
+
+void test_quaternion_stays_normalized() {
+    filter.update(0, 0, 1, 0, 0, 0, DT);
+    for (int i = 0; i < 10000; i++) {
+        filter.update(0.1f, -0.2f, 0.9f, 300.0f, -150.0f, 75.0f, DT);
+    }
+    const float *q = filter.getQuaternion();
+    float norm = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, norm);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_levels_to_first_sample);
+    RUN_TEST(test_rotation_does_not_leak);
+    RUN_TEST(test_tracks_gyro_bias);
+    RUN_TEST(test_impacts_do_not_tilt);
+    RUN_TEST(test_converges_after_tilt_without_gyro);
+    RUN_TEST(test_quaternion_stays_normalized);
+    return UNITY_END();
+}
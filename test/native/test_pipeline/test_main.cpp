@@ -0,0 +1,152 @@
+/*
+ * Detection pipeline tests (host)
+ *
+ * Usage: pio test -e native -f native/test_pipeline
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "DetectionPipeline.h"
+
+#define PERIOD_US   4460
+#define TRACE_LEN   2000
+
+static std::vector<IMUSample> trace;
+static std::vector<SlapEvent> events;
+
+static const int impactAt[] = {400, 700, 1300};
+
+// Board flat, small noise, 3 g damped 40 Hz impacts along X
+static void buildTrace() {
+    trace.assign(TRACE_LEN, IMUSample());
+    uint32_t seed = 7;
+    auto noise = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (int16_t)((int)(seed >> 24) - 128);
+    };
+    float countsPerG = 1.0f / imuAccelScale(QMI8658C_ACCEL_4G);
+    for (int i = 0; i < TRACE_LEN; i++) {
+        IMUSample &s = trace[i];
+        s.timestampUs = 1000000 + i * PERIOD_US;
+        s.accelRange = QMI8658C_ACCEL_4G;
+        float ax = 0;
+        for (int at : impactAt) {
+            float t = (i - at) * PERIOD_US * 1e-6f;
+            if (t >= 0 && t < 0.06f) ax += 3.0f * expf(-t / 0.012f) * sinf(2 * (float)M_PI * 40 * t);
+        }
+        s.accelX = (int16_t)(ax * countsPerG) + noise();
+        s.accelY = noise();
+        s.accelZ = (int16_t)countsPerG + noise();
+        s.gyroX = noise() / 16;
+        s.gyroY = noise() / 16;
+        s.gyroZ = noise() / 16;
+    }
+}
+
+static void collect(const SlapEvent &e) { events.push_back(e); }
+
+static void run(DetectionPipeline &pipeline, size_t batch) {
+    for (size_t i = 0; i < trace.size(); i += batch) {
+        size_t count = trace.size() - i < batch ? trace.size() - i : batch;
+        pipeline.process(&trace[i], count, collect);
+    }
+    pipeline.flush(collect);
+}
+
+void setUp() {
+    if (trace.empty()) buildTrace();
+    events.clear();
+}
+
+void tearDown() {}
+
+void test_detects_each_impact_in_order() {
+    DetectionPipeline pipeline;
+    pipeline.setSamplePeriodUs(PERIOD_US);
+    run(pipeline, 16);
+
+    TEST_ASSERT_EQUAL(3, events.size());
+    for (size_t n = 0; n < events.size(); n++) {
+        uint32_t impactUs = trace[impactAt[n]].timestampUs;
+        TEST_ASSERT_UINT32_WITHIN(20000, impactUs + 10000, events[n].timestampUs);
+        TEST_ASSERT_EQUAL(1, events[n].direction);
+        TEST_ASSERT_TRUE(events[n].peak > 1.0f);
+        TEST_ASSERT_NOT_EQUAL(SLAP_CLASS_UNKNOWN, events[n].label);
+        TEST_ASSERT_TRUE(events[n].features.rms > 0);
+    }
+}
+
+void test_batch_size_does_not_change_events() {
+    DetectionPipeline single;
+    single.setSamplePeriodUs(PERIOD_US);
+    run(single, 1);
+    std::vector<SlapEvent> reference = events;
+
+    events.clear();
+    DetectionPipeline batched;
+    batched.setSamplePeriodUs(PERIOD_US);
+    run(batched, 128);
+
+    TEST_ASSERT_EQUAL(reference.size(), events.size());
+    for (size_t n = 0; n < events.size(); n++) {
+        TEST_ASSERT_EQUAL_UINT32(reference[n].timestampUs, events[n].timestampUs);
+        TEST_ASSERT_EQUAL_FLOAT(reference[n].peak, events[n].peak);
+        TEST_ASSERT_EQUAL(reference[n].label, events[n].label);
+        TEST_ASSERT_EQUAL(reference[n].confidence, events[n].confidence);
+    }
+}
+
+void test_threshold_above_impacts_finds_nothing() {
+    DetectionPipeline pipeline;
+    pipeline.setSamplePeriodUs(PERIOD_US);
+    pipeline.setThreshold(5.0f);
+    run(pipeline, 16);
+    TEST_ASSERT_EQUAL(0, events.size());
+}
+
+void test_horizon_holds_back_for_unfinished_events() {
+    DetectionPipeline pipeline;
+    pipeline.setSamplePeriodUs(PERIOD_US);
+
+    // Quiet: everything up to the newest sample is final
+    pipeline.process(&trace[0], 300, collect);
+    uint32_t newest = trace[299].timestampUs;
+    TEST_ASSERT_EQUAL_UINT32(newest, pipeline.getHorizonUs(newest));
+
+    // Just past the first impact: the event waits for classification
+    // and nothing it could emit lies beyond the horizon
+    pipeline.process(&trace[300], 110, collect);
+    newest = trace[409].timestampUs;
+    uint32_t horizon = pipeline.getHorizonUs(newest);
+    TEST_ASSERT_EQUAL(0, events.size());
+    TEST_ASSERT_TRUE(horizon < trace[impactAt[0]].timestampUs + 20000);
+
+    pipeline.process(&trace[410], 200, collect);
+    TEST_ASSERT_EQUAL(1, events.size());
+    TEST_ASSERT_TRUE(events[0].timestampUs > horizon);
+    newest = trace[609].timestampUs;
+    TEST_ASSERT_EQUAL_UINT32(newest, pipeline.getHorizonUs(newest));
+}
+
+void test_idle_emits_waiting_event() {
+    DetectionPipeline pipeline;
+    pipeline.setSamplePeriodUs(PERIOD_US);
+    pipeline.process(&trace[0], 410, collect);
+    TEST_ASSERT_EQUAL(0, events.size());
+
+    pipeline.idle(&trace[410], 16, collect);
+    TEST_ASSERT_EQUAL(1, events.size());
+    uint32_t newest = trace[425].timestampUs;
+    TEST_ASSERT_EQUAL_UINT32(newest, pipeline.getHorizonUs(newest));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_detects_each_impact_in_order);
+    RUN_TEST(test_batch_size_does_not_change_events);
+    RUN_TEST(test_threshold_above_impacts_finds_nothing);
+    RUN_TEST(test_horizon_holds_back_for_unfinished_events);
+    RUN_TEST(test_idle_emits_waiting_event);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/*
+ * Temperature compensation learner tests (host)
+ *
+ * Usage: pio test -e native -f native/test_temp_comp
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "TempCompLearner.h"
+
+static TempCompLearner learner;
+static uint32_t seed;
+
+// Small uniform noise, well inside TEMPCOMP_MAX_SPREAD_G
+static float noise(float amplitude) {
+    seed = seed * 1664525u + 1013904223u;
+    return ((int)(seed >> 16 & 0xFFFF) - 32768) / 32768.0f * amplitude;
+}
+
+// One window of a still board: gravity along `down`, bias drifting by
+// `slope` g/C from 0 at 20 C
+static void stillWindow(const float down[3], const float slope[3], float tempC) {
+    float gyro[3] = {0, 0, 0};
+    for (int n = 0; n < TEMPCOMP_WINDOW_SAMPLES; n++) {
+        float accel[3];
+        for (int i = 0; i < 3; i++) {
+            accel[i] = down[i] + slope[i] * (tempC - 20.0f) + noise(0.004f);
+        }
+        for (int i = 0; i < 3; i++) gyro[i] = noise(0.3f);
+        learner.addSample(accel, gyro, tempC);
+    }
+}
+
+static void movingWindow(float tempC) {
+    for (int n = 0; n < TEMPCOMP_WINDOW_SAMPLES; n++) {
+        float accel[3] = {0.3f * sinf(n * 0.2f), 0, 1.0f};
+        float gyro[3] = {40.0f, 0, 0};
+        learner.addSample(accel, gyro, tempC);
+    }
+}
+
+static const float flat[3] = {0, 0, 1.0f};
+static const float drift[3] = {0.001f, -0.0005f, 0.0008f};
+
+void setUp() {
+    learner.reset();
+    seed = 11;
+}
+
+void tearDown() {}
+
+void test_recovers_slope_over_range() {
+    // A day in a room: 15 -> 25 C, several windows per bin
+    for (float t = 15.0f; t <= 25.0f; t += 0.1f) {
+        stillWindow(flat, drift, t);
+    }
+    TempCompFit f = learner.fit();
+    TEST_ASSERT_TRUE(f.ready);
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 15.0f, f.minTempC);  // bin means
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 25.0f, f.maxTempC);
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 20.0f, f.meanTempC);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.00005f, drift[i], f.slope[i]);
+    }
+}
+
+void test_not_ready_below_min_span() {
+    for (float t = 20.0f; t < 20.0f + TEMPCOMP_MIN_SPAN_C - 1.0f; t += 0.1f) {
+        stillWindow(flat, drift, t);
+    }
+    TempCompFit f = learner.fit();
+    TEST_ASSERT_FALSE(f.ready);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEMPCOMP_MIN_BINS, f.bins);
+
+    IMUTempCompensation active = {}, out;
+    TEST_ASSERT_FALSE(TempCompLearner::compose(active, f, out));
+}
+
+void test_moving_windows_rejected() {
+    stillWindow(flat, drift, 20.0f);
+    movingWindow(21.0f);
+    movingWindow(22.0f);
+    TEST_ASSERT_EQUAL_UINT32(1, learner.getStillWindows());
+    TEST_ASSERT_EQUAL_UINT32(2, learner.getMovedWindows());
+    TEST_ASSERT_EQUAL_INT(1, learner.fit().bins);
+}
+
+void test_pose_change_restarts() {
+    for (float t = 15.0f; t <= 25.0f; t += 0.5f) {
+        stillWindow(flat, drift, t);
+    }
+    TEST_ASSERT_TRUE(learner.fit().ready);
+
+    // Board turned on its side: only the new pose counts
+    const float side[3] = {1.0f, 0, 0};
+    stillWindow(side, drift, 25.0f);
+    TEST_ASSERT_EQUAL_UINT32(1, learner.getPoseChanges());
+    TEST_ASSERT_EQUAL_UINT32(1, learner.getStillWindows());
+    TEST_ASSERT_FALSE(learner.fit().ready);
+    TEST_ASSERT_TRUE(learner.hasPose());
+}
+
+void test_compose_keeps_reference() {
+    TempCompFit f = {};
+    f.ready = true;
+    f.meanTempC = 30.0f;
+    f.slope[0] = 0.0004f;
+    f.slope[1] = -0.0002f;
+
+    IMUTempCompensation none = {}, out;
+    TEST_ASSERT_TRUE(TempCompLearner::compose(none, f, out));
+    TEST_ASSERT_TRUE(out.valid);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, out.refTempC);
+    TEST_ASSERT_EQUAL_FLOAT(0.0004f, out.accelSlope[0]);
+
+    // Residual on top of an active model keeps its reference temperature
+    IMUTempCompensation active = {true, 22.0f, {0.001f, 0.001f, 0}};
+    TEST_ASSERT_TRUE(TempCompLearner::compose(active, f, out));
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, out.refTempC);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7f, 0.0014f, out.accelSlope[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7f, 0.0008f, out.accelSlope[1]);
+
+    // Beyond plausible drift
+    f.slope[2] = TEMPCOMP_MAX_SLOPE * 2;
+    TEST_ASSERT_FALSE(TempCompLearner::compose(none, f, out));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_recovers_slope_over_range);
+    RUN_TEST(test_not_ready_below_min_span);
+    RUN_TEST(test_moving_windows_rejected);
+    RUN_TEST(test_pose_change_restarts);
+    RUN_TEST(test_compose_keeps_reference);
+    return UNITY_END();
+}
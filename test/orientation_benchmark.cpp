@@ -0,0 +1,168 @@
+/*
+ * Orientation Benchmark - cycles per update
+ * Runs the Mahony orientation filter over a synthetic trace (board tipped
+ * 90 degrees and back, plus periodic impacts) and reports CPU cycles per
+ * update, then compares the slap detector with high-pass-only and
+ * gyro-fused gravity removal on the same trace: events found and the
+ * largest |a| the detector sees while the board turns (rotation leak).
+ * No sensor needed.
+ *
+ * Usage: copy to src/main.cpp, build and upload, open serial monitor.
+ */
+
+#include <Arduino.h>
+#include "QMI8658C.h"
+#include "OrientationFilter.h"
+#include "SlapDetector.h"
+
+#define TRACE_LEN  2048
+#define PASSES     20
+#define SAMPLE_HZ  224.2f
+#define PERIOD     512      // tip, tip back, one impact per period
+#define TIP_LEN    56       // samples per 90 degree turn (~400 dps)
+
+IMUSample trace[TRACE_LEN];
+float gyroScale;
+
+void buildTrace() {
+    randomSeed(42);
+    const float countsPerG = 16384.0f;
+    const float countsPerDps = 1.0f / QMI8658C::gyroScaleFor(QMI8658C_GYRO_512DPS);
+    const float rate = 90.0f / (TIP_LEN / SAMPLE_HZ);   // dps
+
+    float angle = 0;
+    for (int i = 0; i < TRACE_LEN; i++) {
+        IMUSample &s = trace[i];
+        s.timestampUs = i * 4460;
+        s.accelRange = QMI8658C_ACCEL_2G;
+
+        // Roll up at 100, back down at 228
+        int phase = i % PERIOD;
+        float dps = 0;
+        if (phase >= 100 && phase < 100 + TIP_LEN) dps = rate;
+        if (phase >= 228 && phase < 228 + TIP_LEN) dps = -rate;
+        angle += dps / SAMPLE_HZ;
+
+        float rad = angle * PI / 180.0f;
+        s.accelX = random(-160, 161);
+        s.accelY = sinf(rad) * countsPerG + random(-160, 161);
+        s.accelZ = cosf(rad) * countsPerG + random(-160, 161);
+        s.gyroX = dps * countsPerDps + random(-8, 9);
+        s.gyroY = random(-8, 9);
+        s.gyroZ = random(-8, 9);
+
+        // 1.2 g impact while lying flat
+        if (phase == 400) {
+            s.accelX += 19660;
+        }
+    }
+    gyroScale = QMI8658C::gyroScaleFor(QMI8658C_GYRO_512DPS);
+}
+
+void update(OrientationFilter &filter, const IMUSample &s) {
+    float aScale = QMI8658C::accelScaleFor(s.accelRange);
+    filter.update(s.accelX * aScale, s.accelY * aScale, s.accelZ * aScale,
+                  s.gyroX * gyroScale, s.gyroY * gyroScale, s.gyroZ * gyroScale,
+                  1.0f / SAMPLE_HZ);
+}
+
+// Turning, away from the impacts
+bool turning(int i) {
+    int phase = i % PERIOD;
+    return phase >= 100 && phase < 300;
+}
+
+void report(const char *name, uint32_t cycles, int events, float leak) {
+    float perSample = (float)cycles / (TRACE_LEN * PASSES);
+    Serial.printf("  %-28s %8.1f cycles/sample  %6.2f us/sample", name, perSample,
+                  perSample / ESP.getCpuFreqMHz());
+    if (events >= 0) {
+        Serial.printf("  (%d events, %d impacts, leak %.3fg)", events,
+                      PASSES * TRACE_LEN / PERIOD, leak);
+    }
+    Serial.println();
+}
+
+void runBenchmarks() {
+    SlapEvent event;
+
+    // Filter alone
+    {
+        OrientationFilter filter;
+        uint32_t start = ESP.getCycleCount();
+        for (int p = 0; p < PASSES; p++) {
+            for (int i = 0; i < TRACE_LEN; i++) {
+                update(filter, trace[i]);
+            }
+        }
+        report("mahony update", ESP.getCycleCount() - start, -1, 0);
+        Serial.printf("  %-28s roll %.1f pitch %.1f\n", "final tilt",
+                      filter.getRoll(), filter.getPitch());
+    }
+
+    // Detector with its own high-pass: the tips leak into |a|
+    {
+        SlapDetector detector;
+        detector.setSampleRate(SAMPLE_HZ);
+        detector.setThreshold(0.5f);
+        int events = 0;
+        float leak = 0;
+
+        uint32_t start = ESP.getCycleCount();
+        for (int p = 0; p < PASSES; p++) {
+            for (int i = 0; i < TRACE_LEN; i++) {
+                if (detector.update(trace[i], event)) {
+                    events++;
+                }
+                if (turning(i)) leak = max(leak, detector.getMotion());
+            }
+        }
+        report("high-pass only", ESP.getCycleCount() - start, events, leak);
+    }
+
+    // Detector on gyro-fused linear acceleration
+    {
+        OrientationFilter filter;
+        SlapDetector detector;
+        detector.setSampleRate(SAMPLE_HZ);
+        detector.setThreshold(0.5f);
+        int events = 0;
+        float leak = 0;
+
+        uint32_t start = ESP.getCycleCount();
+        for (int p = 0; p < PASSES; p++) {
+            for (int i = 0; i < TRACE_LEN; i++) {
+                update(filter, trace[i]);
+                if (detector.update(filter.getLinear(), trace[i].timestampUs, event)) {
+                    events++;
+                }
+                if (turning(i)) leak = max(leak, detector.getMotion());
+            }
+        }
+        report("mahony + detector", ESP.getCycleCount() - start, events, leak);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    unsigned long start = millis();
+    while (!Serial && (millis() - start < 3000)) {
+        delay(100);
+    }
+    delay(500);
+
+    Serial.println("========================================");
+    Serial.println("  ORIENTATION BENCHMARK");
+    Serial.printf("  %d samples x %d passes @ %lu MHz\n",
+                  TRACE_LEN, PASSES, (unsigned long)ESP.getCpuFreqMHz());
+    Serial.println("========================================\n");
+
+    buildTrace();
+}
+
+void loop() {
+    runBenchmarks();
+    Serial.println();
+    delay(5000);
+}
@@ -0,0 +1,70 @@
+/*
+ * Recorded Capture Loader (host)
+ *
+ * Reads a waveform capture downloaded from /api/capture and cuts the
+ * classifier window around its peak, as squared magnitudes in the units
+ * the sensor task feeds SlapClassifier (g^2, dps^2).
+ */
+
+#ifndef CLASSIFIER_CAPTURE_H
+#define CLASSIFIER_CAPTURE_H
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "IMUTypes.h"
+#include "WaveformFormat.h"
+#include "SlapClassifier.h"
+
+struct CaptureWindow {
+    WaveformFileHeader header;
+    float accelMagSq[CLASSIFIER_WINDOW];
+    float gyroMagSq[CLASSIFIER_WINDOW];
+};
+
+static inline bool loadCapture(const char *path, CaptureWindow &out, std::string &error) {
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr) {
+        error = "cannot open";
+        return false;
+    }
+
+    WaveformFileHeader &h = out.header;
+    bool ok = fread(&h, sizeof(h), 1, f) == 1;
+    if (!ok || memcmp(h.magic, WAVEFORM_MAGIC, 4) != 0 || h.version != WAVEFORM_VERSION ||
+        h.recordBytes != sizeof(WaveformRecord)) {
+        fclose(f);
+        error = "not a version 1 waveform capture";
+        return false;
+    }
+
+    std::vector<WaveformRecord> records(h.sampleCount);
+    ok = fread(records.data(), sizeof(WaveformRecord), h.sampleCount, f) == h.sampleCount;
+    fclose(f);
+    if (!ok) {
+        error = "truncated";
+        return false;
+    }
+    if (h.triggerIndex < CLASSIFIER_PRE || h.triggerIndex + CLASSIFIER_POST > h.sampleCount) {
+        error = "window around the peak not fully captured";
+        return false;
+    }
+
+    float gScale = imuGyroScale(h.gyroRange);
+    for (int i = 0; i < CLASSIFIER_WINDOW; i++) {
+        const WaveformRecord &r = records[h.triggerIndex - CLASSIFIER_PRE + i];
+        float aScale = imuAccelScale(r.accelRange);
+        out.accelMagSq[i] = 0;
+        out.gyroMagSq[i] = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            float a = r.accel[axis] * aScale;
+            float g = r.gyro[axis] * gScale;
+            out.accelMagSq[i] += a * a;
+            out.gyroMagSq[i] += g * g;
+        }
+    }
+    return true;
+}
+
+#endif // CLASSIFIER_CAPTURE_H
@@ -0,0 +1,117 @@
+/*
+ * Synthetic Impact Windows (host)
+ *
+ * Parametric stand-ins for the three classes, sampled at 224.2 Hz with
+ * the peak at CLASSIFIER_PRE, as squared magnitudes:
+ *   slap  sharp onset, short high-frequency ring-down, little rotation
+ *   bump  slower onset, low-frequency long decay, sway before the hit
+ *   drop  free fall (|a| ~ 0) with tumbling, then a hard short impact
+ *
+ * Used to bootstrap the model until enough labeled captures exist.
+ */
+
+#ifndef CLASSIFIER_SYNTHETIC_H
+#define CLASSIFIER_SYNTHETIC_H
+
+#include <math.h>
+#include <random>
+#include "SlapClassifier.h"
+
+#define SYNTHETIC_SAMPLE_HZ 224.2f
+
+struct SyntheticRng {
+    std::mt19937 gen;
+
+    explicit SyntheticRng(uint32_t seed) : gen(seed) {}
+
+    float uniform(float a, float b) { return std::uniform_real_distribution<float>(a, b)(gen); }
+    float normal(float sigma) { return std::normal_distribution<float>(0.0f, sigma)(gen); }
+
+    void unit(float v[3]) {
+        float n;
+        do {
+            for (int i = 0; i < 3; i++) v[i] = normal(1.0f);
+            n = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        } while (n < 1e-3f);
+        for (int i = 0; i < 3; i++) v[i] /= n;
+    }
+};
+
+static inline void synthesizeWindow(SlapClass label, SyntheticRng &rng,
+                                    float *accelMagSq, float *gyroMagSq) {
+    const float pi = (float)M_PI;
+    float gravity[3], dir[3], spin[3];
+    rng.unit(gravity);
+    rng.unit(dir);
+    rng.unit(spin);
+
+    // Peak alignment jitter of about one sample
+    float jitter = rng.uniform(-1.0f, 1.0f);
+
+    // Impact
+    float amp, hz, tau, rise, rot;
+    // Bump sway / drop fall
+    float swayAmp = 0, swayHz = 1, swayRot = 0, fall = 0, tumble = 0, bounce = 0;
+
+    switch (label) {
+    case SLAP_CLASS_SLAP:
+        amp = rng.uniform(0.8f, 6.0f);
+        hz = rng.uniform(20.0f, 60.0f);
+        tau = rng.uniform(0.006f, 0.025f);
+        rise = rng.uniform(0.0f, 0.006f);
+        rot = rng.uniform(5.0f, 150.0f);
+        break;
+    case SLAP_CLASS_BUMP:
+        amp = rng.uniform(0.4f, 2.5f);
+        hz = rng.uniform(3.0f, 15.0f);
+        tau = rng.uniform(0.04f, 0.15f);
+        rise = rng.uniform(0.01f, 0.05f);
+        rot = rng.uniform(0.0f, 40.0f);
+        swayAmp = rng.uniform(0.0f, 0.2f);
+        swayHz = rng.uniform(0.5f, 3.0f);
+        swayRot = rng.uniform(0.0f, 30.0f);
+        break;
+    default:
+        amp = rng.uniform(2.0f, 12.0f);
+        hz = rng.uniform(30.0f, 90.0f);
+        tau = rng.uniform(0.004f, 0.02f);
+        rise = 0;
+        rot = 0;
+        fall = rng.uniform(0.05f, 0.22f);
+        tumble = rng.uniform(30.0f, 400.0f);
+        bounce = rng.uniform(0.0f, 400.0f);
+        break;
+    }
+
+    for (int i = 0; i < CLASSIFIER_WINDOW; i++) {
+        float t = (i - CLASSIFIER_PRE + jitter) / SYNTHETIC_SAMPLE_HZ;
+        float g = 1.0f;
+        float pulse = 0;
+        float omega = 0;
+
+        if (t >= 0) {
+            pulse = amp * expf(-t / tau) * cosf(2.0f * pi * hz * t);
+            omega = rot * expf(-t / 0.03f) + tumble * expf(-t / 0.05f) + bounce * expf(-t / 0.08f);
+        } else if (rise > 0 && t > -rise) {
+            pulse = amp * (1.0f + t / rise);
+        }
+        if (t < 0 && t >= -fall) {
+            g = 0;                  // free fall
+            omega = tumble;
+        }
+        pulse += swayAmp * sinf(2.0f * pi * swayHz * t);
+        omega += swayRot * fabsf(sinf(2.0f * pi * swayHz * t));
+
+        float a2 = 0, w2 = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            float a = g * gravity[axis] + pulse * dir[axis] + rng.normal(0.01f);
+            float w = omega * spin[axis] + rng.normal(1.0f);
+            a2 += a * a;
+            w2 += w * w;
+        }
+        accelMagSq[i] = a2;
+        gyroMagSq[i] = w2;
+    }
+}
+
+#endif // CLASSIFIER_SYNTHETIC_H
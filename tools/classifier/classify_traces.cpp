@@ -0,0 +1,102 @@
+/*
+ * Slap Classifier Replay (host)
+ *
+ * Runs the device inference code (include/SlapClassifier.h with the
+ * compiled-in SlapModel.h) on recorded captures from /api/capture, or on
+ * freshly generated synthetic windows, and reports the predicted class,
+ * per-inference latency and memory footprint.
+ *
+ * Build and run from the project root:
+ *   g++ -std=gnu++17 -O2 -Iinclude tools/classifier/classify_traces.cpp -o classify_traces
+ *   ./classify_traces slap-1.bin slap-2.bin ...
+ *   ./classify_traces --synthetic 1000       # confusion matrix per class
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include "SlapClassifier.h"
+#include "Capture.h"
+#include "Synthetic.h"
+
+#define TIMING_RUNS 2000
+
+static SlapClassifier classifier;
+
+// Mean wall time of setInput() + invoke() in ns
+static double timeInference(const float *accelMagSq, const float *gyroMagSq) {
+    volatile uint8_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMING_RUNS; i++) {
+        sink = sink + classifier.classify(accelMagSq, gyroMagSq).confidence;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / TIMING_RUNS;
+}
+
+static int runSynthetic(int perClass) {
+    SyntheticRng rng(12345);
+    float accel[CLASSIFIER_WINDOW], gyro[CLASSIFIER_WINDOW];
+    int confusion[CLASSIFIER_CLASSES][CLASSIFIER_CLASSES] = {};
+    double totalNs = 0;
+    int correct = 0;
+
+    for (int n = 0; n < perClass; n++) {
+        for (int c = 0; c < CLASSIFIER_CLASSES; c++) {
+            synthesizeWindow((SlapClass)(SLAP_CLASS_SLAP + c), rng, accel, gyro);
+            SlapClassification result = classifier.classify(accel, gyro);
+            int predicted = result.label - SLAP_CLASS_SLAP;
+            confusion[c][predicted]++;
+            if (predicted == c) correct++;
+        }
+    }
+    totalNs = timeInference(accel, gyro);
+
+    printf("Synthetic windows: %d per class, int8 accuracy %.1f%%\n",
+           perClass, 100.0 * correct / (perClass * CLASSIFIER_CLASSES));
+    printf("  true \\ predicted   slap   bump   drop\n");
+    for (int c = 0; c < CLASSIFIER_CLASSES; c++) {
+        printf("  %-18s %6d %6d %6d\n", SlapClassifier::labelName((SlapClass)(SLAP_CLASS_SLAP + c)),
+               confusion[c][0], confusion[c][1], confusion[c][2]);
+    }
+    printf("Inference: %.0f ns (host)\n", totalNs);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    printf("Arena %zu bytes, model %zu bytes\n",
+           (size_t)SlapClassifier::ARENA_BYTES, (size_t)SlapClassifier::MODEL_BYTES);
+
+    if (argc == 3 && strcmp(argv[1], "--synthetic") == 0) {
+        return runSynthetic(atoi(argv[2]));
+    }
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s capture.bin ... | --synthetic <per class>\n", argv[0]);
+        return 1;
+    }
+
+    double totalNs = 0;
+    int classified = 0;
+    for (int a = 1; a < argc; a++) {
+        CaptureWindow window;
+        std::string error;
+        if (!loadCapture(argv[a], window, error)) {
+            printf("%-32s %s\n", argv[a], error.c_str());
+            continue;
+        }
+
+        SlapClassification result = classifier.classify(window.accelMagSq, window.gyroMagSq);
+        printf("%-32s %-5s %3u%%  (peak %.2fg, logits %.2f %.2f %.2f)\n", argv[a],
+               SlapClassifier::labelName(result.label), result.confidence, window.header.peak,
+               classifier.getLogit(0), classifier.getLogit(1), classifier.getLogit(2));
+        totalNs += timeInference(window.accelMagSq, window.gyroMagSq);
+        classified++;
+    }
+
+    if (classified > 0) {
+        printf("Inference: %.0f ns mean (host)\n", totalNs / classified);
+    }
+    return 0;
+}
@@ -0,0 +1,330 @@
+/*
+ * Slap Classifier Trainer (host)
+ *
+ * Trains the SlapClassifier MLP (96 -> 16 ReLU -> 3) in float on
+ * synthetic windows plus any labeled captures, quantizes it to int8
+ * (per-row weight scales, Q31 requantization) and writes SlapModel.h.
+ *
+ * Build and run from the project root:
+ *   g++ -std=gnu++17 -O2 -Iinclude tools/classifier/train_classifier.cpp -o train_classifier
+ *   ./train_classifier [slap:a.bin bump:b.bin drop:c.bin ...]
+ *
+ * Captures come from /api/capture; each one is weighted like
+ * CAPTURE_WEIGHT synthetic windows. Check the int8 model afterwards
+ * with classify_traces.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "SlapClassifier.h"
+#include "Capture.h"
+#include "Synthetic.h"
+
+#define SYNTHETIC_PER_CLASS 4000
+#define HELD_OUT_PER_CLASS  1000
+#define CAPTURE_WEIGHT      50
+#define EPOCHS              60
+#define BATCH               32
+#define LEARNING_RATE       0.002f
+
+#define IN  CLASSIFIER_INPUTS
+#define HID CLASSIFIER_HIDDEN
+#define OUT CLASSIFIER_CLASSES
+
+struct Example {
+    float x[IN];
+    int label;              // 0 = slap, 1 = bump, 2 = drop
+};
+
+struct Network {
+    float w1[HID][IN], b1[HID];
+    float w2[OUT][HID], b2[OUT];
+};
+
+// Adam state per parameter, laid out like Network
+struct Moments {
+    Network m, v;
+};
+
+static void makeExample(const float *accelMagSq, const float *gyroMagSq, int label, Example &ex) {
+    SlapClassifier::features(accelMagSq, gyroMagSq, ex.x);
+    // Train on what the int8 input can represent
+    for (int i = 0; i < IN; i++) {
+        float q = roundf(ex.x[i] * 127.0f);
+        ex.x[i] = std::max(-127.0f, std::min(127.0f, q)) / 127.0f;
+    }
+    ex.label = label;
+}
+
+static void synthesize(int perClass, uint32_t seed, std::vector<Example> &out) {
+    SyntheticRng rng(seed);
+    float accel[CLASSIFIER_WINDOW], gyro[CLASSIFIER_WINDOW];
+    for (int n = 0; n < perClass; n++) {
+        for (int c = 0; c < OUT; c++) {
+            synthesizeWindow((SlapClass)(SLAP_CLASS_SLAP + c), rng, accel, gyro);
+            Example ex;
+            makeExample(accel, gyro, c, ex);
+            out.push_back(ex);
+        }
+    }
+}
+
+static int forward(const Network &net, const float *x, float *h, float *p) {
+    for (int j = 0; j < HID; j++) {
+        float s = net.b1[j];
+        for (int i = 0; i < IN; i++) s += net.w1[j][i] * x[i];
+        h[j] = s > 0 ? s : 0;
+    }
+    float z[OUT];
+    int best = 0;
+    for (int k = 0; k < OUT; k++) {
+        z[k] = net.b2[k];
+        for (int j = 0; j < HID; j++) z[k] += net.w2[k][j] * h[j];
+        if (z[k] > z[best]) best = k;
+    }
+    float sum = 0;
+    for (int k = 0; k < OUT; k++) {
+        p[k] = expf(z[k] - z[best]);
+        sum += p[k];
+    }
+    for (int k = 0; k < OUT; k++) p[k] /= sum;
+    return best;
+}
+
+static float accuracy(const Network &net, const std::vector<Example> &set) {
+    int correct = 0;
+    float h[HID], p[OUT];
+    for (const Example &ex : set) {
+        if (forward(net, ex.x, h, p) == ex.label) correct++;
+    }
+    return set.empty() ? 0 : 100.0f * correct / set.size();
+}
+
+static void adam(float *param, const float *grad, float *m, float *v, size_t n, int step) {
+    const float b1 = 0.9f, b2 = 0.999f;
+    float c1 = 1.0f - powf(b1, step);
+    float c2 = 1.0f - powf(b2, step);
+    for (size_t i = 0; i < n; i++) {
+        m[i] = b1 * m[i] + (1 - b1) * grad[i];
+        v[i] = b2 * v[i] + (1 - b2) * grad[i] * grad[i];
+        param[i] -= LEARNING_RATE * (m[i] / c1) / (sqrtf(v[i] / c2) + 1e-8f);
+    }
+}
+
+static void train(Network &net, std::vector<Example> &set, const std::vector<Example> &heldOut) {
+    SyntheticRng rng(1);
+    for (int j = 0; j < HID; j++) {
+        for (int i = 0; i < IN; i++) net.w1[j][i] = rng.normal(sqrtf(2.0f / IN));
+        net.b1[j] = 0;
+    }
+    for (int k = 0; k < OUT; k++) {
+        for (int j = 0; j < HID; j++) net.w2[k][j] = rng.normal(sqrtf(2.0f / HID));
+        net.b2[k] = 0;
+    }
+
+    static Moments moments;
+    static Network grad;
+    memset(&moments, 0, sizeof(moments));
+    int step = 0;
+
+    for (int epoch = 1; epoch <= EPOCHS; epoch++) {
+        std::shuffle(set.begin(), set.end(), rng.gen);
+        float loss = 0;
+
+        for (size_t start = 0; start < set.size(); start += BATCH) {
+            size_t end = std::min(set.size(), start + BATCH);
+            memset(&grad, 0, sizeof(grad));
+
+            for (size_t n = start; n < end; n++) {
+                const Example &ex = set[n];
+                float h[HID], p[OUT];
+                forward(net, ex.x, h, p);
+                loss -= logf(std::max(p[ex.label], 1e-9f));
+
+                // Softmax cross-entropy backward
+                float dz[OUT], dh[HID] = {};
+                for (int k = 0; k < OUT; k++) {
+                    dz[k] = p[k] - (k == ex.label ? 1.0f : 0.0f);
+                    grad.b2[k] += dz[k];
+                    for (int j = 0; j < HID; j++) {
+                        grad.w2[k][j] += dz[k] * h[j];
+                        dh[j] += dz[k] * net.w2[k][j];
+                    }
+                }
+                for (int j = 0; j < HID; j++) {
+                    if (h[j] <= 0) continue;
+                    grad.b1[j] += dh[j];
+                    for (int i = 0; i < IN; i++) grad.w1[j][i] += dh[j] * ex.x[i];
+                }
+            }
+
+            float scale = 1.0f / (end - start);
+            float *g = reinterpret_cast<float *>(&grad);
+            size_t count = sizeof(Network) / sizeof(float);
+            for (size_t i = 0; i < count; i++) g[i] *= scale;
+            adam(reinterpret_cast<float *>(&net), g, reinterpret_cast<float *>(&moments.m),
+                 reinterpret_cast<float *>(&moments.v), count, ++step);
+        }
+
+        if (epoch % 10 == 0) {
+            printf("epoch %2d  loss %.4f  train %.1f%%  held out %.1f%%\n", epoch,
+                   loss / set.size(), accuracy(net, set), accuracy(net, heldOut));
+        }
+    }
+}
+
+// Real multiplier as Q31 mantissa and right shift
+static void quantizeMultiplier(double real, int32_t &mult, int &shift) {
+    int exp;
+    double m = frexp(real, &exp);       // real = m * 2^exp, m in [0.5, 1)
+    int64_t q = llround(m * (1LL << 31));
+    if (q == (1LL << 31)) {
+        q /= 2;
+        exp++;
+    }
+    mult = (int32_t)q;
+    shift = 31 - exp;
+}
+
+struct QuantizedModel {
+    int8_t w1[HID][IN];
+    int32_t b1[HID], m1[HID];
+    int8_t s1[HID];
+    int8_t w2[OUT][HID];
+    int32_t b2[OUT];
+    float outScale[OUT];
+};
+
+static void quantize(const Network &net, const std::vector<Example> &set, QuantizedModel &q) {
+    // Hidden activation range over the training set
+    float hMax = 1e-6f;
+    float h[HID], p[OUT];
+    for (const Example &ex : set) {
+        forward(net, ex.x, h, p);
+        for (int j = 0; j < HID; j++) hMax = std::max(hMax, h[j]);
+    }
+    double sx = 1.0 / 127.0;
+    double sh = hMax / 127.0;
+
+    for (int j = 0; j < HID; j++) {
+        float wMax = 1e-9f;
+        for (int i = 0; i < IN; i++) wMax = std::max(wMax, fabsf(net.w1[j][i]));
+        double sw = wMax / 127.0;
+        for (int i = 0; i < IN; i++) q.w1[j][i] = (int8_t)lrint(net.w1[j][i] / sw);
+        q.b1[j] = (int32_t)lrint(net.b1[j] / (sx * sw));
+        int shift;
+        quantizeMultiplier(sx * sw / sh, q.m1[j], shift);
+        q.s1[j] = (int8_t)shift;
+    }
+    for (int k = 0; k < OUT; k++) {
+        float wMax = 1e-9f;
+        for (int j = 0; j < HID; j++) wMax = std::max(wMax, fabsf(net.w2[k][j]));
+        double sw = wMax / 127.0;
+        for (int j = 0; j < HID; j++) q.w2[k][j] = (int8_t)lrint(net.w2[k][j] / sw);
+        q.b2[k] = (int32_t)lrint(net.b2[k] / (sh * sw));
+        q.outScale[k] = (float)(sh * sw);
+    }
+}
+
+static void writeInt8Row(FILE *f, const int8_t *row, int n) {
+    for (int i = 0; i < n; i++) {
+        if (i % 16 == 0) fprintf(f, "\n        ");
+        fprintf(f, "%4d,", row[i]);
+    }
+}
+
+static bool writeHeader(const char *path, const QuantizedModel &q, int captures, float heldOut) {
+    FILE *f = fopen(path, "w");
+    if (f == nullptr) return false;
+
+    fprintf(f, "/*\n"
+               " * Slap Classifier Weights\n"
+               " *\n"
+               " * Generated by tools/classifier/train_classifier.cpp, do not edit.\n"
+               " * Trained on %d synthetic windows per class and %d labeled captures;\n"
+               " * float accuracy on held-out synthetic windows %.1f%%.\n"
+               " */\n\n"
+               "#ifndef SLAPMODEL_H\n#define SLAPMODEL_H\n\n#include <stdint.h>\n\n",
+            SYNTHETIC_PER_CLASS, captures, heldOut);
+
+    fprintf(f, "// Layer 1: int8 weights per hidden unit, int32 bias at input x weight\n"
+               "// scale, Q31 multiplier and shift to the hidden activation scale\n");
+    fprintf(f, "static constexpr int8_t SLAP_MODEL_W1[%d][%d] = {\n", HID, IN);
+    for (int j = 0; j < HID; j++) {
+        fprintf(f, "    {");
+        writeInt8Row(f, q.w1[j], IN);
+        fprintf(f, "\n    },\n");
+    }
+    fprintf(f, "};\n\nstatic constexpr int32_t SLAP_MODEL_B1[%d] = {", HID);
+    for (int j = 0; j < HID; j++) fprintf(f, "%s%ld,", j % 8 ? " " : "\n    ", (long)q.b1[j]);
+    fprintf(f, "\n};\n\nstatic constexpr int32_t SLAP_MODEL_M1[%d] = {", HID);
+    for (int j = 0; j < HID; j++) fprintf(f, "%s%ld,", j % 8 ? " " : "\n    ", (long)q.m1[j]);
+    fprintf(f, "\n};\n\nstatic constexpr int8_t SLAP_MODEL_S1[%d] = {", HID);
+    for (int j = 0; j < HID; j++) fprintf(f, "%s%d,", j % 8 ? " " : "\n    ", q.s1[j]);
+
+    fprintf(f, "\n};\n\n// Layer 2: logits (slap, bump, drop) = int32 accumulator * OUT_SCALE\n");
+    fprintf(f, "static constexpr int8_t SLAP_MODEL_W2[%d][%d] = {\n", OUT, HID);
+    for (int k = 0; k < OUT; k++) {
+        fprintf(f, "    {");
+        writeInt8Row(f, q.w2[k], HID);
+        fprintf(f, "\n    },\n");
+    }
+    fprintf(f, "};\n\nstatic constexpr int32_t SLAP_MODEL_B2[%d] = {", OUT);
+    for (int k = 0; k < OUT; k++) fprintf(f, "%s%ld", k ? ", " : "", (long)q.b2[k]);
+    fprintf(f, "};\n\nstatic constexpr float SLAP_MODEL_OUT_SCALE[%d] = {", OUT);
+    for (int k = 0; k < OUT; k++) fprintf(f, "%s%.9gf", k ? ", " : "", q.outScale[k]);
+    fprintf(f, "};\n\n#endif // SLAPMODEL_H\n");
+
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    std::vector<Example> set, heldOut;
+    synthesize(SYNTHETIC_PER_CLASS, 42, set);
+    synthesize(HELD_OUT_PER_CLASS, 4242, heldOut);
+
+    int captures = 0;
+    for (int a = 1; a < argc; a++) {
+        static const char *labels[] = {"slap:", "bump:", "drop:"};
+        int label = -1;
+        for (int c = 0; c < OUT; c++) {
+            if (strncmp(argv[a], labels[c], 5) == 0) label = c;
+        }
+        if (label < 0) {
+            fprintf(stderr, "%s: expected slap:, bump: or drop: prefix\n", argv[a]);
+            return 1;
+        }
+
+        CaptureWindow window;
+        std::string error;
+        if (!loadCapture(argv[a] + 5, window, error)) {
+            fprintf(stderr, "%s: %s\n", argv[a] + 5, error.c_str());
+            return 1;
+        }
+        Example ex;
+        makeExample(window.accelMagSq, window.gyroMagSq, label, ex);
+        for (int n = 0; n < CAPTURE_WEIGHT; n++) set.push_back(ex);
+        captures++;
+    }
+
+    printf("Training on %zu windows (%d captures)\n", set.size(), captures);
+    static Network net;
+    train(net, set, heldOut);
+
+    float heldOutAccuracy = accuracy(net, heldOut);
+    static QuantizedModel q;
+    quantize(net, set, q);
+
+    const char *path = "include/SlapModel.h";
+    if (!writeHeader(path, q, captures, heldOutAccuracy)) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    printf("Wrote %s (held-out float accuracy %.1f%%)\n", path, heldOutAccuracy);
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * IMU Trace Loader (host)
+ *
+ * Reads a recorded trace into the IMUSample records the sensor task
+ * hands to DetectionPipeline:
+ *   - CSV, one sample per line: time_us, ax, ay, az (g), gx, gy, gz (dps).
+ *     A header line and '#' comments are skipped. Each sample gets the
+ *     smallest accel range that holds it (what auto-range converges to);
+ *     the gyro range is the smallest that holds the whole trace.
+ *   - Binary: the waveform capture format served by /api/capture
+ *     (include/WaveformFormat.h), 13 bytes per sample. saveTrace() writes
+ *     it, so long CSV recordings can be converted once.
+ */
+
+#ifndef REPLAY_TRACE_H
+#define REPLAY_TRACE_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "IMUTypes.h"
+#include "WaveformFormat.h"
+
+struct Trace {
+    std::vector<IMUSample> samples;
+    uint8_t gyroRange = QMI8658C_GYRO_256DPS;
+    uint32_t samplePeriodUs = 0;
+};
+
+static inline int16_t traceCounts(float value, float scale) {
+    float counts = roundf(value / scale);
+    if (counts > 32767) return 32767;
+    if (counts < -32768) return -32768;
+    return (int16_t)counts;
+}
+
+static inline bool loadTraceCsv(FILE *f, Trace &out, std::string &error) {
+    struct Row {
+        double t;
+        float a[3], g[3];
+    };
+    std::vector<Row> rows;
+    float gyroMax = 0;
+    char line[256];
+    int lineNo = 0;
+
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        lineNo++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        Row r;
+        int n = sscanf(line, "%lf ,%f ,%f ,%f ,%f ,%f ,%f", &r.t, &r.a[0], &r.a[1], &r.a[2],
+                       &r.g[0], &r.g[1], &r.g[2]);
+        if (n != 7) {
+            if (rows.empty() && lineNo == 1) continue;      // header
+            error = "line " + std::to_string(lineNo) + ": expected 7 columns";
+            return false;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            if (fabsf(r.g[axis]) > gyroMax) gyroMax = fabsf(r.g[axis]);
+        }
+        rows.push_back(r);
+    }
+    if (rows.size() < 2) {
+        error = "fewer than 2 samples";
+        return false;
+    }
+
+    out.gyroRange = QMI8658C_GYRO_16DPS;
+    while (out.gyroRange < QMI8658C_GYRO_2048DPS && gyroMax >= 32767 * imuGyroScale(out.gyroRange)) {
+        out.gyroRange++;
+    }
+    float gScale = imuGyroScale(out.gyroRange);
+    double span = rows.back().t - rows.front().t;
+    out.samplePeriodUs = (uint32_t)(span / (rows.size() - 1) + 0.5);
+
+    out.samples.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Row &r = rows[i];
+        IMUSample &s = out.samples[i];
+        float aMax = fmaxf(fabsf(r.a[0]), fmaxf(fabsf(r.a[1]), fabsf(r.a[2])));
+        s.accelRange = QMI8658C_ACCEL_2G;
+        while (s.accelRange < QMI8658C_ACCEL_16G && aMax >= 32767 * imuAccelScale(s.accelRange)) {
+            s.accelRange++;
+        }
+        float aScale = imuAccelScale(s.accelRange);
+        s.timestampUs = (uint32_t)(r.t - rows.front().t);
+        s.accelX = traceCounts(r.a[0], aScale);
+        s.accelY = traceCounts(r.a[1], aScale);
+        s.accelZ = traceCounts(r.a[2], aScale);
+        s.gyroX = traceCounts(r.g[0], gScale);
+        s.gyroY = traceCounts(r.g[1], gScale);
+        s.gyroZ = traceCounts(r.g[2], gScale);
+    }
+    return true;
+}
+
+static inline bool loadTraceBinary(FILE *f, Trace &out, std::string &error) {
+    WaveformFileHeader h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, WAVEFORM_MAGIC, 4) != 0 ||
+        h.version != WAVEFORM_VERSION || h.recordBytes != sizeof(WaveformRecord)) {
+        error = "not a version 1 waveform capture";
+        return false;
+    }
+
+    std::vector<WaveformRecord> records(h.sampleCount);
+    if (fread(records.data(), sizeof(WaveformRecord), h.sampleCount, f) != h.sampleCount) {
+        error = "truncated";
+        return false;
+    }
+
+    out.gyroRange = h.gyroRange;
+    out.samplePeriodUs = h.samplePeriodUs;
+    out.samples.resize(h.sampleCount);
+    for (uint32_t i = 0; i < h.sampleCount; i++) {
+        const WaveformRecord &r = records[i];
+        IMUSample &s = out.samples[i];
+        s.timestampUs = h.firstTimestampUs + i * h.samplePeriodUs;
+        s.accelX = r.accel[0];
+        s.accelY = r.accel[1];
+        s.accelZ = r.accel[2];
+        s.gyroX = r.gyro[0];
+        s.gyroY = r.gyro[1];
+        s.gyroZ = r.gyro[2];
+        s.accelRange = r.accelRange;
+    }
+    return true;
+}
+
+// Binary if the file starts with the capture magic, CSV otherwise
+static inline bool loadTrace(const char *path, Trace &out, std::string &error) {
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr) {
+        error = "cannot open";
+        return false;
+    }
+
+    char magic[4] = {};
+    bool binary = fread(magic, 1, 4, f) == 4 && memcmp(magic, WAVEFORM_MAGIC, 4) == 0;
+    rewind(f);
+    bool ok = binary ? loadTraceBinary(f, out, error) : loadTraceCsv(f, out, error);
+    fclose(f);
+    return ok;
+}
+
+// Write as a waveform capture without an event (trigger at sample 0)
+static inline bool saveTrace(const char *path, const Trace &trace) {
+    FILE *f = fopen(path, "wb");
+    if (f == nullptr) return false;
+
+    WaveformFileHeader h = {};
+    memcpy(h.magic, WAVEFORM_MAGIC, 4);
+    h.version = WAVEFORM_VERSION;
+    h.recordBytes = sizeof(WaveformRecord);
+    h.gyroRange = trace.gyroRange;
+    h.sampleCount = trace.samples.size();
+    h.samplePeriodUs = trace.samplePeriodUs;
+    h.firstTimestampUs = trace.samples.empty() ? 0 : trace.samples[0].timestampUs;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+    for (size_t i = 0; ok && i < trace.samples.size(); i++) {
+        const IMUSample &s = trace.samples[i];
+        WaveformRecord r = {{s.accelX, s.accelY, s.accelZ}, {s.gyroX, s.gyroY, s.gyroZ}, s.accelRange};
+        ok = fwrite(&r, sizeof(r), 1, f) == 1;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+#endif // REPLAY_TRACE_H
@@ -0,0 +1,234 @@
+/*
+ * Detector Trace Replay (host)
+ *
+ * Feeds a recorded IMU trace through DetectionPipeline, the code the
+ * sensor task runs on every FIFO batch (orientation filter, slap
+ * detector, noise floor, features, classifier), in batches of the FIFO
+ * watermark, and runs the events through the gesture recognizer the way
+ * loop() does. Prints one line per event and gesture, then the detection
+ * summary and throughput (samples/s, ns/sample, multiple of real time).
+ *
+ * Traces are CSV (time_us, ax, ay, az in g, gx, gy, gz in dps) or the
+ * binary capture format of /api/capture, see Trace.h.
+ *
+ * Build and run from the project root:
+ *   g++ -std=gnu++17 -O2 -Iinclude tools/replay/replay.cpp -o replay
+ *   ./replay desk.csv                         # event report + throughput
+ *   ./replay --threshold 1.5 --adaptive 10 car.bin
+ *   ./replay --no-fusion --quiet desk.csv     # high-pass gravity removal
+ *   ./replay --save desk.bin desk.csv         # convert to binary
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "DetectionPipeline.h"
+#include "GestureRecognizer.h"
+#include "Trace.h"
+
+struct ReplayOptions {
+    float threshold = 1.0f;
+    bool adaptive = false;
+    float noiseK = 10.0f;
+    bool fusion = true;
+    size_t batch = 16;          // IMU_FIFO_WATERMARK
+    uint32_t gestureWindowMs = 400;
+    int repeat = 10;            // timing passes
+    bool quiet = false;
+    const char *save = nullptr;
+};
+
+struct ReplayResult {
+    std::vector<SlapEvent> events;
+    uint32_t gestures[GESTURE_MAX_SLAPS + 1] = {};
+    uint32_t maxGestureLatencyUs = 0;
+};
+
+static void configure(DetectionPipeline &pipeline, const Trace &trace, const ReplayOptions &opt) {
+    pipeline.setSamplePeriodUs(trace.samplePeriodUs);
+    pipeline.setGyroRange(trace.gyroRange);
+    pipeline.setThreshold(opt.threshold);
+    pipeline.setAdaptiveThreshold(opt.adaptive, opt.noiseK);
+    pipeline.setFusion(opt.fusion);
+    pipeline.begin();
+}
+
+static void printGesture(const GestureEvent &g, uint32_t originUs, bool quiet) {
+    if (quiet) return;
+    printf("  %10.1f ms  gesture %-6s  peak %5.2fg  latency %.0f ms\n",
+           (g.recognizedUs - originUs) / 1000.0, GestureRecognizer::name(g.gesture), g.peak,
+           g.latencyUs / 1000.0);
+}
+
+// One pass with the event report and gestures
+static void replay(const Trace &trace, const ReplayOptions &opt, ReplayResult &result) {
+    DetectionPipeline pipeline;
+    configure(pipeline, trace, opt);
+    GestureRecognizer gestures;
+    gestures.setWindowUs(opt.gestureWindowMs * 1000);
+    uint32_t originUs = trace.samples[0].timestampUs;
+    uint32_t nowUs = originUs;
+    GestureEvent gesture;
+
+    auto onGesture = [&](const GestureEvent &g) {
+        result.gestures[g.gesture]++;
+        printGesture(g, originUs, opt.quiet);
+    };
+
+    auto sink = [&](const SlapEvent &e) {
+        result.events.push_back(e);
+        if (!opt.quiet) {
+            char axis[3] = {e.direction < 0 ? '-' : '+', e.direction ? (char)('X' + abs(e.direction) - 1) : '?', 0};
+            printf("  %10.1f ms  %-5s %3u%%  peak %5.2fg  %3.0f ms  energy %.4f  axis %s"
+                   "  rms %.3f crest %.1f kurt %.1f centroid %.1f Hz\n",
+                   (e.timestampUs - originUs) / 1000.0, SlapClassifier::labelName(e.label),
+                   e.confidence, e.peak, e.durationUs / 1000.0, e.energy, axis,
+                   e.features.rms, e.features.crest, e.features.kurtosis, e.features.centroidHz);
+        }
+        if (e.label != SLAP_CLASS_BUMP && e.label != SLAP_CLASS_DROP &&
+            gestures.addSlap(e.timestampUs, e.peak, nowUs, gesture)) {
+            onGesture(gesture);
+        }
+    };
+
+    const std::vector<IMUSample> &s = trace.samples;
+    for (size_t i = 0; i < s.size(); i += opt.batch) {
+        size_t count = s.size() - i < opt.batch ? s.size() - i : opt.batch;
+        nowUs = s[i + count - 1].timestampUs;
+        pipeline.process(&s[i], count, sink);
+        if (gestures.poll(pipeline.getHorizonUs(nowUs), nowUs, gesture)) {
+            onGesture(gesture);
+        }
+    }
+
+    // End of trace: nothing further will arrive
+    pipeline.flush(sink);
+    nowUs += gestures.getConfig().windowUs + 1;
+    if (gestures.poll(nowUs, nowUs, gesture)) {
+        onGesture(gesture);
+    }
+    result.maxGestureLatencyUs = gestures.getMaxLatencyUs();
+}
+
+// Mean wall time per sample over opt.repeat fresh pipelines (ns)
+static double timeReplay(const Trace &trace, const ReplayOptions &opt) {
+    size_t events = 0;
+    auto sink = [&](const SlapEvent &) { events++; };
+    const std::vector<IMUSample> &s = trace.samples;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < opt.repeat; p++) {
+        DetectionPipeline pipeline;
+        configure(pipeline, trace, opt);
+        for (size_t i = 0; i < s.size(); i += opt.batch) {
+            size_t count = s.size() - i < opt.batch ? s.size() - i : opt.batch;
+            pipeline.process(&s[i], count, sink);
+        }
+        pipeline.flush(sink);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)s.size() * opt.repeat);
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s [options] trace.csv|trace.bin ...\n"
+            "  --threshold <g>     fixed threshold / adaptive floor (1.0)\n"
+            "  --adaptive <k>      adaptive threshold, k * noise sigma\n"
+            "  --no-fusion         high-pass gravity removal only\n"
+            "  --batch <n>         samples per FIFO batch (16)\n"
+            "  --window <ms>       gesture window (400)\n"
+            "  --repeat <n>        timing passes (10)\n"
+            "  --quiet             summary only\n"
+            "  --save <out.bin>    write the (single) trace in binary format\n",
+            name);
+}
+
+int main(int argc, char **argv) {
+    ReplayOptions opt;
+    std::vector<const char *> paths;
+
+    for (int a = 1; a < argc; a++) {
+        bool hasValue = a + 1 < argc;
+        if (strcmp(argv[a], "--threshold") == 0 && hasValue) {
+            opt.threshold = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--adaptive") == 0 && hasValue) {
+            opt.adaptive = true;
+            opt.noiseK = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--no-fusion") == 0) {
+            opt.fusion = false;
+        } else if (strcmp(argv[a], "--batch") == 0 && hasValue) {
+            opt.batch = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--window") == 0 && hasValue) {
+            opt.gestureWindowMs = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--repeat") == 0 && hasValue) {
+            opt.repeat = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--quiet") == 0) {
+            opt.quiet = true;
+        } else if (strcmp(argv[a], "--save") == 0 && hasValue) {
+            opt.save = argv[++a];
+        } else if (argv[a][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            paths.push_back(argv[a]);
+        }
+    }
+    if (paths.empty() || opt.batch == 0 || opt.repeat <= 0 || (opt.save && paths.size() != 1)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int failed = 0;
+    for (const char *path : paths) {
+        Trace trace;
+        std::string error;
+        if (!loadTrace(path, trace, error)) {
+            printf("%s: %s\n", path, error.c_str());
+            failed++;
+            continue;
+        }
+        if (trace.samples.empty() || trace.samplePeriodUs == 0) {
+            printf("%s: no samples\n", path);
+            failed++;
+            continue;
+        }
+
+        if (opt.save) {
+            if (!saveTrace(opt.save, trace)) {
+                printf("%s: cannot write\n", opt.save);
+                return 1;
+            }
+            printf("%s -> %s: %zu samples, %zu bytes\n", path, opt.save, trace.samples.size(),
+                   sizeof(WaveformFileHeader) + trace.samples.size() * sizeof(WaveformRecord));
+            return 0;
+        }
+
+        double seconds = trace.samples.size() * trace.samplePeriodUs / 1e6;
+        printf("%s: %zu samples, %.1f s @ %.1f Hz, threshold %.2fg%s, %s\n", path,
+               trace.samples.size(), seconds, 1e6 / trace.samplePeriodUs, opt.threshold,
+               opt.adaptive ? " adaptive" : "", opt.fusion ? "gyro fusion" : "high-pass only");
+
+        ReplayResult result;
+        replay(trace, opt, result);
+
+        uint32_t labels[SLAP_CLASS_DROP + 1] = {};
+        for (const SlapEvent &e : result.events) {
+            if (e.label <= SLAP_CLASS_DROP) labels[e.label]++;
+        }
+        printf("Events: %zu (slap %u, bump %u, drop %u, unclassified %u)\n", result.events.size(),
+               labels[SLAP_CLASS_SLAP], labels[SLAP_CLASS_BUMP], labels[SLAP_CLASS_DROP],
+               labels[SLAP_CLASS_UNKNOWN]);
+        printf("Gestures: single %u, double %u, triple %u (max latency %.0f ms)\n",
+               result.gestures[GESTURE_SINGLE], result.gestures[GESTURE_DOUBLE],
+               result.gestures[GESTURE_TRIPLE], result.maxGestureLatencyUs / 1000.0);
+
+        double ns = timeReplay(trace, opt);
+        printf("Throughput: %.2f M samples/s, %.1f ns/sample, %.0fx real time (host)\n\n",
+               1e3 / ns, ns, trace.samplePeriodUs * 1e3 / ns);
+    }
+    return failed ? 1 : 0;
+}